@@ -14,6 +14,7 @@
 #include <GLFW/glfw3.h>
 
 #include "Camera.h"
+#include "Simulation.h"
 #include "Skybox.h"
 #include "User.h"
 
@@ -39,6 +40,11 @@ private:
     // Size of the Cube texture atlas.
     int texAtlasSize = 256;
 
+    // Last fast-forward progress percentage printed, or -1.
+    int fastForwardPrinted = -1;
+
+    void drawFastForward(float progress);
+
     void freeGL();
 
     void handleInput();
@@ -70,6 +76,9 @@ public:
     // The User.
     User user;
 
+    // Runs the World's Objects on their own thread, once started.
+    Simulation simulation;
+
     // Time since initialization.
     double t;
     // Last frame's start time.
@@ -121,6 +130,8 @@ public:
             bool headlessMode_,
             std::vector<float> *cubeCubeProbs);
 
+    void startSimulation();
+
     void terminate();
 
     void update();
@@ -0,0 +1,249 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_BATCHRUNNER_H
+#define GOL3D_BATCHRUNNER_H
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "GeneralizedCellularAutomaton.h"
+#include "LockstepTorus.h"
+#include "RecordedRun.h"
+#include "ResultsCache.h"
+#include "Rule.h"
+#include "RuleValue.h"
+#include "RuleValueModel.h"
+#include "RunStats.h"
+
+// Settings shared by every run in a batch.
+struct BatchOptions {
+    // Number of worker threads. 0 means one per hardware thread.
+    int numWorkers = 0;
+
+    // Per-rule wall-clock limit, in seconds. 0 means no limit.
+    double timeLimit = 0.;
+
+    // Per-rule memory limit, in bytes, as estimated by
+    // Object.memoryUsage(). 0 means no limit.
+    size_t memoryLimit = 0;
+
+    // Seed for the initial cube of Cubes, the same for every rule so their
+    // runs start alike. -1 seeds each run from the system clock.
+    long long seed = -1;
+
+    // Half-width of the initial cube of Cubes, and its Cube state
+    // activation probabilities.
+    int hwidth = 10;
+    std::vector<float> cubeCubeProbs = {0.15f};
+
+    // Number of Cubes each worker preallocates.
+    int initNumCubes = 100000;
+
+    // If true, runs end once their population signal is periodic, as found
+    // by a copy of periodDetector (which holds the detector settings).
+    bool detectPopulationPeriod = false;
+    PeriodDetector periodDetector;
+
+    // Scores runs as they finish.
+    RuleValue valueFunction;
+
+    // If true, results hold just the score breakdown instead of the full
+    // statistics.
+    bool scoreOnly = false;
+
+    // If true, statistics are written as binary StatsLogs (.gstats) as runs
+    // progress, instead of as JSON at the end.
+    bool binaryStats = false;
+
+    // If > 0, runs save a Checkpoint (.gckpt) every checkpointEvery
+    // generations, which they're resumed from if the batch is rerun with
+    // resume set. Rules that already have results are then skipped.
+    int checkpointEvery = 0;
+    bool resume = false;
+
+    // Results of earlier runs, keyed by canonical rule and run settings.
+    // Rules that canonicalize the same as a cached run reuse its results
+    // instead of running. Only used with a fixed seed.
+    ResultsCache cache;
+
+    // Number of seeds each rule is run with. Above 1, a rule's runs (seeds
+    // seed, seed + 1, ..., or clock seeds) are spread over the workers like
+    // separate rules, and the rule's result summarizes them. Ensemble runs
+    // don't write binary logs or checkpoints.
+    int ensembleSize = 1;
+
+    // If > 0, an ensemble stops starting runs once this many have finished,
+    // all with the same end status.
+    int unanimousAfter = 0;
+
+    // If > 0, rules are run on a torusSize^3 LockstepTorus instead of the
+    // sparse automaton, up to LockstepTorus::maxLanes of them at once per
+    // worker. Results are the same until a pattern reaches the torus' edges,
+    // after which it wraps around. Checkpoints, memory limits and ensembles
+    // aren't supported.
+    int torusSize = 0;
+
+    // Learned value model for prefiltering rules, if loaded. Rules predicted
+    // to be worth less than minPredictedValue, or (if topK > 0) outside the
+    // topK best predictions, aren't run. Rules the model can't predict (e.g.
+    // with a different number of states) always are.
+    RuleValueModel valueModel;
+    double minPredictedValue = std::numeric_limits<double>::lowest();
+    int topK = 0;
+
+    // If true, runs whose value so far (scored as if they ended there) is
+    // below hopelessValue are stopped early, with the status "hopeless". The
+    // value is checked every hopelessCheckInterval records.
+    bool stopHopeless = false;
+    double hopelessValue = -0.45;
+    int hopelessCheckInterval = 50;
+
+    // If true, each run is shadowed by a copy with the Cube at damageSite
+    // flipped, run in lockstep, and its statistics measure how the
+    // difference spreads (see DamageSpreading). Runs from the cache, or with
+    // checkpoints, don't measure it.
+    bool measureDamage = false;
+    glm::ivec3 damageSite = glm::ivec3(0, 0, 0);
+};
+
+// Outcome of one run of an ensemble.
+struct EnsembleRun {
+    long long seed = -1;
+    std::string endStatus;
+    int period = 0;
+    bool periodExact = false;
+    double value = 0.;
+    bool cached = false;
+
+    // Number of active Cubes, and time step, of each record.
+    std::vector<int> activeCubeLog;
+    std::vector<int> timeStepLog;
+};
+
+// Evaluates a list of rule files concurrently. Each worker thread owns one
+// GeneralizedCellularAutomaton, reused (Cubes and all) across the rules it
+// runs, and writes one result file per rule in the RunStats.save() format (or
+// a binary StatsLog), or just the rule's score. Rules can also be run as
+// ensembles over several seeds, saving a summary per rule, or many at a time
+// on a LockstepTorus.
+class BatchRunner {
+private:
+    // Index of the next rule file to hand out.
+    std::atomic<size_t> nextRule{0};
+
+    // Serializes progress output.
+    std::mutex printMutex;
+
+    // A rule being run with several seeds, shared by the workers running it.
+    struct Ensemble {
+        std::mutex mutex;
+
+        // Set by whichever run starts first.
+        bool loaded = false;
+        bool skipped = false;
+        Rule rule;
+        std::string ruleString;
+        std::string error;
+
+        // Finished runs, and how many of the ensemble's tasks are done
+        // (run, or skipped).
+        std::vector<EnsembleRun> runs;
+        int numTasksDone = 0;
+
+        // Set once the runs so far are unanimous, to skip the rest.
+        bool stopped = false;
+    };
+    std::vector<std::unique_ptr<Ensemble>> ensembles;
+
+    // Number of rules each worker runs at once, in lockstep mode.
+    int lanesPerWorker = 1;
+
+    void finishEnsemble(size_t ruleIndex);
+
+    bool hasResult(const std::string &saveFile, const std::string &logFile) const;
+
+    void work();
+
+    void workEnsemble();
+
+    void workLockstep();
+
+public:
+    BatchOptions options;
+
+    // Rule files to run.
+    std::vector<std::string> ruleFiles;
+
+    // Directory results are written to, one file per rule, named after the
+    // rule file.
+    std::string outDir;
+
+    // Number of rules finished, and how many of those failed to load or save.
+    std::atomic<int> numDone{0};
+    std::atomic<int> numFailed{0};
+
+    void addGeneratedRules(size_t numRules, int numStates, const std::string &dir);
+
+    void addRules(const std::string &path);
+
+    void prefilter();
+
+    void run();
+
+    static void runRule(
+            GeneralizedCellularAutomaton &gol,
+            const Rule &rule,
+            RunStats &stats,
+            const BatchOptions &options,
+            const std::string &logFile = "",
+            const std::string &checkpointFile = "");
+
+    static bool runRuleSlice(
+            GeneralizedCellularAutomaton &gol,
+            const Rule &rule,
+            RunStats &stats,
+            const BatchOptions &options,
+            int untilTimeStep,
+            std::vector<char> &checkpoint,
+            double &elapsed);
+
+    static int runRuleRecorded(
+            GeneralizedCellularAutomaton &gol,
+            const Rule &rule,
+            RunStats &stats,
+            const BatchOptions &options,
+            RecordedRun &record,
+            const RecordedRun *parent = nullptr);
+
+    static bool runRuleCached(
+            GeneralizedCellularAutomaton &gol,
+            const Rule &rule,
+            RunStats &stats,
+            const BatchOptions &options,
+            const std::string &logFile = "",
+            const std::string &checkpointFile = "");
+
+    static void saveEnsemble(
+            const std::string &ruleString,
+            const std::set<int> &liveStates,
+            int ensembleSize,
+            const std::vector<EnsembleRun> &runs,
+            bool includePopulation,
+            const std::string &saveFile);
+
+    static void saveScore(
+            const std::string &ruleString,
+            const RunStats &stats,
+            const RuleScore &score,
+            const std::string &saveFile);
+};
+
+#endif //GOL3D_BATCHRUNNER_H
@@ -0,0 +1,32 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_BLOOMFILTER_H
+#define GOL3D_BLOOMFILTER_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Set of 64-bit hashes in a fixed amount of memory, which can say an item
+// was seen when it wasn't (at a rate chosen up front) but never the other
+// way around.
+class BloomFilter {
+private:
+    std::vector<uint64_t> bits;
+    uint64_t numBits = 0;
+    int numHashes = 0;
+
+    uint64_t position(uint64_t hash, int i) const;
+
+public:
+    BloomFilter(size_t expectedItems, double falsePositiveRate);
+
+    bool contains(uint64_t hash) const;
+
+    bool insert(uint64_t hash);
+};
+
+#endif //GOL3D_BLOOMFILTER_H
@@ -0,0 +1,66 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_BOUNDEDQUEUE_H
+#define GOL3D_BOUNDEDQUEUE_H
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Blocking FIFO queue with a fixed capacity, for handing work between the
+// stages of a pipeline. Producers wait while it's full, so a fast stage can't
+// run arbitrarily far ahead of a slow one, and consumers wait while it's
+// empty. Once closed, pushes are dropped and pops drain what's left.
+template<typename T>
+class BoundedQueue {
+private:
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    std::deque<T> items;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+    // Stops the queue taking new items, and wakes everyone waiting on it.
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    // Waits for an item. Returns false, without one, once the queue is closed
+    // and empty.
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return !items.empty() || closed; });
+        if(items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    // Waits for room, and adds an item. Returns false, dropping the item, if
+    // the queue is closed.
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return items.size() < capacity || closed; });
+        if(closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+};
+
+#endif //GOL3D_BOUNDEDQUEUE_H
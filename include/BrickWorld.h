@@ -0,0 +1,86 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_BRICKWORLD_H
+#define GOL3D_BRICKWORLD_H
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Rule.h"
+
+#include "ivecHash.h"
+
+class GeneralizedCellularAutomaton;
+
+// A GeneralizedCellularAutomaton's configuration between generations, held in
+// 8x8x8 bricks that forks share copy-on-write. Forking copies the table of
+// brick pointers, not the bricks, and an edit copies only the brick it lands
+// in, and only if another fork still holds it. This makes it cheap to branch
+// one world into many variants with small edits (e.g. for perturbation
+// experiments), each restored into an automaton of its own to run forward.
+//
+// Each brick cell is 0 for a Cube that isn't active, and s + 1 for an active
+// Cube in state s, as in Checkpoints. A BrickWorld may only be used by one
+// thread at a time, but forks sharing bricks may be used on different ones.
+class BrickWorld {
+public:
+    // Bricks are brickWidth Cubes on a side.
+    static const int brickShift = 3;
+    static const int brickWidth = 1 << brickShift;
+    static const int brickSize = brickWidth * brickWidth * brickWidth;
+
+    typedef std::array<uint8_t, brickSize> brick_t;
+    typedef std::unordered_map<glm::ivec3, std::shared_ptr<brick_t>, KeyFuncs, KeyFuncs> brickMap_t;
+
+private:
+    // The rule, shared by every fork.
+    std::shared_ptr<const Rule> rule;
+
+    // Bricks by brick coordinates (Cube coordinates divided by brickWidth,
+    // rounding down). Only bricks with an active Cube are kept.
+    brickMap_t bricks;
+
+    uint8_t *writableCell(const glm::ivec3 &position);
+
+public:
+    // Generation the world was captured at, and the seed of its initial
+    // conditions (-1 if unknown).
+    int generation = 0;
+    long long seed = -1;
+
+    // Number of active Cubes in each state, kept up to date with edits.
+    std::vector<int> stateCounts;
+
+    // Number of active Cubes.
+    size_t numCubes = 0;
+
+    static BrickWorld capture(GeneralizedCellularAutomaton &gol);
+
+    static glm::ivec3 brickOf(const glm::ivec3 &position);
+
+    static int cellIndex(const glm::ivec3 &position);
+
+    const brickMap_t &getBricks() const;
+
+    BrickWorld fork() const;
+
+    int get(const glm::ivec3 &position) const;
+
+    size_t memoryUsage() const;
+
+    size_t numSharedBricks() const;
+
+    void restore(GeneralizedCellularAutomaton &gol) const;
+
+    void set(const glm::ivec3 &position, int state);
+};
+
+#endif //GOL3D_BRICKWORLD_H
@@ -14,9 +14,6 @@ private:
     // while not in the run state.
     bool stepping = false;
 
-    // Indicates which update cycle position to update to, while stepping.
-    int stepStart;
-
     // First part of the update Cycle.
     void updateActiveCubes();
 
@@ -47,8 +44,6 @@ public:
 
     void flip(Cube *c);
 
-    virtual void handleInput();
-
     void setCube(Cube *c, int state);
 
     void setRule(std::vector<int> born_vals, std::vector<int> stay_vals, bool bbMode);
@@ -0,0 +1,66 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_CHECKPOINT_H
+#define GOL3D_CHECKPOINT_H
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class GeneralizedCellularAutomaton;
+
+// Snapshot of a GeneralizedCellularAutomaton between generations: its rule,
+// generation counter, initial-condition seed, state counts and every active
+// Cube, from which the run carries on exactly as if it had never stopped.
+//
+// The layout (all little-endian) is a fixed header, the rule, the state
+// counts, then the active Cubes in 8x8x8 bricks:
+//
+//   offset  field
+//        0  char[8]   magic, "GOL3DCKP"
+//        8  uint32    format version
+//       12  uint32    header size, in bytes
+//       16  int32     generation
+//       20  uint32    number of states
+//       24  int64     seed (-1 if unknown)
+//       32  uint64    configHash, checked on load
+//       40  uint32    liveStates, as a bitmask
+//       44  uint32    number of active Cubes
+//       48  uint32    number of bricks
+//       52  uint32    rule size, in bytes
+//       56  uint32    extra data size, in bytes
+//       60  uint32    reserved
+//
+// The rule is a uint32 row count, then per row a uint32 entry count and per
+// entry a uint32 length and the entry's characters. The state counts are one
+// int32 per state. Each brick is its int32 brick coordinates (Cube
+// coordinates divided by 8, rounding down), a uint16 run count, then runs of
+// (uint8 value, uint8 length - 1) covering the brick's 512 cells in x, y, z
+// order. A value of 0 is a Cube that isn't active, and s + 1 an active Cube in
+// state s. Bricks are sorted, so equal automata give equal checkpoints.
+// Callers can append extra data of their own, e.g. run statistics.
+class Checkpoint {
+public:
+    static const uint32_t version = 1;
+
+    static std::vector<char> encode(GeneralizedCellularAutomaton &gol,
+                                    const std::vector<char> &extra = {});
+
+    static void decode(GeneralizedCellularAutomaton &gol,
+                       const char *data,
+                       size_t size,
+                       std::vector<char> *extra = nullptr);
+
+    static void load(GeneralizedCellularAutomaton &gol,
+                     const std::string &path,
+                     std::vector<char> *extra = nullptr);
+
+    static void save(GeneralizedCellularAutomaton &gol,
+                     const std::string &path,
+                     const std::vector<char> &extra = {});
+};
+
+#endif //GOL3D_CHECKPOINT_H
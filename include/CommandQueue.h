@@ -0,0 +1,34 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_COMMANDQUEUE_H
+#define GOL3D_COMMANDQUEUE_H
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Queue of deferred actions (User edits, run state changes, ...) posted from
+// any thread and executed, in order, by the thread that owns an Object's
+// simulation state.
+class CommandQueue {
+private:
+    std::mutex mutex;
+
+    // Commands posted since the last execute().
+    std::vector<std::function<void()>> pending;
+
+    // Commands being executed. Kept around to reuse its capacity.
+    std::vector<std::function<void()>> executing;
+
+public:
+    void clear();
+
+    void execute();
+
+    void post(std::function<void()> command);
+};
+
+#endif //GOL3D_COMMANDQUEUE_H
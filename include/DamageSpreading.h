@@ -0,0 +1,64 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_DAMAGESPREADING_H
+#define GOL3D_DAMAGESPREADING_H
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ivecHash.h"
+
+class GeneralizedCellularAutomaton;
+
+// Damage spreading: how far a one-Cube perturbation of a run spreads. A
+// perturbed copy of the run is run in lockstep with it, and after each
+// generation the Cubes whose states differ between the two are counted (the
+// Hamming distance) and their farthest distance from the perturbed Cube found
+// (the radius of the difference region, in the Chebyshev metric, so it grows
+// by at most one per generation). A Cube's state can only have changed if it
+// is in one of the two runs' change lists, so only those Cubes are compared,
+// and the cost follows the activity of the runs and the size of the
+// difference region rather than the size of the world.
+class DamageSpreading {
+private:
+    // Cubes whose states differ between the two runs.
+    std::unordered_set<glm::ivec3, KeyFuncs, KeyFuncs> differing;
+
+    void compare(const GeneralizedCellularAutomaton &reference,
+                 const GeneralizedCellularAutomaton &perturbed,
+                 const glm::ivec3 &position);
+
+public:
+    // Logical coordinates of the perturbed Cube.
+    glm::ivec3 site = glm::ivec3(0, 0, 0);
+
+    // Per generation, from the perturbation on: the generation, the Hamming
+    // distance between the runs, and the radius of the difference region
+    // (-1 while there is none).
+    std::vector<int> generationLog;
+    std::vector<int> hammingLog;
+    std::vector<int> radiusLog;
+
+    void begin(GeneralizedCellularAutomaton &reference,
+               GeneralizedCellularAutomaton &perturbed,
+               const glm::ivec3 &site_);
+
+    void clear();
+
+    bool empty() const;
+
+    double lyapunovExponent() const;
+
+    int maxRadius() const;
+
+    void record(const GeneralizedCellularAutomaton &reference, const GeneralizedCellularAutomaton &perturbed);
+
+    double spreadRate() const;
+};
+
+#endif //GOL3D_DAMAGESPREADING_H
@@ -1,8 +1,10 @@
 //
 // Created by matt on 12/13/20.
 //
+#include <chrono>
 #include <set>
 #include <string>
+#include <utility>
 
 #include "Object.h"
 
@@ -41,18 +43,55 @@ class GeneralizedCellularAutomaton : public Object {
  *   this GeneralizedCellularAutomaton (GCA) implements.
  */
 private:
+    // Checkpoints and BrickWorlds read and restore the update cycle's
+    // internals.
+    friend class BrickWorld;
+    friend class Checkpoint;
+
     // Indicates whether the CellularAutomaton is currently 'stepping' - updating one time,
     // while not in the run state.
     bool stepping = false;
 
-    // Indicates which update cycle position to update to, while stepping.
-    int stepStart;
+    // How many Cubes a stage processes between checks of the update deadline.
+    static const int timeCheckInterval = 256;
+
+    // True while a stage's pass over its Cubes has started but not finished,
+    // because an update's time budget ran out part way through.
+    bool stageInProgress = false;
+
+    // Where the unfinished pass resumes: the activeCubes position, or for
+    // updateActiveCubes(), the removeCubes index and addCubes position.
+    cubeMap_t::iterator stageCursor;
+    size_t removeCursor = 0;
+    boolMap_t::iterator addCursor;
+
+    // New states computed by updateState(), applied once its pass finishes.
+    std::vector<std::pair<Cube*, int>> pendingStates;
+
+    // How long each update() call works for while fast-forwarding, in ms.
+    // Long enough to amortize the call, short enough to notice a cancel.
+    static constexpr double fastForwardSlice = 50.;
+
+    // True from the first update of a fast-forward until the generation
+    // boundary where it finishes or is cancelled.
+    bool fastForwardActive = false;
+
+    // When the current update() call has to stop working.
+    std::chrono::steady_clock::time_point deadline;
+
+    // Start of the current generation, and the time spent working on it so
+    // far, in milliseconds.
+    std::chrono::steady_clock::time_point generationStart;
+    double generationWork = 0.;
 
     // Rule matrix in its internal representation.
     std::vector<std::vector<int>> ruleMatrixInt;
 
-    static std::vector<int> parseRuleRow(
-            const std::vector<std::string> &rowExt);
+    void finishGeneration();
+
+    bool outOfTime(int &counter);
+
+    void runStage();
 
     // First part of the update Cycle.
     void updateActiveCubes();
@@ -67,6 +106,10 @@ private:
     void updateResetCount();
 
 public:
+    // Number of stages in the update cycle. Each is one time step, so a
+    // generation is this many time steps.
+    static const int stagesPerGeneration = 5;
+
     // Rule matrix in its external representation.
     std::vector<std::vector<std::string>> ruleMatrixExt;
     // String representation of the rule matrix
@@ -82,17 +125,32 @@ public:
     // for Cube state `i`.
     std::vector<int> stateCounts;
 
+    // Seed the initial conditions were generated from, or -1 if unknown.
+    long long seed = -1;
+
+    // If trackRuleUse is set, ruleFirstUse[state][count] is the generation in
+    // which the rule table entry ruleMatrixInt[state][count] was first used,
+    // or -1 if it hasn't been. Runs of rules that only differ in entries
+    // that were never used are identical. setRule() clears it.
+    bool trackRuleUse = false;
+    std::vector<std::vector<int>> ruleFirstUse;
+
     GeneralizedCellularAutomaton();
     ~GeneralizedCellularAutomaton() override;
 
-    void cubeCube(int hwidth=10, std::vector<float> ps={0.1}, glm::ivec3 center=glm::ivec3(0,0,0));
+    static std::string formatRule(const std::vector<std::vector<std::string>> &rule);
 
-    void handleInput() override;
+    static std::vector<int> parseRuleRow(
+            const std::vector<std::string> &rowExt);
+
+    void cubeCube(int hwidth=10, std::vector<float> ps={0.1}, glm::ivec3 center=glm::ivec3(0,0,0), long long seed=-1);
 
     void setCube(Cube *c, int state);
 
     void recomputeStateCounts();
 
+    void reset() override;
+
     void setRule(
             const std::vector<std::vector<std::string>> &_ruleMatrixExt,
             const std::set<int>& _liveStates);
@@ -0,0 +1,77 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_LOCKSTEPTORUS_H
+#define GOL3D_LOCKSTEPTORUS_H
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Rule.h"
+
+// Dense automaton on a small size^3 torus that runs up to maxLanes rules at
+// once, each in its own lane, for rule searches where rules per second is
+// what counts. Every cell stores one state per lane, lanes innermost, so
+// counting neighbors is the same few byte adds for all the lanes, which the
+// compiler vectorizes, and the rule lookup is a gather from each lane's own
+// table.
+//
+// Each lane only updates the cells the sparse GeneralizedCellularAutomaton
+// would have active: its non-dead cells, and the neighborhoods of the cells
+// that changed in the last generation. The state counts, number of active
+// cells and configuration hash after each step() are then the same as the
+// sparse automaton's at the start of the next generation, for as long as the
+// pattern stays clear of the torus' edges. Past that it wraps around.
+class LockstepTorus {
+public:
+    static const int maxLanes = 32;
+    static const int maxStates = 32;
+
+    // Torus side length, a power of 2.
+    int size = 0;
+
+    // Per lane: the number of states of its rule, the seed its initial
+    // conditions were generated from, the number of active cells in each
+    // state, the total number of active cells, and the hash of its
+    // configuration (as in Object.configHash).
+    std::vector<int> numStates;
+    std::vector<long long> seeds;
+    std::vector<std::vector<int>> stateCounts;
+    std::vector<int> numActiveCells;
+    std::vector<uint64_t> configHash;
+
+    void clearLane(int lane);
+
+    void cubeCube(int lane, int hwidth, const std::vector<float> &ps, long long seed);
+
+    void init(int size);
+
+    void setRule(int lane, const Rule &rule);
+
+    void step();
+
+private:
+    // Cell states, and whether each cell is active, as [cell][lane], where
+    // cell = (x * size + y) * size + z.
+    std::vector<uint8_t> states;
+    std::vector<uint8_t> active;
+
+    // Per-cell scratch space, laid out the same way.
+    std::vector<uint8_t> live;
+    std::vector<uint8_t> counts;
+    std::vector<uint8_t> scratch;
+
+    // Per lane, the next state of each (state, live neighbor count), as
+    // [lane][state * 27 + count], and whether each state is live, as
+    // [lane][state].
+    std::vector<uint8_t> ruleTable;
+    std::vector<uint8_t> liveTable;
+
+    void boxSum(const uint8_t *in, uint8_t *out);
+
+    int logical(int i) const;
+};
+
+#endif //GOL3D_LOCKSTEPTORUS_H
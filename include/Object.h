@@ -6,27 +6,119 @@
 #define GOL3D_OBJECT_H
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
 #include <glm/glm.hpp>
 
+#include "CommandQueue.h"
 #include "Cube.h"
-#include "IO.h"
+#include "TripleBuffer.h"
 
 #include "ivecHash.h"
 
 // Possible Object update states.
 enum ObjectState {stop, step, run};
 
+// A single Cube state transition, as recorded by the update cycle.
+struct CubeChange {
+    // Logical coordinates of the Cube that changed.
+    glm::ivec3 center;
+
+    // State before and after the change.
+    int oldState;
+    int newState;
+};
+
+// A drawn Cube, as captured in a RenderSnapshot.
+struct SnapshotCube {
+    glm::ivec3 center;
+    int state;
+    glm::ivec2 texBase;
+};
+
+// Immutable copy of everything the renderer needs from an Object, published
+// by whichever thread runs the Object's update cycle.
+struct RenderSnapshot {
+    // Generation the snapshot was taken at.
+    int generation = 0;
+
+    // Size of activeCubes when the snapshot was taken.
+    int numActiveCubes = 0;
+
+    // All non-dead Cubes, along with dead (state 0) entries in slots freed
+    // since the Object last rebuilt them, which aren't drawn.
+    std::vector<SnapshotCube> cubes;
+
+    // Position in the Object's slot change log that cubes is up to date with.
+    int logEpoch = -1;
+    size_t logPosition = 0;
+};
+
 typedef std::unordered_map<glm::ivec3, Cube*, KeyFuncs, KeyFuncs> cubeMap_t;
 typedef std::unordered_map<glm::ivec3, bool, KeyFuncs, KeyFuncs> boolMap_t;
 typedef std::unordered_map<glm::ivec3, int, KeyFuncs, KeyFuncs> intMap_t;
 
 class Object {
 protected:
-    // Reference to the IO handler.
-    IO &io;
+    // Cube state changes made since the current generation's state update
+    // began. Cleared (keeping its capacity) once per generation, so stepping
+    // doesn't allocate once the buffer has grown to fit.
+    std::vector<CubeChange> changes;
+
+    // Edits and run state changes waiting to be applied by update().
+    CommandQueue commands;
+
+    // Render snapshots handed from the simulation to the renderer.
+    TripleBuffer<RenderSnapshot> snapshots;
+
+    // True if drawCubes changed since the last published snapshot.
+    bool snapshotDirty;
+
+    // The drawn Cubes as the next snapshot will hold them, kept up to date
+    // from the change list instead of being copied from drawCubes every
+    // generation. A Cube keeps its slot until it dies, and freed slots (state
+    // 0) are reused.
+    std::vector<SnapshotCube> snapshotSlots;
+    intMap_t snapshotSlotOf;
+    std::vector<int> freeSnapshotSlots;
+
+    // Slots changed since the log's epoch began, in order. A snapshot buffer
+    // is brought up to date by copying just the slots logged after its
+    // logPosition, or all of them if it's from an earlier epoch.
+    std::vector<int> snapshotLog;
+    int snapshotLogEpoch = 0;
+
+    // Number of entries at the front of changes already applied to
+    // snapshotSlots.
+    size_t snapshotChangesSeen = 0;
+
+    // True if snapshotSlots has to be rebuilt from drawCubes, e.g. after a
+    // reset or while snapshots weren't being published.
+    bool snapshotRebuild = true;
+
+    // Generation of the last published snapshot.
+    int publishedGeneration;
+
+    // Indicates which update cycle position to update to, while stepping.
+    int stepStart;
+
+    // True for Objects whose update() can be split over several calls, which
+    // fast-forwarding needs.
+    bool resumableUpdates = false;
+
+    void applyChangesToSnapshot();
+
+    void beginChanges();
+
+    void publishSnapshot();
+
+    void rebuildSnapshotSlots();
+
+    void recordChange(const Cube *c, int oldState);
 
 public:
     // Object state.
@@ -35,8 +127,16 @@ public:
     // Tracks which part of the update cycle the Object is in.
     int cycleStage;
 
-    // If true, this Object is the one the User is currently manipulating. The Object only
-    // responds to IO events when active.
+    // Number of complete update cycles (generations) since the last reset.
+    int generation;
+
+    // Zobrist hash of the current configuration: the XOR of a random key for
+    // each non-dead Cube's (center, state). Kept up to date with every state
+    // change, so equal configurations hash equal whatever led to them.
+    uint64_t configHash = 0;
+
+    // If true, this Object is the one the User is currently manipulating. The World only
+    // forwards input to the active Object.
     bool active;
 
     // Vector containing all of the uninitialized Cubes.
@@ -55,6 +155,28 @@ public:
     // Vector containing the indices of Cubes to remove from activeCubes.
     std::vector<glm::ivec3> removeCubes;
 
+    // If true, the Object publishes RenderSnapshots as it updates. Headless
+    // runs turn this off, since nothing reads them.
+    bool publishSnapshots = true;
+
+    // Time budget for each update() call, in milliseconds, for Objects that
+    // support resumable updates. 0 means advance one whole stage of the update
+    // cycle per call, however long it takes.
+    double updateBudget = 0.;
+
+    // Measurements of the most recent generation, in milliseconds: time spent
+    // computing it, and wall time from its first stage to its last.
+    std::atomic<double> generationWorkTime{0.};
+    std::atomic<double> generationLatency{0.};
+
+    // Generations left to run in the current fast-forward (0 when not
+    // fast-forwarding), and how many it started with.
+    std::atomic<int> fastForwardLeft{0};
+    std::atomic<int> fastForwardTotal{0};
+
+    // Number of generations a fast-forward started from the keyboard runs.
+    int fastForwardGenerations = 500;
+
     // Initial number of Cubes created in limbo.
     int initNumCubes;
 
@@ -72,6 +194,8 @@ public:
 
     void add(const int x, const int y, const int z);
 
+    bool bounds(glm::ivec3 &lo, glm::ivec3 &hi) const;
+
     glm::ivec3 centerFromPoint(glm::vec3 &point);
 
     bool checkPoint(glm::vec3 &point);
@@ -79,17 +203,35 @@ public:
     template<typename T>
     bool findIn(const std::unordered_map<glm::ivec3, T, KeyFuncs, KeyFuncs> &map, const glm::ivec3 &center);
 
+    void cancelFastForward();
+
+    void fastForward(int numGenerations);
+
+    float fastForwardProgress() const;
+
     void freeMemory();
 
-    virtual void handleInput() = 0;
+    std::span<const CubeChange> getChanges() const;
 
     virtual void init(glm::vec3 origin_, float scale_, int initNumCubes_);
 
+    const RenderSnapshot &latestSnapshot();
+
+    size_t memoryUsage() const;
+
+    void post(std::function<void()> command);
+
+    void rasterize(const glm::ivec3 &lo, const glm::ivec3 &size, uint8_t *out, int numThreads = 0) const;
+
     virtual void remove(glm::ivec3 &center);
 
-    void reset();
+    virtual void reset();
+
+    void setRunState(ObjectState newState);
 
     virtual void update() = 0;
+
+    static uint64_t zobristKey(const glm::ivec3 &center, int state);
 };
 
 #endif //GOL3D_OBJECT_H
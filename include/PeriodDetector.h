@@ -0,0 +1,66 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_PERIODDETECTOR_H
+#define GOL3D_PERIODDETECTOR_H
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Online detector for periodic population signals. For each lag up to
+// maxPeriod it keeps a sliding sum of squared differences between the signal
+// and itself shifted by that lag, over the last `window` samples, so each new
+// sample costs O(maxPeriod) however long the run. A lag is a period when its
+// difference falls to a small fraction of that of every shorter lag; smooth
+// trends and noise never dip like that. The period is reported once the same
+// lag has been found for `confirmations` samples in a row.
+class PeriodDetector {
+private:
+    // The last window + maxPeriod + 1 samples.
+    std::vector<int64_t> ring;
+
+    // Number of samples pushed since the last clear().
+    int numSamples = 0;
+
+    // Sliding sums of squared lagged differences, indexed by lag.
+    std::vector<int64_t> diffSums;
+
+    // Sum and sum of squares of the samples in the window.
+    int64_t sum = 0;
+    int64_t sumSquares = 0;
+
+    // Lag found at the last sample, how many samples in a row it's been
+    // found for, and the sample it was first found at.
+    int candidate = 0;
+    int candidateCount = 0;
+    int candidateStart = 0;
+
+    int64_t sample(int i) const;
+
+public:
+    // Number of samples the differences are summed over.
+    int window = 128;
+
+    // Longest period looked for.
+    int maxPeriod = 32;
+
+    // A lag's normalized difference must be below this fraction of the
+    // largest one at a shorter lag.
+    double threshold = 0.05;
+
+    // Number of consecutive samples a period has to be found at.
+    int confirmations = 32;
+
+    // Detected period, and the sample the periodic window began at. 0 and -1
+    // until a period is detected.
+    int period = 0;
+    int onset = -1;
+
+    void clear();
+
+    bool push(int64_t x);
+};
+
+#endif //GOL3D_PERIODDETECTOR_H
@@ -0,0 +1,44 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_RECORDEDRUN_H
+#define GOL3D_RECORDEDRUN_H
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Rule.h"
+
+// A run kept in memory so runs of rules that differ from its rule in a few
+// rule table entries (e.g. mutants in a search) can reuse it: which entries
+// it used and when, and Checkpoints along the way. Up to the first
+// generation in which one of the changed entries is used, the other run is
+// identical, so it can start from the last Checkpoint before then, or reuse
+// the whole run if no changed entry was ever used.
+class RecordedRun {
+public:
+    Rule rule;
+
+    // Generation in which each rule table entry, [state][live neighbor
+    // count], was first used, or -1 if it never was.
+    std::vector<std::vector<int>> firstUse;
+
+    // Checkpoints every checkpointEvery generations from generation 0, with
+    // the statistics at the time as their extra data.
+    int checkpointEvery = 10;
+    std::vector<std::vector<char>> checkpoints;
+
+    // Statistics at the end of the run, from RunStats.saveState().
+    std::vector<char> finalStats;
+
+    // How the run ended.
+    std::string endStatus;
+
+    int divergence(const Rule &other) const;
+
+    bool reusable() const;
+};
+
+#endif //GOL3D_RECORDEDRUN_H
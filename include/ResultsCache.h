@@ -0,0 +1,37 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_RESULTSCACHE_H
+#define GOL3D_RESULTSCACHE_H
+#pragma once
+
+#include <string>
+
+#include "RunStats.h"
+
+// On-disk cache of finished runs' statistics, one file per run in a
+// directory, named after a hash of the run's key. The key has to capture
+// everything the results depend on; it's stored in the file too, and
+// checked on lookup, so hash collisions miss instead of returning the wrong
+// run.
+class ResultsCache {
+public:
+    // Bump when a change to the update cycle or RunStats changes the results
+    // of existing runs, to stop older entries being used.
+    static const int engineVersion = 1;
+
+    // Directory the cache lives in. Empty disables the cache.
+    std::string dir;
+
+    bool enabled() const;
+
+    bool lookup(const std::string &key, RunStats &stats) const;
+
+    void store(const std::string &key, const RunStats &stats) const;
+
+private:
+    std::string pathFor(const std::string &key) const;
+};
+
+#endif //GOL3D_RESULTSCACHE_H
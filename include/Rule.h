@@ -7,6 +7,8 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <map>
 #include <numeric>
 #include <random>
 #include <set>
@@ -18,6 +20,32 @@
         std::set<int> liveStates;                    // ⊆ {1 … N‑1}
     };
 
+// A Rule in canonical form. Rules that only differ by a relabelling of the
+// states the initial conditions don't use, or in the rows of states that can
+// never be reached, run identically and share a canonical form.
+struct CanonicalRule {
+    // Rule table in its internal representation (one row of 27 next states
+    // per state, see GeneralizedCellularAutomaton::parseRuleRow), with the
+    // states relabelled and the unreachable ones dropped.
+    std::vector<std::vector<int>> table;
+    std::set<int> liveStates;
+
+    // stateMap[s] is the canonical label of the Rule's state s, or -1 if s
+    // can't be reached.
+    std::vector<int> stateMap;
+
+    // Text form of the canonical rule, and a hash of it.
+    std::string key;
+    uint64_t hash = 0;
+};
+
+CanonicalRule canonicalizeRule(const Rule& rule, int numSeededStates);
+
+// generateRule() rates used for rule searches, the same as for the
+// interactive app's default rule.
+inline constexpr double searchLiveRate = 3.25;
+inline constexpr double searchSparseRate = 1.15;
+
 Rule generateRule(
         int n_dims,
         int n_states,
@@ -25,6 +53,21 @@ Rule generateRule(
         double L_sparse,
         std::mt19937& rng);
 
+Rule mutateRule(
+        const Rule& rule,
+        double liveToggleRate,
+        std::mt19937& rng,
+        std::string* description = nullptr);
+
 Rule parseRuleFromJson(const std::string& filePath);
 
+Rule parseRuleFromJsonText(const std::string& text);
+
+std::vector<std::string> formatRuleRow(const std::vector<int>& row, int numStates);
+
+void saveRuleToJson(
+        const Rule& rule,
+        const std::string& filePath,
+        const std::map<std::string, double>& params = {});
+
 #endif //GOL3D_RULE_H
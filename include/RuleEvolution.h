@@ -0,0 +1,109 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_RULEEVOLUTION_H
+#define GOL3D_RULEEVOLUTION_H
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "BatchRunner.h"
+#include "RecordedRun.h"
+#include "Rule.h"
+
+// Evolutionary search over rule tables. Each generation, populationSize
+// children are made from the current parents with mutateRule(), run in
+// parallel and scored with options.valueFunction, and the numParents best of
+// parents and children become the next parents. Children are run from their
+// parent's RecordedRun, so the part of the run a mutation can't change isn't
+// simulated again. All randomness comes from one generator seeded with
+// options.seed, on the calling thread, so a search is reproducible from its
+// seed whatever the number of workers.
+class RuleEvolution {
+private:
+    // A rule in the search, where it came from, and how it did.
+    struct Individual {
+        size_t id = 0;
+        long long parentId = -1;
+        int generation = 0;
+
+        // Index of the parent in parents, while the Individual is being run.
+        int parentIndex = -1;
+
+        // How the rule was made from its parent's.
+        std::string mutation;
+
+        Rule rule;
+        std::string ruleString;
+        std::string endStatus;
+        double value = 0.;
+        bool scored = false;
+        bool failed = false;
+
+        // Generation the run was simulated from, or -1 if the parent's run
+        // was reused whole.
+        int startGeneration = 0;
+
+        RecordedRun record;
+    };
+
+    // Current parents, best first, and the generation being run.
+    std::vector<Individual> parents;
+    std::vector<Individual> children;
+    std::atomic<size_t> nextChild{0};
+
+    // Parent id and mutation of every Individual so far, by id.
+    std::vector<std::pair<long long, std::string>> history;
+
+    // Serializes progress output.
+    std::mutex printMutex;
+
+    void evaluate();
+
+    void select();
+
+    void work();
+
+    void writeBest() const;
+
+public:
+    BatchOptions options;
+
+    // Rules to start from, alongside random ones with numStates states.
+    std::vector<Rule> initialRules;
+    int numStates = 5;
+
+    // Number of children per generation (and of rules in the first), and of
+    // parents kept.
+    int populationSize = 32;
+    int numParents = 8;
+
+    // Number of generations of children after the first.
+    int numGenerations = 20;
+
+    // Chance that a mutation toggles a live state instead of moving a count.
+    double liveToggleRate = 0.1;
+
+    // How often the RecordedRuns children start from keep Checkpoints, in
+    // generations.
+    int checkpointEvery = 10;
+
+    // Directory for lineage.tsv (every rule run, with its parent and
+    // mutation), ranking.json and the final parents' rule files
+    // (best/rank_<rank>.json).
+    std::string outDir;
+
+    // Number of rules run, of those whose parent's run was reused whole, and
+    // of those that failed.
+    std::atomic<int> numRun{0};
+    std::atomic<int> numReused{0};
+    std::atomic<int> numFailed{0};
+
+    void run();
+};
+
+#endif //GOL3D_RULEEVOLUTION_H
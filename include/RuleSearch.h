@@ -0,0 +1,76 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_RULESEARCH_H
+#define GOL3D_RULESEARCH_H
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "BatchRunner.h"
+#include "BoundedQueue.h"
+#include "Rule.h"
+
+// Outcome of one rule's run in a RuleSearch.
+struct SearchResult {
+    // Position of the rule in the generated sequence.
+    size_t index = 0;
+
+    Rule rule;
+    std::string ruleString;
+    std::string endStatus;
+    int period = 0;
+    int lastTimeStep = 0;
+    double value = 0.;
+    bool cached = false;
+};
+
+// Search over random rules as one in-memory pipeline: a generator thread
+// makes rules with generateRule(), skipping repeats (by canonical rule, with a
+// BloomFilter) and, if a value model is loaded, rules predicted below
+// options.minPredictedValue. It feeds them through a bounded queue to
+// simulation workers, whose results stream back to the calling thread to be
+// ranked. Only a summary line per rule and the best rules are written out.
+class RuleSearch {
+private:
+    // A generated rule waiting to be simulated.
+    struct Candidate {
+        size_t index = 0;
+        Rule rule;
+    };
+
+    void generate(BoundedQueue<Candidate> &candidates);
+
+    void simulate(BoundedQueue<Candidate> &candidates, BoundedQueue<SearchResult> &results);
+
+    void writeTop(std::vector<SearchResult> &top) const;
+
+public:
+    // Run settings, as for a batch. Rules are generated from options.seed
+    // (or the clock), and every run starts from that seed's cube of Cubes.
+    BatchOptions options;
+
+    // Number of rules to simulate, and their number of states.
+    size_t numRules = 1000;
+    int numStates = 5;
+
+    // Number of best rules kept and written out.
+    int keepTop = 100;
+
+    // Directory for summary.tsv (one line per simulated rule), ranking.json
+    // and the best rules' files (top/rank_<rank>.json).
+    std::string outDir;
+
+    // Pipeline statistics.
+    std::atomic<size_t> numGenerated{0};
+    std::atomic<size_t> numDuplicates{0};
+    std::atomic<size_t> numPrefiltered{0};
+    std::atomic<size_t> numSimulated{0};
+    std::atomic<size_t> numFailed{0};
+
+    void run();
+};
+
+#endif //GOL3D_RULESEARCH_H
@@ -0,0 +1,72 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_RULEVALUE_H
+#define GOL3D_RULEVALUE_H
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "RunStats.h"
+
+// Breakdown of a rule's value, as computed by RuleValue.evaluate().
+struct RuleScore {
+    // Set when the value wasn't computed from the loss terms: the run ended
+    // early, or had too little data.
+    std::string reason;
+
+    double earlyTerminationLoss = 0.;
+    double growthLoss = 0.;
+    double periodicityLoss = 0.;
+    double complexityLoss = 0.;
+    double totalLoss = 0.;
+
+    // Higher is better.
+    double value = 0.;
+
+    // True if the loss terms were computed.
+    bool hasLosses = false;
+};
+
+// Value function for rules, based on the population (number of active Cubes)
+// time series of a run. A port of CAValueFunction in
+// python/compute_rule_value.py, which it matches to within floating point
+// error, so scores can be computed as runs finish instead of from their saved
+// statistics.
+class RuleValue {
+private:
+    double growthRateLoss(const std::vector<double> &population) const;
+
+    static double complexityLoss(const std::vector<double> &population);
+
+    static double earlyTerminationLoss(int maxObservedStep, int maxSteps);
+
+    static double periodicityLoss(const std::vector<double> &population);
+
+public:
+    // Fraction of the time series discarded as initial transient.
+    double transientRatio = 0.3;
+
+    // Loss term weights.
+    double earlyTerminationWeight = 0.5;
+    double growthWeight = 0.2;
+    double periodicityWeight = 0.2;
+    double complexityWeight = 0.1;
+
+    // Ideal growth exponent (0 = constant, 1 = linear, 2 = quadratic).
+    double idealGrowthExp = 1.0;
+
+    RuleScore evaluate(const RunStats &stats) const;
+
+    RuleScore evaluate(
+            const std::vector<int> &numActiveCubes,
+            int maxObservedStep,
+            int maxSteps,
+            const std::string &endStatus) const;
+
+    static bool isEarlyTermination(const std::string &endStatus);
+};
+
+#endif //GOL3D_RULEVALUE_H
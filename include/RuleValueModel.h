@@ -0,0 +1,58 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_RULEVALUEMODEL_H
+#define GOL3D_RULEVALUEMODEL_H
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Rule.h"
+
+// Learned estimate of a rule's value, straight from its table, without
+// running it. A port of RuleEncoder and the forward pass of RuleValueMLP in
+// python/learn_rule_value.py, loaded from weights written by its
+// export_weights(). Used to skip simulating rules that are predictably
+// boring.
+class RuleValueModel {
+private:
+    // A fully-connected layer, followed by a ReLU unless it's the last. The
+    // weights are stored transposed and in tiles of tileSize outputs,
+    // [tile][input][output in tile], zero-padded, so each input adds one
+    // contiguous row to a tile's outputs.
+    struct Layer {
+        int inSize = 0;
+        int outSize = 0;
+        std::vector<float> weights;
+        std::vector<float> bias;
+    };
+    std::vector<Layer> layers;
+
+    // Neighbor counts per rule table entry in the encoding (3^numDims - 1).
+    int maxNeighbors = 0;
+
+public:
+    // Rules are predicted in blocks of this many, and each layer's outputs
+    // computed tileSize at a time for the whole block.
+    static const int blockSize = 64;
+    static const int tileSize = 32;
+
+    // Number of states and dimensions of the rules the model was trained on.
+    // Rules with a different number of states can't be predicted.
+    int numStates = 0;
+    int numDims = 0;
+
+    bool encode(const Rule &rule, float *input) const;
+
+    int inputSize() const;
+
+    void load(const std::string &path);
+
+    bool loaded() const;
+
+    void predict(const std::vector<Rule> &rules, std::vector<float> &values, std::vector<bool> &predicted) const;
+};
+
+#endif //GOL3D_RULEVALUEMODEL_H
@@ -0,0 +1,95 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_RUNSTATS_H
+#define GOL3D_RUNSTATS_H
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DamageSpreading.h"
+#include "PeriodDetector.h"
+#include "StatsLog.h"
+
+// Population statistics gathered over a headless run, along with the checks
+// that decide when the run is over.
+class RunStats {
+public:
+    // Population ratios (relative to the initial number of active Cubes) past
+    // which a run counts as an explosion or extinction.
+    float populationGrowthThreshold = 35;
+    float populationDecayThreshold = 0.005;
+
+    // Time step at which a run ends regardless.
+    int maxTimeSteps = 3000;
+
+    // Statistics are recorded every logEveryT time steps.
+    int logEveryT = 5;
+
+    // Per-record state counts, number of active Cubes, and time step. The
+    // state counts are only kept in memory if keepStateLog is set, since runs
+    // writing a binary log don't need them.
+    bool keepStateLog = true;
+    std::vector<std::vector<int>> cubeStateLog;
+    std::vector<int> activeCubeLog;
+    std::vector<int> timeStepLog;
+
+    // Number of active Cubes at the start of the run.
+    int activeCubesInit = 0;
+
+    // Number of active Cubes at the last three records.
+    int prevActiveCubes = -1;
+    int prevPrevActiveCubes = -1;
+    int prevPrevPrevActiveCubes = 0;
+
+    // Time step at which each recorded configuration hash was first seen.
+    std::unordered_map<uint64_t, int> hashTimeSteps;
+
+    // If true, runs also end once the number of active Cubes settles into a
+    // periodic signal, even if the configuration never repeats exactly (as
+    // with moving patterns).
+    bool detectPopulationPeriod = false;
+    PeriodDetector periodDetector;
+
+    // For periodic runs, the period and the first generation of the cycle,
+    // and whether the configuration repeated exactly (or just the population
+    // signal, in which case the onset is approximate).
+    int period = 0;
+    int periodOnset = -1;
+    bool periodExact = false;
+
+    // How a one-Cube perturbation spreads, if the run measured it.
+    DamageSpreading damage;
+
+    // If open, every record is also appended here as it's made.
+    StatsLog log;
+
+    // Why the run ended: "explosion", "extinction", "periodic", "flatline",
+    // or "continue" if it ran out of time steps.
+    std::string endStatus;
+
+    void begin(int numActiveCubes);
+
+    void clear();
+
+    void loadState(const std::vector<char> &data);
+
+    bool record(int timeStep, const std::vector<int> &stateCounts, int numActiveCubes, uint64_t configHash);
+
+    void save(const std::string &ruleString,
+              const std::set<int> &liveStates,
+              const std::string &saveFile) const;
+
+    void relabelStates(const std::vector<int> &stateMap, int numStates);
+
+    std::vector<char> saveState() const;
+
+    bool shouldRecord(int timeStep) const;
+};
+
+#endif //GOL3D_RUNSTATS_H
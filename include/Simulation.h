@@ -0,0 +1,43 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_SIMULATION_H
+#define GOL3D_SIMULATION_H
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "World.h"
+
+// Runs the update cycles of the World's Objects on a thread of their own, so
+// the simulation rate isn't tied to the display's frame rate. The Objects
+// publish RenderSnapshots for World.draw() and take User edits as posted
+// commands, so the two threads never touch the same Cubes.
+class Simulation {
+private:
+    // The thread running loop().
+    std::thread thread;
+
+    // Cleared to ask loop() to exit.
+    std::atomic<bool> running{false};
+
+    // The World whose Objects are being simulated.
+    World *world = nullptr;
+
+    void loop();
+
+public:
+    // Upper limit on the simulation rate, in generations per second. 0 means
+    // run as fast as possible.
+    std::atomic<double> maxGenerationsPerSecond{0.};
+
+    ~Simulation();
+
+    void start(World *world_);
+
+    void stop();
+};
+
+#endif //GOL3D_SIMULATION_H
@@ -0,0 +1,94 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_SLABAUTOMATON_H
+#define GOL3D_SLABAUTOMATON_H
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "BrickWorld.h"
+#include "Rule.h"
+
+#include "ivecHash.h"
+
+// A GeneralizedCellularAutomaton run split across the ranks of an MPI job,
+// for patterns too big for one machine's memory. Space is cut into slabs
+// along x, one per rank, and each rank keeps the active Cubes of its slab.
+// Every generation, neighboring ranks swap one-Cube-thick halo layers twice:
+// the live Cubes on their slabs' faces, before counting live neighbors, and
+// the Cubes there that changed, after updating, since those activate Cubes
+// across the boundary. The active Cubes, state counts and configuration hash
+// are then exactly the serial engine's, generation for generation. Every
+// rebalanceEvery generations, the slab boundaries move so each rank holds
+// about as many active Cubes as the others, and Cubes move to their new
+// ranks.
+//
+// Every rank has to make the same calls, in the same order. MPI must be
+// initialized first.
+class SlabAutomaton {
+private:
+    typedef std::unordered_map<glm::ivec3, uint8_t, KeyFuncs, KeyFuncs> stateMap_t;
+    typedef std::unordered_set<glm::ivec3, KeyFuncs, KeyFuncs> cubeSet_t;
+
+    int rank = 0;
+    int numRanks = 1;
+
+    // Rank r's slab holds the Cubes with slabStarts[r] <= x < slabStarts[r +
+    // 1]. The first and last slabs are unbounded.
+    std::vector<int> slabStarts;
+
+    // States of the slab's active Cubes.
+    stateMap_t cubes;
+
+    // Next state of each (state, live neighbor count), as state * 27 +
+    // count, and whether each state is live.
+    std::vector<uint8_t> ruleTable;
+    std::vector<uint8_t> liveTable;
+
+    // XOR of the Zobrist keys of the slab's non-dead Cubes.
+    uint64_t localHash = 0;
+
+    cubeSet_t exchangeFaces(const std::vector<glm::ivec3> &lowFace, const std::vector<glm::ivec3> &highFace) const;
+
+    void migrate();
+
+    int ownerOf(int x) const;
+
+    void reduce(const std::vector<int> &localCounts);
+
+    void splitSlabs(const std::vector<long long> &planeCounts, int minX);
+
+public:
+    int numStates = 0;
+    int generation = 0;
+
+    // Rebalance the slabs every rebalanceEvery generations (0 for never).
+    int rebalanceEvery = 10;
+
+    // Over all ranks, as of the last generation: the number of active Cubes
+    // in each state (counted as the serial engine's updateState() does), the
+    // total number of active Cubes, and the configuration hash (as in
+    // Object.configHash).
+    std::vector<int> stateCounts;
+    long long numActiveCubes = 0;
+    uint64_t configHash = 0;
+
+    void init(const Rule &rule);
+
+    void load(const BrickWorld &world);
+
+    size_t numLocalCubes() const;
+
+    void rebalance();
+
+    void step();
+};
+
+#endif //GOL3D_SLABAUTOMATON_H
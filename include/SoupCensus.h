@@ -0,0 +1,119 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_SOUPCENSUS_H
+#define GOL3D_SOUPCENSUS_H
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "BatchRunner.h"
+#include "Rule.h"
+
+// One kind of object found by a SoupCensus, up to translation, rotation and
+// reflection.
+struct CensusObject {
+    // apgsearch-style code: xs<number of Cubes> for still lifes, xp<period>
+    // for oscillators and xq<period> for spaceships, then a hash of the
+    // canonical form.
+    std::string code;
+    std::string kind;
+    int period = 1;
+
+    // For spaceships, how far the object moves each period, as its absolute
+    // offsets along the axes in increasing order.
+    glm::ivec3 displacement = glm::ivec3(0, 0, 0);
+
+    // Canonical form: the non-dead Cubes of the phase with the fewest of
+    // them, turned to the orientation that sorts first and moved to start at
+    // the origin, as (x, y, z, state).
+    std::vector<glm::ivec4> cells;
+
+    // Number of times the object was found, number of soups it was found in,
+    // and the lowest of those soups' seeds.
+    long long count = 0;
+    long long numSoups = 0;
+    long long firstSeed = -1;
+};
+
+// Census of the objects rules make, in the manner of apgsearch: each rule is
+// run from many random soups (the initial cube of Cubes, with seeds seed,
+// seed + 1, ...) until its population settles, and what's left is split into
+// components of Cubes within two cells of each other. Each component is run on its own to find its period
+// and how far it moves, and is tallied by its canonical form, which is the
+// same whichever phase and orientation it was found in. Workers take soups
+// rather than rules, so a rule's soups run in parallel, and each keeps its own
+// tally, merged when the rule is done. Components are classified once per
+// worker, by their exact Cubes, since the same few objects make up most of
+// any rule's soups.
+class SoupCensus {
+private:
+    // Objects, soup end statuses and component counts found by a worker.
+    struct Tally {
+        // Objects by canonical form.
+        std::unordered_map<std::string, CensusObject> objects;
+        std::map<std::string, long long> endStatuses;
+        long long numObjects = 0;
+        long long numUnsettled = 0;
+    };
+
+    // What a component turned out to be, cached by its Cubes (moved to start
+    // at the origin). settled is false if it didn't return to itself within
+    // the longest period looked for.
+    struct Classification {
+        bool settled = false;
+        std::string key;
+        CensusObject object;
+    };
+    typedef std::unordered_map<std::string, Classification> classificationCache_t;
+
+    // Index of the next soup to hand out.
+    std::atomic<long long> nextSoup{0};
+
+    // Serializes merging the workers' tallies.
+    std::mutex tallyMutex;
+
+    void censusRule(const std::string &ruleFile, size_t ruleIndex);
+
+    static const Classification &classify(GeneralizedCellularAutomaton &scratch,
+                                          const std::vector<glm::ivec4> &cells,
+                                          int maxPeriod,
+                                          classificationCache_t &cache);
+
+    void work(const Rule &rule, Tally &result);
+
+    void writeReport(const std::string &ruleString, const Tally &tally, double seconds,
+                     const std::string &saveFile) const;
+
+public:
+    // Run settings, as for a batch. Soups end as runs do (with
+    // detectPopulationPeriod always set, so soups left with only moving
+    // objects count as settled), and components are classified up to
+    // periods of options.periodDetector.maxPeriod.
+    BatchOptions options;
+
+    // Rule files to take a census of.
+    std::vector<std::string> ruleFiles;
+
+    // Number of soups run per rule.
+    long long numSoups = 1000;
+
+    // Directory the census reports go to, one per rule, named after the rule
+    // file with the extension .census.json.
+    std::string outDir;
+
+    // Number of rules that failed to load or save.
+    std::atomic<int> numFailed{0};
+
+    void run();
+};
+
+#endif //GOL3D_SOUPCENSUS_H
@@ -0,0 +1,82 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_STATSLOG_H
+#define GOL3D_STATSLOG_H
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+class RunStats;
+
+// Binary, append-only log of a run's statistics. The layout (all
+// little-endian) is a fixed header followed by fixed-width rows, so the rows
+// can be read zero-copy, e.g. with numpy.memmap (see python/stats_log.py):
+//
+//   offset  field
+//        0  char[8]   magic, "GOL3DLOG"
+//        8  uint32    format version
+//       12  uint32    header size, in bytes (rows start here)
+//       16  uint32    number of states
+//       20  uint32    row size, in bytes
+//       24  int64     seed (-1 if seeded from the clock)
+//       32  int32     maxSteps
+//       36  int32     logEveryT
+//       40  uint32    liveStates, as a bitmask
+//       44  int32     period (0 unless periodic)
+//       48  int32     periodOnset
+//       52  uint32    flags: 1 = periodExact, 2 = closed (run finished)
+//       56  char[24]  endStatus, zero-padded
+//       80  uint32    rule string length
+//       84  char[]    rule string, zero-padded to a multiple of 8
+//
+// Each row is an int32 time step, an int32 number of active Cubes, then one
+// int32 Cube count per state. Rows are appended as they're recorded; the
+// period, flags and endStatus fields are filled in by close().
+class StatsLog {
+private:
+    FILE *file = nullptr;
+
+    static const int endStatusSize = 24;
+
+public:
+    static const uint32_t version = 1;
+
+    static const uint32_t flagPeriodExact = 1;
+    static const uint32_t flagClosed = 2;
+
+    StatsLog() = default;
+    StatsLog(const StatsLog&) = delete;
+    StatsLog &operator=(const StatsLog&) = delete;
+    ~StatsLog();
+
+    void append(int timeStep, int numActiveCubes, const std::vector<int> &stateCounts);
+
+    void close(const RunStats &stats);
+
+    void flush();
+
+    bool isOpen() const;
+
+    void open(const std::string &path,
+              const std::string &ruleString,
+              const std::set<int> &liveStates,
+              int numStates,
+              long long seed,
+              int maxSteps,
+              int logEveryT);
+
+    void resume(const std::string &path, size_t numRows);
+
+    static void read(const std::string &path,
+                     RunStats &stats,
+                     std::string &ruleString,
+                     std::set<int> &liveStates);
+};
+
+#endif //GOL3D_STATSLOG_H
@@ -0,0 +1,88 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_SUCCESSIVEHALVING_H
+#define GOL3D_SUCCESSIVEHALVING_H
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "BatchRunner.h"
+#include "Rule.h"
+
+// Ranks a list of rule files by successive halving: every rule is run for a
+// short horizon and scored on its run so far, only the best 1/eta of the runs
+// still going carry on, for eta times as long, and so on until the survivors
+// reach the end of a full run. Survivors continue from in-memory Checkpoints
+// instead of starting over, so most of the compute goes to the most
+// promising rules.
+class SuccessiveHalving {
+private:
+    // A rule in the search, and how far it got.
+    struct Candidate {
+        std::string ruleFile;
+        Rule rule;
+        std::string ruleString;
+
+        // State to continue the run from, while it's still in the running.
+        std::vector<char> checkpoint;
+        double elapsed = 0.;
+
+        // Round the rule was last run in, and the last time step recorded.
+        int round = 0;
+        int timeStep = 0;
+
+        // How the run ended, or "continue" if it hasn't, and its value (as if
+        // it ended there, if it hasn't). scored is false if there was too
+        // little data to compute the value.
+        std::string endStatus;
+        double value = 0.;
+        bool scored = false;
+
+        bool finished = false;
+        bool failed = false;
+    };
+    std::vector<Candidate> candidates;
+
+    // Rules to run in the current round, and the index of the next one to
+    // hand out.
+    std::vector<size_t> running;
+    std::atomic<size_t> nextRunning{0};
+
+    // Serializes progress output.
+    std::mutex printMutex;
+
+    void work(int round, int untilTimeStep);
+
+    void writeRanking() const;
+
+public:
+    BatchOptions options;
+
+    // Rule files to rank.
+    std::vector<std::string> ruleFiles;
+
+    // Fraction (1/eta) of the runs kept each round, and how many times longer
+    // the next round's horizon is.
+    int eta = 3;
+
+    // Time step the first round runs to.
+    int firstHorizon = 250;
+
+    // Directory for ranking.json, and for the results of the rules whose runs
+    // finished, named after their rule files as in a batch.
+    std::string outDir;
+
+    // Total number of time steps simulated, and of rules that failed to load
+    // or save.
+    std::atomic<long long> numTimeSteps{0};
+    std::atomic<int> numFailed{0};
+
+    void run();
+};
+
+#endif //GOL3D_SUCCESSIVEHALVING_H
@@ -0,0 +1,62 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_TRIPLEBUFFER_H
+#define GOL3D_TRIPLEBUFFER_H
+#pragma once
+
+#include <atomic>
+
+// Lock-free single-producer, single-consumer triple buffer. The writer fills
+// its back buffer and publishes it; the reader picks up the most recently
+// published buffer whenever it likes. Neither side ever waits on the other,
+// and a buffer is never read while it's being written.
+template<typename T>
+class TripleBuffer {
+private:
+    // Bit set in `middle` when it holds a buffer the reader hasn't seen yet.
+    static const int freshBit = 4;
+    static const int indexMask = 3;
+
+    T buffers[3];
+
+    // Index of the buffer being written. Only touched by the writer.
+    int back = 0;
+
+    // Index of the buffer handed off between the writer and reader, plus
+    // the fresh bit.
+    std::atomic<int> middle{1};
+
+    // Index of the buffer being read. Only touched by the reader.
+    int front = 2;
+
+public:
+    // Writer side: the buffer to fill before calling publish().
+    T &writeBuffer() {
+        return buffers[back];
+    }
+
+    // Writer side: hands the back buffer to the reader and takes over the old
+    // middle buffer for the next write.
+    void publish() {
+        back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Reader side: swaps in the most recently published buffer, if there is
+    // one. Returns true if readBuffer() changed.
+    bool update() {
+        if(!(middle.load(std::memory_order_acquire) & freshBit)) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    // Reader side: the buffer most recently picked up by update().
+    const T &readBuffer() const {
+        return buffers[front];
+    }
+};
+
+#endif //GOL3D_TRIPLEBUFFER_H
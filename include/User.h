@@ -66,7 +66,8 @@ private:
     float horizontalAngle0;
     float verticalAngle0;
 
-    // Variables to control Cube drawing.
+    // Variables to control Cube drawing. The draw* flags other than drawStart
+    // are only touched by commands posted to the active Object.
     // Initializes drawing.
     bool drawStart;
     // If true, draw live Cubes at the cursor.
@@ -106,8 +107,12 @@ private:
     GLuint *programCursor;
 
 
+    void beginDraw(GeneralizedCellularAutomaton *obj, glm::ivec3 key);
+
     void computeRegionBounds();
 
+    void drawAt(GeneralizedCellularAutomaton *obj, glm::ivec3 key);
+
     void reflectRegion(int axis);
 
     void rotateRegion(bool clockwise);
@@ -162,7 +167,8 @@ public:
     int numSetSelections;
     // Clipboard for a region of Cubes to cut/copy/paste. Keys use
     // coordinates relative to a bottom-left front corner of (0,0,0).
-    // Stores any non-dead cube states
+    // Stores any non-dead cube states. Only touched by commands posted to the
+    // active Object.
     intMap_t clipBoard;
     
     User();
@@ -6,6 +6,7 @@
 #define GOL3D_WORLD_H
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include <GL/glew.h>
@@ -56,6 +57,13 @@ public:
     // Counts the actual number of Cubes drawn each frame.
     int drawCount = 0;
 
+    // Where O saves the active GCA's Checkpoint, and Shift+O loads it from.
+    std::string checkpointFile = "checkpoint.gckpt";
+
+    // True while a Simulation thread is updating the Objects. The World then
+    // only forwards input to them.
+    bool threaded = false;
+
     // ID of the Cube texture atlas.
     GLuint atlasTex;
 
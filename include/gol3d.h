@@ -0,0 +1,135 @@
+//
+// Created by matt on 10/18/26.
+//
+
+#ifndef GOL3D_GOL3D_H
+#define GOL3D_GOL3D_H
+#pragma once
+
+// C API of libgol3d, for driving GeneralizedCellularAutomatons in-process
+// from other languages, e.g. Python through ctypes (see python/gol3d.py).
+// No OpenGL dependency.
+//
+// Functions returning int return 0 (or a count) on success, and -1 on
+// failure, with gol3d_last_error() describing it. Outputs go to
+// caller-provided buffers, and functions filling a buffer return the number
+// of items available, which may be more than the buffer holds. An automaton
+// may only be used by one thread at a time.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define GOL3D_API __declspec(dllexport)
+#else
+#define GOL3D_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Version of the API, bumped whenever it changes incompatibly.
+#define GOL3D_API_VERSION 1
+
+typedef struct gol3d_automaton gol3d_automaton;
+
+// A configuration captured from an automaton, held in bricks that its forks
+// share copy-on-write (see BrickWorld.h).
+typedef struct gol3d_world gol3d_world;
+
+GOL3D_API int gol3d_api_version(void);
+
+// Message describing the calling thread's last failure.
+GOL3D_API const char *gol3d_last_error(void);
+
+// Creates an automaton with room preallocated for initNumCubes Cubes (0 for
+// a default), or returns null on failure. It has no rule until one is set.
+GOL3D_API gol3d_automaton *gol3d_create(int initNumCubes);
+
+GOL3D_API void gol3d_destroy(gol3d_automaton *gol);
+
+// Sets the rule from JSON text in the rule file format, from a rule file, or
+// from a table of next states: table[state * 27 + count] is the next state
+// of a Cube in that state with count live neighbors. Clears the automaton.
+GOL3D_API int gol3d_set_rule_json(gol3d_automaton *gol, const char *json);
+GOL3D_API int gol3d_set_rule_file(gol3d_automaton *gol, const char *path);
+GOL3D_API int gol3d_set_rule_table(gol3d_automaton *gol, int numStates, const int *table,
+                                   const int *liveStates, int numLiveStates);
+
+// Clears the automaton, and seeds a cube of Cubes of half-width hwidth
+// around the origin, in state s + 1 with probability probs[s] (as in the
+// headless runner). A negative seed seeds from the clock.
+GOL3D_API int gol3d_seed_soup(gol3d_automaton *gol, int hwidth, const float *probs, int numProbs,
+                              long long seed);
+
+// Sets Cubes' states: xyz holds numCells (x, y, z) triples.
+GOL3D_API int gol3d_set_cells(gol3d_automaton *gol, const int *xyz, const int *states, long long numCells);
+
+// Runs numGenerations generations.
+GOL3D_API int gol3d_step(gol3d_automaton *gol, int numGenerations);
+
+GOL3D_API int gol3d_generation(const gol3d_automaton *gol);
+
+GOL3D_API int gol3d_num_states(const gol3d_automaton *gol);
+
+// Hash of the configuration (every Cube's position and state).
+GOL3D_API uint64_t gol3d_config_hash(const gol3d_automaton *gol);
+
+// Copies the number of Cubes in each state, as of the last generation, into
+// counts, which holds capacity ints. Returns the number of states.
+GOL3D_API int gol3d_state_counts(const gol3d_automaton *gol, int *counts, int capacity);
+
+// Copies the positions (as (x, y, z) triples) and states of the Cubes that
+// aren't dead into xyz and states, which hold capacity Cubes. Either may be
+// null to just count them. Returns the number of such Cubes.
+GOL3D_API long long gol3d_cells(const gol3d_automaton *gol, int *xyz, int *states, long long capacity);
+
+// Sets lo and hi (3 ints each) to the lowest and highest corners of the
+// smallest box holding every Cube that isn't dead, if there are any. Returns
+// the number of such Cubes.
+GOL3D_API long long gol3d_bounds(const gol3d_automaton *gol, int *lo, int *hi);
+
+// Writes the states of the Cubes in the box with lowest corner lo and size
+// size (3 ints each) into out, a C-ordered uint8 array of shape
+// (size[0], size[1], size[2]), so cell (x, y, z) is at
+// out[((x - lo[0]) * size[1] + (y - lo[1])) * size[2] + (z - lo[2])]. Uses up
+// to numThreads threads (0 for one per core).
+GOL3D_API int gol3d_rasterize(const gol3d_automaton *gol, const int *lo, const int *size, uint8_t *out,
+                              int numThreads);
+
+// Copies the rule's string representation, null-terminated and truncated to
+// capacity bytes, into buffer. Returns its full length.
+GOL3D_API int gol3d_rule_string(const gol3d_automaton *gol, char *buffer, int capacity);
+
+// Captures the automaton's configuration as a world, finishing the
+// generation under way first, or returns null on failure.
+GOL3D_API gol3d_world *gol3d_capture(gol3d_automaton *gol);
+
+// Forks a world, sharing all of its bricks, or returns null on failure. Either
+// can then be edited without affecting the other.
+GOL3D_API gol3d_world *gol3d_world_fork(const gol3d_world *world);
+
+GOL3D_API void gol3d_world_destroy(gol3d_world *world);
+
+// Sets Cubes' states in a world, copying only the bricks they land in that
+// another fork still holds: xyz holds numCells (x, y, z) triples.
+GOL3D_API int gol3d_world_set_cells(gol3d_world *world, const int *xyz, const int *states, long long numCells);
+
+// Restores an automaton to a world, replacing its rule and Cubes, ready to
+// run on from the world's generation.
+GOL3D_API int gol3d_restore(gol3d_automaton *gol, const gol3d_world *world);
+
+// Estimate of the memory, in bytes, held by a world alone, i.e. the cost of a
+// fork on top of the world it was forked from.
+GOL3D_API long long gol3d_world_memory_usage(const gol3d_world *world);
+
+// Number of a world's bricks, and of those another fork also holds.
+GOL3D_API long long gol3d_world_num_bricks(const gol3d_world *world);
+GOL3D_API long long gol3d_world_num_shared_bricks(const gol3d_world *world);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //GOL3D_GOL3D_H
@@ -1,3 +1,4 @@
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <set>
@@ -9,4 +10,6 @@ bool in(const std::set<int> &theSet, const int &theItem);
 
 std::vector<std::string> split(const std::string &str, const std::string &delim);
 
+uint64_t stringHash(const std::string &str);
+
 #endif //GOL3D_UTILS_H
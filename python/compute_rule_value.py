@@ -60,7 +60,7 @@ class CAValueFunction:
         """
         # Check for early termination conditions
         end_status = simulation_dict.get("endStatus", None)
-        if end_status in ["explosion", "extinction", "flatline"]:
+        if end_status in ["explosion", "extinction", "flatline", "periodic"]:
             early_termination_loss = self._early_termination_loss(simulation_dict)
             loss = self.early_termination_weight * early_termination_loss \
                    + self.growth_weight + self.periodicity_weight + self.complexity_weight
@@ -0,0 +1,384 @@
+import ctypes
+import json
+import os
+
+import numpy as np
+
+
+API_VERSION = 1
+
+
+def _find_library():
+    """
+    Path of libgol3d: $GOL3D_LIB if set, else the first build directory next to
+    this one that has it
+    """
+    if 'GOL3D_LIB' in os.environ:
+        return os.environ['GOL3D_LIB']
+    names = ['libgol3d.so', 'libgol3d.dylib', 'gol3d.dll']
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    for build_dir in ['build', 'cmake-build-release', 'cmake-build-debug']:
+        for name in names:
+            path = os.path.join(root, build_dir, name)
+            if os.path.exists(path):
+                return path
+    raise OSError('libgol3d not found; build the gol3d_shared target or set GOL3D_LIB')
+
+
+_lib = None
+
+
+def _library():
+    """
+    Load libgol3d and declare its functions, the first time it's needed
+    """
+    global _lib
+    if _lib is not None:
+        return _lib
+
+    lib = ctypes.CDLL(_find_library())
+    c_int_p = ctypes.POINTER(ctypes.c_int)
+    c_float_p = ctypes.POINTER(ctypes.c_float)
+    c_uint8_p = ctypes.POINTER(ctypes.c_uint8)
+    signatures = {
+        'gol3d_api_version': (ctypes.c_int, []),
+        'gol3d_last_error': (ctypes.c_char_p, []),
+        'gol3d_create': (ctypes.c_void_p, [ctypes.c_int]),
+        'gol3d_destroy': (None, [ctypes.c_void_p]),
+        'gol3d_set_rule_json': (ctypes.c_int, [ctypes.c_void_p, ctypes.c_char_p]),
+        'gol3d_set_rule_file': (ctypes.c_int, [ctypes.c_void_p, ctypes.c_char_p]),
+        'gol3d_set_rule_table': (ctypes.c_int, [ctypes.c_void_p, ctypes.c_int, c_int_p, c_int_p, ctypes.c_int]),
+        'gol3d_seed_soup': (ctypes.c_int, [ctypes.c_void_p, ctypes.c_int, c_float_p, ctypes.c_int,
+                                           ctypes.c_longlong]),
+        'gol3d_set_cells': (ctypes.c_int, [ctypes.c_void_p, c_int_p, c_int_p, ctypes.c_longlong]),
+        'gol3d_step': (ctypes.c_int, [ctypes.c_void_p, ctypes.c_int]),
+        'gol3d_generation': (ctypes.c_int, [ctypes.c_void_p]),
+        'gol3d_num_states': (ctypes.c_int, [ctypes.c_void_p]),
+        'gol3d_config_hash': (ctypes.c_uint64, [ctypes.c_void_p]),
+        'gol3d_state_counts': (ctypes.c_int, [ctypes.c_void_p, c_int_p, ctypes.c_int]),
+        'gol3d_cells': (ctypes.c_longlong, [ctypes.c_void_p, c_int_p, c_int_p, ctypes.c_longlong]),
+        'gol3d_bounds': (ctypes.c_longlong, [ctypes.c_void_p, c_int_p, c_int_p]),
+        'gol3d_rasterize': (ctypes.c_int, [ctypes.c_void_p, c_int_p, c_int_p, c_uint8_p, ctypes.c_int]),
+        'gol3d_rule_string': (ctypes.c_int, [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int]),
+        'gol3d_capture': (ctypes.c_void_p, [ctypes.c_void_p]),
+        'gol3d_world_fork': (ctypes.c_void_p, [ctypes.c_void_p]),
+        'gol3d_world_destroy': (None, [ctypes.c_void_p]),
+        'gol3d_world_set_cells': (ctypes.c_int, [ctypes.c_void_p, c_int_p, c_int_p, ctypes.c_longlong]),
+        'gol3d_restore': (ctypes.c_int, [ctypes.c_void_p, ctypes.c_void_p]),
+        'gol3d_world_memory_usage': (ctypes.c_longlong, [ctypes.c_void_p]),
+        'gol3d_world_num_bricks': (ctypes.c_longlong, [ctypes.c_void_p]),
+        'gol3d_world_num_shared_bricks': (ctypes.c_longlong, [ctypes.c_void_p]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        function = getattr(lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+
+    version = lib.gol3d_api_version()
+    if version != API_VERSION:
+        raise OSError(f'libgol3d API version {version}, expected {API_VERSION}')
+    _lib = lib
+    return lib
+
+
+def _check(result):
+    """
+    Raise the library's last error if a call failed
+    """
+    if result < 0:
+        raise RuntimeError(_library().gol3d_last_error().decode())
+    return result
+
+
+def _int_pointer(array):
+    return array.ctypes.data_as(ctypes.POINTER(ctypes.c_int))
+
+
+def _cell_arrays(xyz, states):
+    """
+    Cube positions and states as contiguous int arrays of shapes (n, 3) and (n,)
+    """
+    xyz = np.ascontiguousarray(xyz, dtype=np.intc).reshape(-1, 3)
+    states = np.ascontiguousarray(states, dtype=np.intc).reshape(-1)
+    if len(states) != len(xyz):
+        raise ValueError('xyz and states must have the same length')
+    return xyz, states
+
+
+class World:
+    """
+    A configuration captured from an Automaton, held in bricks that its forks
+    share copy-on-write, so a world can be branched into many variants with
+    small edits, each restored into an Automaton to run forward
+
+    Example:
+        world = gol.capture()
+        variant = world.fork()
+        variant.set_cells([[0, 0, 0]], [0])
+        other = Automaton()
+        other.restore(variant)
+        other.step(100)
+    """
+
+    def __init__(self, handle):
+        if not handle:
+            raise RuntimeError(_library().gol3d_last_error().decode())
+        self._handle = handle
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _library().gol3d_world_destroy(self._handle)
+            self._handle = None
+
+    def fork(self):
+        """
+        Copy of the world sharing all of its bricks. Either can then be edited
+        without affecting the other
+        """
+        return World(_library().gol3d_world_fork(self._handle))
+
+    def set_cells(self, xyz, states):
+        """
+        Set Cubes' states, copying only the bricks they land in that another
+        fork still holds
+
+        Parameters:
+        -----------
+        xyz : array-like, shape (n, 3)
+            Cube positions
+        states : array-like, shape (n,)
+            Their new states
+        """
+        xyz, states = _cell_arrays(xyz, states)
+        _check(_library().gol3d_world_set_cells(self._handle, _int_pointer(xyz), _int_pointer(states),
+                                                len(states)))
+
+    @property
+    def memory_usage(self):
+        """
+        Estimated bytes held by this world alone: the cost of a fork on top of
+        the world it was forked from
+        """
+        return _check(_library().gol3d_world_memory_usage(self._handle))
+
+    @property
+    def num_bricks(self):
+        return _check(_library().gol3d_world_num_bricks(self._handle))
+
+    @property
+    def num_shared_bricks(self):
+        """
+        Number of the world's bricks that another fork also holds
+        """
+        return _check(_library().gol3d_world_num_shared_bricks(self._handle))
+
+
+class Automaton:
+    """
+    A GeneralizedCellularAutomaton run in-process through libgol3d, with no
+    executable to spawn and no files to read back
+
+    Example:
+        gol = Automaton(rule_file='rule.json')
+        gol.seed_soup(seed=1)
+        for _ in range(100):
+            gol.step()
+            population.append(gol.state_counts()[1:].sum())
+    """
+
+    def __init__(self, rule=None, rule_file=None, init_num_cubes=0):
+        """
+        Parameters:
+        -----------
+        rule : dict, str or None
+            Rule in the rule file format, as a dict or JSON text
+        rule_file : str or None
+            Path of a rule file, if rule isn't given
+        init_num_cubes : int
+            Number of Cubes to preallocate room for (0 for a default)
+        """
+        lib = _library()
+        self._handle = lib.gol3d_create(init_num_cubes)
+        if not self._handle:
+            raise RuntimeError(lib.gol3d_last_error().decode())
+        if rule is not None:
+            self.set_rule(rule)
+        elif rule_file is not None:
+            self.set_rule_file(rule_file)
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _library().gol3d_destroy(self._handle)
+            self._handle = None
+
+    def set_rule(self, rule):
+        """
+        Set the rule from a dict or JSON text in the rule file format, clearing
+        the automaton
+        """
+        text = rule if isinstance(rule, str) else json.dumps(rule)
+        _check(_library().gol3d_set_rule_json(self._handle, text.encode()))
+
+    def set_rule_file(self, path):
+        """
+        Set the rule from a rule file, clearing the automaton
+        """
+        _check(_library().gol3d_set_rule_file(self._handle, str(path).encode()))
+
+    def set_rule_table(self, table, live_states):
+        """
+        Set the rule from a table of next states, clearing the automaton
+
+        Parameters:
+        -----------
+        table : array-like, shape (num_states, 27)
+            table[state, count] is the next state of a Cube in that state with
+            count live neighbors
+        live_states : iterable of int
+            States that count as live neighbors
+        """
+        table = np.ascontiguousarray(table, dtype=np.intc)
+        if table.ndim != 2 or table.shape[1] != 27:
+            raise ValueError('The table must have shape (num_states, 27)')
+        live = np.ascontiguousarray(sorted(live_states), dtype=np.intc)
+        _check(_library().gol3d_set_rule_table(self._handle, table.shape[0], _int_pointer(table),
+                                               _int_pointer(live), len(live)))
+
+    def seed_soup(self, hwidth=10, probs=(0.15,), seed=-1):
+        """
+        Clear the automaton and seed a cube of Cubes, as the headless runner
+        does: each Cube within hwidth of the origin is in state s + 1 with
+        probability probs[s]. A negative seed seeds from the clock
+        """
+        probs = np.ascontiguousarray(probs, dtype=np.float32)
+        _check(_library().gol3d_seed_soup(self._handle, hwidth,
+                                          probs.ctypes.data_as(ctypes.POINTER(ctypes.c_float)),
+                                          len(probs), seed))
+
+    def set_cells(self, xyz, states):
+        """
+        Set Cubes' states
+
+        Parameters:
+        -----------
+        xyz : array-like, shape (n, 3)
+            Cube positions
+        states : array-like, shape (n,)
+            Their new states
+        """
+        xyz, states = _cell_arrays(xyz, states)
+        _check(_library().gol3d_set_cells(self._handle, _int_pointer(xyz), _int_pointer(states), len(states)))
+
+    def capture(self):
+        """
+        The automaton's configuration as a World, finishing the generation
+        under way first
+        """
+        return World(_library().gol3d_capture(self._handle))
+
+    def restore(self, world):
+        """
+        Replace the automaton's rule and Cubes with a World's, ready to run on
+        from the world's generation
+        """
+        _check(_library().gol3d_restore(self._handle, world._handle))
+
+    def step(self, num_generations=1):
+        """
+        Run num_generations generations
+        """
+        _check(_library().gol3d_step(self._handle, num_generations))
+
+    @property
+    def generation(self):
+        return _check(_library().gol3d_generation(self._handle))
+
+    @property
+    def num_states(self):
+        return _check(_library().gol3d_num_states(self._handle))
+
+    @property
+    def config_hash(self):
+        return _library().gol3d_config_hash(self._handle)
+
+    @property
+    def rule_string(self):
+        lib = _library()
+        length = _check(lib.gol3d_rule_string(self._handle, None, 0))
+        buffer = ctypes.create_string_buffer(length + 1)
+        lib.gol3d_rule_string(self._handle, buffer, length + 1)
+        return buffer.value.decode()
+
+    def state_counts(self):
+        """
+        Number of active Cubes in each state, as of the last generation
+        """
+        counts = np.zeros(self.num_states, dtype=np.intc)
+        _check(_library().gol3d_state_counts(self._handle, _int_pointer(counts), len(counts)))
+        return counts
+
+    def cells(self):
+        """
+        Positions, shape (n, 3), and states, shape (n,), of the Cubes that
+        aren't dead
+        """
+        lib = _library()
+        num_cells = _check(lib.gol3d_cells(self._handle, None, None, 0))
+        xyz = np.zeros((num_cells, 3), dtype=np.intc)
+        states = np.zeros(num_cells, dtype=np.intc)
+        _check(lib.gol3d_cells(self._handle, _int_pointer(xyz), _int_pointer(states), num_cells))
+        return xyz, states
+
+    def bounds(self):
+        """
+        Lowest and highest corners, shape (3,) each, of the smallest box holding
+        every Cube that isn't dead, or None if they're all dead
+        """
+        lo = np.zeros(3, dtype=np.intc)
+        hi = np.zeros(3, dtype=np.intc)
+        if _check(_library().gol3d_bounds(self._handle, _int_pointer(lo), _int_pointer(hi))) == 0:
+            return None
+        return lo, hi
+
+    def rasterize(self, lo=None, size=None, out=None, num_threads=0):
+        """
+        States of the Cubes in a box, as a dense uint8 array of shape size
+        indexed [x - lo[0], y - lo[1], z - lo[2]], with 0 where there's no live
+        Cube. The library writes straight into the array, so passing the same
+        out every step rasterizes without allocating or copying
+
+        Parameters:
+        -----------
+        lo : array-like, shape (3,), or None
+            Lowest corner of the box. Defaults to that of bounds()
+        size : array-like, shape (3,), or None
+            Size of the box. Defaults to out's shape, or to the size of
+            bounds()
+        out : np.ndarray or None
+            C-contiguous uint8 array of shape size to write into
+        num_threads : int
+            Most threads to use (0 for one per core)
+        """
+        if lo is None or (size is None and out is None):
+            box = self.bounds()
+            if box is None:
+                box = (np.zeros(3, dtype=np.intc), np.full(3, -1, dtype=np.intc))
+            if lo is None:
+                lo = box[0]
+            if size is None and out is None:
+                size = box[1] - box[0] + 1
+        if size is None:
+            size = out.shape
+        lo = np.ascontiguousarray(lo, dtype=np.intc).reshape(3)
+        size = np.ascontiguousarray(size, dtype=np.intc).reshape(3)
+        if (size < 0).any():
+            raise ValueError('size must not be negative')
+        shape = tuple(int(n) for n in size)
+        if out is None:
+            out = np.empty(shape, dtype=np.uint8)
+        elif (out.dtype != np.uint8 or out.shape != shape or not out.flags['C_CONTIGUOUS']
+              or not out.flags['WRITEABLE']):
+            raise ValueError(f'out must be a writeable, C-contiguous uint8 array of shape {shape}')
+        _check(_library().gol3d_rasterize(self._handle, _int_pointer(lo), _int_pointer(size),
+                                          out.ctypes.data_as(ctypes.POINTER(ctypes.c_uint8)), num_threads))
+        return out
@@ -2,6 +2,43 @@ import torch
 import torch.nn as nn
 import numpy as np
 import json
+import sys
+
+
+def export_weights(state_dict, n_states, n_dims, path):
+    """
+    Export a RuleValueMLP's weights as JSON, for the C++ prefilter
+    (RuleValueModel in include/RuleValueModel.h)
+
+    Parameters:
+    -----------
+    state_dict : dict
+        The model's state dict
+    n_states : int
+        Number of states of the rules the model was trained on
+    n_dims : int
+        Number of dimensions of the rules the model was trained on
+    path : str
+        Path of the JSON file to write
+    """
+    # The Linear layers are network.0, network.2, ..., with a ReLU between
+    # each pair.
+    indices = sorted({int(key.split('.')[1]) for key in state_dict if key.startswith('network.')})
+    layers = []
+    for i in indices:
+        layers.append({
+            'weight': state_dict[f'network.{i}.weight'].tolist(),
+            'bias': state_dict[f'network.{i}.bias'].tolist(),
+        })
+
+    with open(path, 'w') as f:
+        json.dump({
+            'format': 'gol3d-rule-value-mlp',
+            'version': 1,
+            'n_states': n_states,
+            'n_dims': n_dims,
+            'layers': layers,
+        }, f)
 
 
 class RuleEncoder:
@@ -189,4 +226,16 @@ class RuleValueTrainer:
                              f"but current n_states={self.n_states}, n_dims={self.n_dims}")
 
         self.model.load_state_dict(checkpoint['model_state_dict'])
-        self.optimizer.load_state_dict(checkpoint['optimizer_state_dict'])
\ No newline at end of file
+        self.optimizer.load_state_dict(checkpoint['optimizer_state_dict'])
+
+    def export_weights(self, path):
+        """Export the model's weights as JSON, for the C++ prefilter"""
+        export_weights(self.model.state_dict(), self.n_states, self.n_dims, path)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print(f'Usage: {sys.argv[0]} <model.pt> <weights.json>')
+        sys.exit(1)
+    checkpoint = torch.load(sys.argv[1])
+    export_weights(checkpoint['model_state_dict'], checkpoint['n_states'], checkpoint['n_dims'], sys.argv[2])
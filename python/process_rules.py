@@ -1,27 +1,44 @@
 import os
 import subprocess
 
-import tqdm
-
 ROOT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
-GOL3D_EXEC = os.path.join(ROOT_DIR, 'cmake-build-release', 'gol3d')
+GOL3D_EXEC = os.path.join(ROOT_DIR, 'cmake-build-release', 'gol3d_headless')
+
+# Most rule paths passed to one gol3d_headless batch, to keep its command line
+# well under the system's argument length limit.
+MAX_PATHS_PER_BATCH = 1000
 
 
 def process_rules(
         rule_files: list[str],
-        save_dir: str) -> None:
+        save_dir: str,
+        num_workers: int = 0,
+        time_limit: float = 0.,
+        memory_limit: float = 0.) -> None:
     """Run simulations for a collection of rule files.
 
+    The rules run in gol3d_headless batches of up to MAX_PATHS_PER_BATCH paths
+    each, spread over its worker threads.
+
     Args:
-    rule_files: Paths to rule file JSONs.
+    rule_files: Paths to rule file JSONs, or to directories of them.
     save_dir: Dir to save run stats to.
+    num_workers: Number of worker threads. 0 uses one per hardware thread.
+    time_limit: Per-rule wall-clock limit, in seconds. 0 means no limit.
+    memory_limit: Per-rule memory limit, in MB. 0 means no limit.
 
     Returns: None
+
+    Raises: subprocess.CalledProcessError if a batch fails.
     """
-    for rule_file in tqdm.tqdm(rule_files):
-        save_file = os.path.join(save_dir, os.path.basename(rule_file))
-        run_cmd = f'{GOL3D_EXEC} {rule_file} {save_file}'
-        subprocess.run(run_cmd, shell=True)
+    for i in range(0, len(rule_files), MAX_PATHS_PER_BATCH):
+        run_cmd = [
+            GOL3D_EXEC, '--batch', '--out', save_dir,
+            '--workers', str(num_workers),
+            '--time-limit', str(time_limit),
+            '--memory-limit', str(memory_limit),
+        ] + rule_files[i:i + MAX_PATHS_PER_BATCH]
+        subprocess.run(run_cmd, check=True)
     return
 
 
@@ -33,8 +50,5 @@ if __name__ == '__main__':
     else:
         save_dir = rule_dir.replace('rules', 'results')
 
-    rule_files = [
-        os.path.join(rule_dir, f) for f in os.listdir(rule_dir)
-        if f.endswith('.json')
-    ]
-    process_rules(rule_files, save_dir)
+    # gol3d_headless reads the directory's rule files itself.
+    process_rules([rule_dir], save_dir)
@@ -0,0 +1,141 @@
+import json
+import sys
+
+import numpy as np
+
+
+MAGIC = b'GOL3DLOG'
+
+# Fixed part of the header written by StatsLog::open() (see include/StatsLog.h).
+# The rule string follows it, padded so the rows start 8-byte aligned.
+HEADER_DTYPE = np.dtype([
+    ('magic', 'S8'),
+    ('version', '<u4'),
+    ('header_size', '<u4'),
+    ('num_states', '<u4'),
+    ('row_size', '<u4'),
+    ('seed', '<i8'),
+    ('max_steps', '<i4'),
+    ('log_every_t', '<i4'),
+    ('live_states', '<u4'),
+    ('period', '<i4'),
+    ('period_onset', '<i4'),
+    ('flags', '<u4'),
+    ('end_status', 'S24'),
+    ('rule_string_length', '<u4'),
+])
+
+FLAG_PERIOD_EXACT = 1
+FLAG_CLOSED = 2
+
+
+class StatsLog:
+    """
+    Reader for the binary statistics logs written by gol3d_headless --binary
+
+    The rows are memory-mapped rather than read, so loading a log is cheap
+    regardless of its length
+    """
+
+    def __init__(self, path):
+        """
+        Parameters:
+        -----------
+        path : str
+            Path of the .gstats file
+        """
+        header = np.fromfile(path, dtype=HEADER_DTYPE, count=1)
+        if len(header) == 0 or header['magic'][0] != MAGIC:
+            raise ValueError(f'Not a stats log: {path}')
+        header = header[0]
+
+        self.path = path
+        self.version = int(header['version'])
+        self.num_states = int(header['num_states'])
+        self.seed = int(header['seed'])
+        self.max_steps = int(header['max_steps'])
+        self.log_every_t = int(header['log_every_t'])
+        self.live_states = [s for s in range(32) if int(header['live_states']) & (1 << s)]
+        self.period = int(header['period'])
+        self.period_onset = int(header['period_onset'])
+        self.period_exact = bool(header['flags'] & FLAG_PERIOD_EXACT)
+        self.closed = bool(header['flags'] & FLAG_CLOSED)
+        self.end_status = header['end_status'].decode()
+
+        with open(path, 'rb') as f:
+            f.seek(HEADER_DTYPE.itemsize)
+            self.rule_string = f.read(int(header['rule_string_length'])).decode()
+
+        row_dtype = np.dtype([
+            ('timeStep', '<i4'),
+            ('numActiveCubes', '<i4'),
+            ('stateCounts', '<i4', (self.num_states,)),
+        ])
+        assert row_dtype.itemsize == header['row_size']
+
+        # A run that crashed leaves a partial last row, which is dropped.
+        header_size = int(header['header_size'])
+        with open(path, 'rb') as f:
+            f.seek(0, 2)
+            num_rows = (f.tell() - header_size) // row_dtype.itemsize
+        if num_rows > 0:
+            self.rows = np.memmap(path, dtype=row_dtype, mode='r', offset=header_size, shape=(num_rows,))
+        else:
+            self.rows = np.zeros(0, dtype=row_dtype)
+
+    @property
+    def time_steps(self):
+        return self.rows['timeStep']
+
+    @property
+    def active_cubes(self):
+        return self.rows['numActiveCubes']
+
+    @property
+    def state_counts(self):
+        return self.rows['stateCounts']
+
+    def to_legacy_json(self):
+        """
+        Convert to the JSON results format written by RunStats::save()
+
+        Returns:
+        --------
+        dict
+            The results, ready for json.dump()
+        """
+        result = {
+            'ruleString': self.rule_string,
+            'endStatus': self.end_status,
+            'maxSteps': self.max_steps,
+        }
+        if self.end_status == 'periodic':
+            result['period'] = self.period
+            result['periodOnset'] = self.period_onset
+            result['periodExact'] = self.period_exact
+        result['liveStates'] = self.live_states
+
+        live = [s for s in self.live_states if s < self.num_states]
+        dying = [s for s in range(1, self.num_states) if s not in self.live_states]
+        population_record = {}
+        for row in self.rows:
+            state_counts = [int(c) for c in row['stateCounts']]
+            num_live = sum(state_counts[s] for s in live)
+            num_dying = sum(state_counts[s] for s in dying)
+            population_record[str(int(row['timeStep']))] = {
+                'stateCounts': state_counts,
+                'numActiveCubes': sum(state_counts),
+                'numLiveCubes': num_live,
+                'numDyingCubes': num_dying,
+                'numNonDeadCubes': num_live + num_dying,
+            }
+        result['populationRecord'] = population_record
+        return result
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print(f'Usage: {sys.argv[0]} <stats.gstats> <save.json>')
+        sys.exit(1)
+    with open(sys.argv[2], 'w') as f:
+        json.dump(StatsLog(sys.argv[1]).to_legacy_json(), f)
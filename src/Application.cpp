@@ -25,19 +25,57 @@ Application::Application() :
  * Draws all the components of the application.
  */
 void Application::draw() {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Rendering is suspended while the active Object fast-forwards. Show its
+    // progress instead.
+    Object *obj = world.activeObject;
+    if(obj->fastForwardLeft.load() > 0) {
+        drawFastForward(obj->fastForwardProgress());
+
+    } else {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    world.draw((float)t);
+        world.draw((float)t);
 
-    skybox.draw(getActiveCubes());
+        skybox.draw(getActiveCubes());
 
-    user.draw();
+        user.draw();
+
+        fastForwardPrinted = -1;
+    }
 
     glfwSwapBuffers(window);
 
     glfwPollEvents();
 }
 
+/**
+ * Application.drawFastForward()
+ * Draws a fast-forward progress bar along the bottom of the screen, and
+ * prints progress to the terminal every 10%.
+ * @param progress: Fraction of the fast-forward that's done.
+ */
+void Application::drawFastForward(float progress) {
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // The bar is just a scissored clear.
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, 0, (GLsizei)(progress * (float)width), height / 50 + 1);
+    glClearColor(1.f, 1.f, 1.f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_SCISSOR_TEST);
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+
+    int percent = 10 * (int)(10.f * progress);
+    if(percent != fastForwardPrinted) {
+        printf("Fast-forward: %i%% (press 4 to cancel)\n", percent);
+        fastForwardPrinted = percent;
+    }
+}
+
 /**
  * Application.freeGL()
  * Frees allocated OpenGL resources.
@@ -56,7 +94,13 @@ void Application::freeGL() {
 
 
 int Application::getActiveCubes() const {
-    return (int)world.activeObject->activeCubes.size();
+    Object *obj = world.activeObject;
+    // The simulation may be running on another thread, so go through its
+    // snapshots when it publishes them.
+    if(obj->publishSnapshots) {
+        return obj->latestSnapshot().numActiveCubes;
+    }
+    return (int)obj->activeCubes.size();
 }
 
 
@@ -327,20 +371,36 @@ void Application::perfInfo() {
     }
 
     if(printPerfInfo) {
-        int numActiveCubes = (int)world.activeObject->activeCubes.size();
+        int numActiveCubes = getActiveCubes();
         printf("%g ms/frame.\n %i active Cubes, %i Cubes drawn this frame.\n",
             frameRate, numActiveCubes, world.drawCount);
 
+        // Update cycle timing.
+        Object *obj = world.activeObject;
+        printf(" %g ms update budget. Last generation: %g ms of work, %g ms start to finish.\n",
+            obj->updateBudget, obj->generationWorkTime.load(), obj->generationLatency.load());
+
         printPerfInfo = false;
     }
 }
 
+/**
+ * Application.startSimulation()
+ * Moves the World's Object updates onto their own thread. Call once the
+ * World's Objects are set up.
+ */
+void Application::startSimulation() {
+    simulation.start(&world);
+}
+
 /**
  * Application.terminate()
  * Runs the application shutdown processes.
  */
 void Application::terminate() {
-    // Just frees OpenGL object memory for now.
+    // Stop the simulation thread before anything it uses goes away.
+    simulation.stop();
+
     freeGL();
 }
 
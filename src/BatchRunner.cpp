@@ -0,0 +1,1424 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "BatchRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <thread>
+
+#include "Checkpoint.h"
+#include "StatsLog.h"
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+namespace fs = std::filesystem;
+
+// Rules predicted to be worth running so far, by the prefilter: those
+// predicted at least the threshold and, with topK > 0, only the topK best of
+// them. Rules without a prediction are always kept.
+class CandidateFilter {
+public:
+    struct Candidate {
+        float value;
+        bool predicted;
+        size_t index;
+        Rule rule;
+    };
+
+    CandidateFilter(double threshold, int topK) : threshold(threshold), topK(topK) {}
+
+    /**
+     * CandidateFilter.push()
+     * Offers a rule to the filter.
+     * @param candidate: The rule's prediction and position in the list of
+     *                   rules, and the rule itself if it should be kept.
+     */
+    void push(Candidate &&candidate) {
+        if(!candidate.predicted) {
+            unpredicted.push_back(std::move(candidate));
+            return;
+        }
+        if(candidate.value < threshold) {
+            return;
+        }
+        if(topK > 0 && (int)best.size() == topK) {
+            if(!better(candidate, best.front())) {
+                return;
+            }
+            std::pop_heap(best.begin(), best.end(), better);
+            best.pop_back();
+        }
+        best.push_back(std::move(candidate));
+        if(topK > 0) {
+            std::push_heap(best.begin(), best.end(), better);
+        }
+    }
+
+    /**
+     * CandidateFilter.take()
+     * Returns the rules kept, in list order, and empties the filter.
+     */
+    std::vector<Candidate> take() {
+        std::vector<Candidate> kept = std::move(best);
+        kept.insert(kept.end(), std::make_move_iterator(unpredicted.begin()), std::make_move_iterator(unpredicted.end()));
+        best.clear();
+        unpredicted.clear();
+        std::sort(kept.begin(), kept.end(), [](const Candidate &a, const Candidate &b) {
+            return a.index < b.index;
+        });
+        return kept;
+    }
+
+private:
+    double threshold;
+    int topK;
+
+    // With topK > 0, a heap with the worst kept rule on top.
+    std::vector<Candidate> best;
+    std::vector<Candidate> unpredicted;
+
+    // Heap order, which puts the worst rule on top: a higher value is
+    // better, and of equal values the earlier rule.
+    static bool better(const Candidate &a, const Candidate &b) {
+        if(a.value != b.value) {
+            return a.value > b.value;
+        }
+        return a.index < b.index;
+    }
+};
+
+/**
+ * BatchRunner.addGeneratedRules()
+ * Generates random rules (like the interactive app's default rule) and adds
+ * the ones the prefilter keeps to the batch, saving them as rule files. Rules
+ * are generated and predicted in blocks, spread over the workers, so only the
+ * ones kept are held in memory. Each block has its own random generator,
+ * seeded from the batch's seed and the block's index, so the rules don't
+ * depend on the number of workers.
+ * @param numRules: Number of rules to generate.
+ * @param numStates: Number of states of each rule.
+ * @param dir: Directory the kept rules are saved to, as gen_<index>.json.
+ */
+void BatchRunner::addGeneratedRules(size_t numRules, int numStates, const std::string &dir) {
+    const int numDims = 3;
+    const size_t rulesPerBlock = 4096;
+
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+
+    long long seed = options.seed;
+    if(seed < 0) {
+        seed = std::chrono::system_clock::now().time_since_epoch().count() & 0xFFFFFFFF;
+    }
+
+    size_t numBlocks = (numRules + rulesPerBlock - 1) / rulesPerBlock;
+    std::atomic<size_t> nextBlock{0};
+    CandidateFilter filter(options.minPredictedValue, options.topK);
+    std::mutex filterMutex;
+    std::string error;
+
+    auto generate = [&]() {
+        CandidateFilter workerFilter(options.minPredictedValue, options.topK);
+        std::vector<Rule> block;
+        std::vector<float> values;
+        std::vector<bool> predicted;
+        size_t b;
+        try {
+            while((b = nextBlock.fetch_add(1)) < numBlocks) {
+                size_t first = b * rulesPerBlock;
+                size_t blockRules = std::min(rulesPerBlock, numRules - first);
+                std::seed_seq blockSeed = {(uint32_t)seed, (uint32_t)((unsigned long long)seed >> 32),
+                                           (uint32_t)b, (uint32_t)((unsigned long long)b >> 32)};
+                std::mt19937 rng(blockSeed);
+
+                block.clear();
+                for(size_t r = 0; r < blockRules; ++r) {
+                    block.push_back(generateRule(numDims, numStates, searchLiveRate, searchSparseRate, rng));
+                }
+                if(options.valueModel.loaded()) {
+                    options.valueModel.predict(block, values, predicted);
+                } else {
+                    values.assign(blockRules, 0.f);
+                    predicted.assign(blockRules, false);
+                }
+                for(size_t r = 0; r < blockRules; ++r) {
+                    workerFilter.push({values[r], predicted[r], first + r, std::move(block[r])});
+                }
+            }
+        } catch(const std::exception &e) {
+            std::lock_guard<std::mutex> lock(filterMutex);
+            error = e.what();
+            nextBlock = numBlocks;
+        }
+
+        std::lock_guard<std::mutex> lock(filterMutex);
+        for(auto &candidate : workerFilter.take()) {
+            filter.push(std::move(candidate));
+        }
+    };
+
+    int numWorkers = options.numWorkers;
+    if(numWorkers <= 0) {
+        numWorkers = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    numWorkers = (int)std::min((size_t)numWorkers, std::max(numBlocks, (size_t)1));
+    std::vector<std::thread> workers;
+    for(int i = 0; i < numWorkers; ++i) {
+        workers.emplace_back(generate);
+    }
+    for(auto &worker : workers) {
+        worker.join();
+    }
+    if(!error.empty()) {
+        throw std::runtime_error("Failed to generate rules: " + error);
+    }
+
+    std::vector<CandidateFilter::Candidate> kept = filter.take();
+    fs::create_directories(dir);
+    for(auto &candidate : kept) {
+        char name[32];
+        snprintf(name, sizeof(name), "gen_%08zu.json", candidate.index);
+        std::string path = (fs::path(dir) / name).string();
+
+        std::map<std::string, double> params = {{"seed", (double)seed}, {"index", (double)candidate.index}};
+        if(candidate.predicted) {
+            params["predictedValue"] = candidate.value;
+        }
+        saveRuleToJson(candidate.rule, path, params);
+        ruleFiles.push_back(path);
+    }
+
+    std::chrono::duration<double> elapsed = clock::now() - start;
+    printf("Generated %zu rules (seed %lld) in %.2f s, kept %zu.\n", numRules, seed, elapsed.count(), kept.size());
+}
+
+/**
+ * BatchRunner.addRules()
+ * Adds rule files to the batch.
+ * @param path: A rule file, or a directory whose .json files are all added
+ *              (in name order).
+ */
+void BatchRunner::addRules(const std::string &path) {
+    if(!fs::is_directory(path)) {
+        ruleFiles.push_back(path);
+        return;
+    }
+
+    std::vector<std::string> dirFiles;
+    for(auto &entry : fs::directory_iterator(path)) {
+        if(entry.is_regular_file() && entry.path().extension() == ".json") {
+            dirFiles.push_back(entry.path().string());
+        }
+    }
+    std::sort(dirFiles.begin(), dirFiles.end());
+    ruleFiles.insert(ruleFiles.end(), dirFiles.begin(), dirFiles.end());
+}
+
+/**
+ * cacheKey()
+ * Builds the results cache key of a run: the canonical rule along with every
+ * setting its statistics depend on.
+ * @param canonical: The run's rule, in canonical form.
+ * @param options: The batch's settings.
+ * @param stats: Statistics holding the run's limits and thresholds.
+ */
+static std::string cacheKey(const CanonicalRule &canonical, const BatchOptions &options, const RunStats &stats) {
+    // Floating point settings are written exactly, in hex.
+    auto exact = [](double x) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%a", x);
+        return std::string(buffer);
+    };
+
+    std::string key = "engine " + std::to_string(ResultsCache::engineVersion);
+    key += "; rule " + canonical.key;
+    key += "; seed " + std::to_string(options.seed) + " hwidth " + std::to_string(options.hwidth) + " probs";
+    for(float p : options.cubeCubeProbs) {
+        key += " " + exact(p);
+    }
+    key += "; maxSteps " + std::to_string(stats.maxTimeSteps) + " logEveryT " + std::to_string(stats.logEveryT);
+    key += " growth " + exact(stats.populationGrowthThreshold) + " decay " + exact(stats.populationDecayThreshold);
+    if(options.torusSize > 0) {
+        key += "; torus " + std::to_string(options.torusSize);
+    }
+    if(options.detectPopulationPeriod) {
+        const PeriodDetector &detector = options.periodDetector;
+        key += "; period " + std::to_string(detector.window) + " " + std::to_string(detector.maxPeriod)
+                + " " + exact(detector.threshold) + " " + std::to_string(detector.confirmations);
+    }
+    if(options.stopHopeless) {
+        const RuleValue &value = options.valueFunction;
+        key += "; hopeless " + exact(options.hopelessValue) + " " + std::to_string(options.hopelessCheckInterval)
+                + " " + exact(value.transientRatio) + " " + exact(value.earlyTerminationWeight)
+                + " " + exact(value.growthWeight) + " " + exact(value.periodicityWeight)
+                + " " + exact(value.complexityWeight) + " " + exact(value.idealGrowthExp);
+    }
+    return key;
+}
+
+/**
+ * lookupCached()
+ * Looks a run up in the results cache, if it's in use.
+ * @param rule: The run's rule.
+ * @param stats: Receives the run's statistics, relabelled to the rule's
+ *               states, on a hit.
+ * @param options: The batch's settings.
+ * @param canonical: Receives the canonical rule, if the cache is in use.
+ * @param key: Receives the run's cache key, or is left empty if the run can't
+ *             be cached.
+ * @param lookup: If false, just fill in canonical and key.
+ * @return true on a hit.
+ */
+static bool lookupCached(const Rule &rule, RunStats &stats, const BatchOptions &options,
+                         CanonicalRule &canonical, std::string &key, bool lookup = true) {
+    // Runs are only cached with a fixed seed, since a clock seed never
+    // repeats, and without damage spreading, which the cache doesn't keep.
+    if(!options.cache.enabled() || options.seed < 0 || options.measureDamage) {
+        return false;
+    }
+    canonical = canonicalizeRule(rule, (int)options.cubeCubeProbs.size());
+    key = cacheKey(canonical, options, stats);
+    if(!lookup || !options.cache.lookup(key, stats)) {
+        return false;
+    }
+
+    // Cached statistics use the canonical state labels.
+    std::vector<int> canonicalToRule(canonical.table.size(), -1);
+    for(size_t s = 0; s < canonical.stateMap.size(); ++s) {
+        if(canonical.stateMap[s] >= 0) {
+            canonicalToRule[canonical.stateMap[s]] = (int)s;
+        }
+    }
+    stats.relabelStates(canonicalToRule, (int)rule.table.size());
+    return true;
+}
+
+/**
+ * storeCached()
+ * Caches a finished run's statistics, unless it can't be cached or ended for
+ * reasons (timeouts and memory limits) that depend on the machine.
+ * @param key: The run's cache key, from lookupCached().
+ * @param canonical: The run's canonical rule, from lookupCached().
+ * @param stats: The run's statistics.
+ * @param options: The batch's settings.
+ * @param logFile: The run's binary log, if it kept its state counts there.
+ */
+static void storeCached(const std::string &key, const CanonicalRule &canonical, const RunStats &stats,
+                        const BatchOptions &options, const std::string &logFile) {
+    if(key.empty() || stats.endStatus == "timeout" || stats.endStatus == "memoryLimit") {
+        return;
+    }
+    RunStats canonicalStats;
+    if(logFile.empty()) {
+        canonicalStats.loadState(stats.saveState());
+    } else {
+        std::string ruleString;
+        std::set<int> liveStates;
+        StatsLog::read(logFile, canonicalStats, ruleString, liveStates);
+    }
+    canonicalStats.relabelStates(canonical.stateMap, (int)canonical.table.size());
+    options.cache.store(key, canonicalStats);
+}
+
+/**
+ * writeLog()
+ * Writes a finished run's statistics, e.g. from the results cache, to a binary
+ * StatsLog.
+ * @param stats: The run's statistics, with state counts.
+ * @param logFile: Path of the log.
+ * @param ruleString: String representation of the run's rule.
+ * @param rule: The run's rule.
+ * @param options: The batch's settings.
+ */
+static void writeLog(RunStats &stats, const std::string &logFile, const std::string &ruleString,
+                     const Rule &rule, const BatchOptions &options) {
+    stats.log.open(logFile, ruleString, rule.liveStates, (int)rule.table.size(),
+                   options.seed, stats.maxTimeSteps, stats.logEveryT);
+    for(size_t r = 0; r < stats.timeStepLog.size(); ++r) {
+        stats.log.append(stats.timeStepLog[r], stats.activeCubeLog[r], stats.cubeStateLog[r]);
+    }
+    stats.log.close(stats);
+}
+
+/**
+ * BatchRunner.finishEnsemble()
+ * Saves an ensemble's summary once all its runs are done or skipped, and
+ * reports it.
+ * @param ruleIndex: Index of the ensemble's rule file.
+ */
+void BatchRunner::finishEnsemble(size_t ruleIndex) {
+    Ensemble &ensemble = *ensembles[ruleIndex];
+    const std::string &ruleFile = ruleFiles[ruleIndex];
+    std::string saveFile = (fs::path(outDir) / fs::path(ruleFile).filename()).string();
+
+    std::sort(ensemble.runs.begin(), ensemble.runs.end(), [](const EnsembleRun &a, const EnsembleRun &b) {
+        return a.seed < b.seed;
+    });
+    if(!ensemble.skipped && ensemble.error.empty()) {
+        try {
+            saveEnsemble(ensemble.ruleString, ensemble.rule.liveStates, options.ensembleSize, ensemble.runs,
+                         !options.scoreOnly, saveFile);
+        } catch(const std::exception &e) {
+            ensemble.error = e.what();
+        }
+    }
+
+    bool failed = !ensemble.error.empty();
+    if(failed) {
+        numFailed++;
+    }
+    int done = ++numDone;
+
+    std::lock_guard<std::mutex> lock(printMutex);
+    if(failed) {
+        printf("%s: %s\n", ruleFile.c_str(), ensemble.error.c_str());
+    } else if(ensemble.skipped) {
+        printf("[%i/%zu] %s: already done\n", done, ruleFiles.size(), ruleFile.c_str());
+    } else {
+        std::map<std::string, int> statusCounts;
+        double valueSum = 0.;
+        for(auto &run : ensemble.runs) {
+            statusCounts[run.endStatus]++;
+            valueSum += run.value;
+        }
+        printf("[%i/%zu] %s: %zu runs,", done, ruleFiles.size(), ruleFile.c_str(), ensemble.runs.size());
+        for(auto &statusCount : statusCounts) {
+            printf(" %s %i,", statusCount.first.c_str(), statusCount.second);
+        }
+        printf(" mean value %.3f\n", valueSum / (double)ensemble.runs.size());
+    }
+
+    // The runs' logs aren't needed any more.
+    ensemble.runs.clear();
+    ensemble.runs.shrink_to_fit();
+}
+
+/**
+ * BatchRunner.hasResult()
+ * Checks whether a rule's results have already been saved, by an earlier run
+ * of the batch.
+ * @param saveFile: The rule's JSON results file.
+ * @param logFile: The rule's binary log, if statistics are saved that way.
+ */
+bool BatchRunner::hasResult(const std::string &saveFile, const std::string &logFile) const {
+    if(logFile.empty() || options.scoreOnly) {
+        return fs::exists(saveFile);
+    }
+    if(!fs::exists(logFile)) {
+        return false;
+    }
+
+    // The log is written as the run goes, so only a finished one counts.
+    RunStats stats;
+    std::string ruleString;
+    std::set<int> liveStates;
+    try {
+        StatsLog::read(logFile, stats, ruleString, liveStates);
+    } catch(const std::exception &e) {
+        return false;
+    }
+    return stats.endStatus != "running";
+}
+
+/**
+ * BatchRunner.prefilter()
+ * Drops the rule files the value model predicts aren't worth running, if
+ * it's loaded. Rule files that fail to load are kept, so the batch reports
+ * them.
+ */
+void BatchRunner::prefilter() {
+    if(!options.valueModel.loaded() || ruleFiles.empty()) {
+        return;
+    }
+
+    CandidateFilter filter(options.minPredictedValue, options.topK);
+    std::vector<Rule> rules(ruleFiles.size());
+    std::vector<bool> parsed(ruleFiles.size(), false);
+    for(size_t i = 0; i < ruleFiles.size(); ++i) {
+        try {
+            rules[i] = parseRuleFromJson(ruleFiles[i]);
+            parsed[i] = true;
+        } catch(const std::exception &e) {
+            // Kept, with no prediction.
+        }
+    }
+
+    std::vector<float> values;
+    std::vector<bool> predicted;
+    options.valueModel.predict(rules, values, predicted);
+    for(size_t i = 0; i < ruleFiles.size(); ++i) {
+        filter.push({values[i], parsed[i] && predicted[i], i, Rule()});
+    }
+
+    std::vector<std::string> kept;
+    for(auto &candidate : filter.take()) {
+        kept.push_back(ruleFiles[candidate.index]);
+    }
+    printf("Prefilter kept %zu of %zu rules.\n", kept.size(), ruleFiles.size());
+    ruleFiles = std::move(kept);
+}
+
+/**
+ * BatchRunner.run()
+ * Runs every rule file, blocking until they're all done.
+ */
+void BatchRunner::run() {
+    nextRule = 0;
+    numDone = 0;
+    numFailed = 0;
+
+    // With ensembles, each of a rule's runs is a separate task.
+    bool ensembleMode = options.ensembleSize > 1;
+    size_t numTasks = ruleFiles.size();
+    ensembles.clear();
+    if(ensembleMode) {
+        numTasks *= options.ensembleSize;
+        for(size_t i = 0; i < ruleFiles.size(); ++i) {
+            ensembles.push_back(std::make_unique<Ensemble>());
+        }
+    }
+
+    int numWorkers = options.numWorkers;
+    if(numWorkers <= 0) {
+        numWorkers = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    numWorkers = (int)std::min((size_t)numWorkers, numTasks);
+
+    // In lockstep mode, spread the rules over the workers rather than
+    // filling one torus first.
+    bool lockstepMode = !ensembleMode && options.torusSize > 0;
+    if(lockstepMode) {
+        size_t perWorker = (numTasks + numWorkers - 1) / std::max(numWorkers, 1);
+        lanesPerWorker = (int)std::clamp(perWorker, (size_t)1, (size_t)LockstepTorus::maxLanes);
+    }
+
+    void (BatchRunner::*body)() = &BatchRunner::work;
+    if(ensembleMode) {
+        body = &BatchRunner::workEnsemble;
+    } else if(lockstepMode) {
+        body = &BatchRunner::workLockstep;
+    }
+    std::vector<std::thread> workers;
+    for(int i = 0; i < numWorkers; ++i) {
+        workers.emplace_back(body, this);
+    }
+    for(auto &worker : workers) {
+        worker.join();
+    }
+    ensembles.clear();
+}
+
+/**
+ * startRun()
+ * Resets an automaton to a rule and the batch's initial cube of Cubes, and
+ * starts a run's statistics.
+ * @param gol: The automaton.
+ * @param rule: The rule to run.
+ * @param stats: The run's statistics.
+ * @param options: Initial conditions.
+ */
+static void startRun(GeneralizedCellularAutomaton &gol, const Rule &rule, RunStats &stats,
+                     const BatchOptions &options) {
+    gol.reset();
+    gol.setRule(rule.table, rule.liveStates);
+    gol.cubeCube(options.hwidth, options.cubeCubeProbs, glm::ivec3(0, 0, 0), options.seed);
+    stats.begin((int)gol.activeCubes.size());
+}
+
+/**
+ * perturbedCopy()
+ * The calling thread's automaton for perturbed copies of runs, made the first
+ * time it's needed and reused across its runs like the workers' own.
+ * @param options: The batch's settings.
+ */
+static GeneralizedCellularAutomaton &perturbedCopy(const BatchOptions &options) {
+    static thread_local std::unique_ptr<GeneralizedCellularAutomaton> gol;
+    if(!gol) {
+        gol = std::make_unique<GeneralizedCellularAutomaton>();
+        gol->init(glm::vec3(0, 0, 0), 0.5, options.initNumCubes);
+        gol->publishSnapshots = false;
+    }
+    return *gol;
+}
+
+/**
+ * stepRun()
+ * Runs one time step of a run, recording its statistics if due, and checks
+ * whether it's over: because the statistics say so, it hit the time or
+ * memory limit, or (if enabled) its score so far is hopeless.
+ * @param gol: The automaton.
+ * @param stats: The run's statistics.
+ * @param options: The run's limits.
+ * @param timeStep: The time step being run.
+ * @param start: When the run started, for the time limit.
+ * @param perturbed: If not null, the run's perturbed copy, stepped alongside
+ *                   it, with the damage recorded after every generation.
+ * @return true if the run is over.
+ */
+static bool stepRun(GeneralizedCellularAutomaton &gol, RunStats &stats, const BatchOptions &options,
+                    int timeStep, std::chrono::steady_clock::time_point start,
+                    GeneralizedCellularAutomaton *perturbed = nullptr) {
+    gol.update();
+    if(perturbed != nullptr) {
+        perturbed->update();
+        if(gol.cycleStage == 0) {
+            stats.damage.record(gol, *perturbed);
+        }
+    }
+
+    if(stats.shouldRecord(timeStep)) {
+        bool done = stats.record(timeStep, gol.stateCounts, (int)gol.activeCubes.size(), gol.configHash);
+
+        int numRecords = (int)stats.activeCubeLog.size();
+        if(!done && options.stopHopeless && numRecords % options.hopelessCheckInterval == 0) {
+            RuleScore partial = options.valueFunction.evaluate(
+                    stats.activeCubeLog, timeStep, stats.maxTimeSteps, "continue");
+            if(partial.hasLosses && partial.value < options.hopelessValue) {
+                stats.endStatus = "hopeless";
+                done = true;
+            }
+        }
+        if(done) {
+            return true;
+        }
+    }
+
+    if(options.timeLimit > 0.) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if(elapsed.count() > options.timeLimit) {
+            stats.endStatus = "timeout";
+            return true;
+        }
+    }
+    size_t memoryUsage = gol.memoryUsage() + (perturbed != nullptr ? perturbed->memoryUsage() : 0);
+    if(options.memoryLimit > 0 && memoryUsage > options.memoryLimit) {
+        stats.endStatus = "memoryLimit";
+        return true;
+    }
+    return false;
+}
+
+/**
+ * BatchRunner.runRule()
+ * Runs a rule from a fresh cube of Cubes until its statistics say to stop,
+ * it hits the time or memory limit, or (if enabled) its score so far is
+ * hopeless. The statistics are recorded at the same time steps (one per
+ * stage of the update cycle) as in the GUI executable's headless mode.
+ * @param gol: The automaton to run the rule on. Reset first.
+ * @param rule: The rule to run.
+ * @param stats: Receives the run's statistics.
+ * @param options: Initial conditions and limits.
+ * @param logFile: If not empty, the statistics are also appended to a binary
+ *                 StatsLog at this path as they're recorded.
+ * @param checkpointFile: If not empty, and checkpoints are enabled, where
+ *                        the run's Checkpoints go. If options.resume is set
+ *                        and one exists, the run resumes from it.
+ *
+ * With options.measureDamage set (and no checkpoints), a perturbed copy of
+ * the run is stepped alongside it, and stats.damage measures how the
+ * perturbation spreads.
+ */
+void BatchRunner::runRule(
+        GeneralizedCellularAutomaton &gol,
+        const Rule &rule,
+        RunStats &stats,
+        const BatchOptions &options,
+        const std::string &logFile,
+        const std::string &checkpointFile) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+
+    bool checkpoints = options.checkpointEvery > 0 && !checkpointFile.empty();
+    bool resumed = checkpoints && options.resume && fs::exists(checkpointFile);
+
+    stats.detectPopulationPeriod = options.detectPopulationPeriod;
+    stats.periodDetector = options.periodDetector;
+    stats.keepStateLog = logFile.empty();
+
+    int firstTimeStep = 1;
+    if(resumed) {
+        std::vector<char> savedStats;
+        Checkpoint::load(gol, checkpointFile, &savedStats);
+        if(gol.ruleMatrixExt != rule.table || gol.liveStates != rule.liveStates) {
+            throw std::runtime_error("Checkpoint is for a different rule: " + checkpointFile);
+        }
+        stats.loadState(savedStats);
+        if(!logFile.empty()) {
+            stats.log.resume(logFile, stats.activeCubeLog.size());
+        }
+        firstTimeStep = gol.generation * GeneralizedCellularAutomaton::stagesPerGeneration + 1;
+
+    } else {
+        startRun(gol, rule, stats, options);
+        if(!logFile.empty()) {
+            stats.log.open(logFile, gol.ruleString, gol.liveStates, gol.numStates,
+                           options.seed, stats.maxTimeSteps, stats.logEveryT);
+        }
+    }
+
+    // Nothing draws, so skip building render snapshots.
+    gol.publishSnapshots = false;
+    gol.active = true;
+    gol.state = ObjectState::run;
+
+    GeneralizedCellularAutomaton *perturbed = nullptr;
+    if(options.measureDamage && !checkpoints) {
+        perturbed = &perturbedCopy(options);
+        stats.damage.begin(gol, *perturbed, options.damageSite);
+        perturbed->active = true;
+        perturbed->state = ObjectState::run;
+    }
+
+    bool done = false;
+    for(int timeStep = firstTimeStep; !done; ++timeStep) {
+        done = stepRun(gol, stats, options, timeStep, start, perturbed);
+
+        // Checkpoint between generations. The log is flushed first, so it
+        // holds at least the checkpoint's records.
+        if(!done && checkpoints && gol.cycleStage == 0 && gol.generation % options.checkpointEvery == 0) {
+            stats.log.flush();
+            Checkpoint::save(gol, checkpointFile, stats.saveState());
+        }
+    }
+
+    gol.state = ObjectState::stop;
+    if(perturbed != nullptr) {
+        perturbed->state = ObjectState::stop;
+    }
+    stats.log.close(stats);
+    if(checkpoints) {
+        fs::remove(checkpointFile);
+    }
+}
+
+/**
+ * BatchRunner.runRuleSlice()
+ * Runs part of a rule's run, from a fresh cube of Cubes or from where an
+ * earlier slice stopped, until the run is over (as in runRule()) or reaches a
+ * time step. Slices stop between generations, and keep the state to continue
+ * from in memory, as a Checkpoint with the statistics so far.
+ * @param gol: The automaton to run the rule on. Reset first.
+ * @param rule: The rule to run.
+ * @param stats: Receives the run's statistics.
+ * @param options: Initial conditions and limits.
+ * @param untilTimeStep: The slice ends at the first generation boundary at or
+ *                       after this time step.
+ * @param checkpoint: State left by the previous slice, empty for the first.
+ *                    Receives the state to continue from, or is cleared if
+ *                    the run is over.
+ * @param elapsed: Wall-clock seconds the run has taken so far, which count
+ *                 towards the time limit. Updated.
+ * @return true if the run is over.
+ */
+bool BatchRunner::runRuleSlice(
+        GeneralizedCellularAutomaton &gol,
+        const Rule &rule,
+        RunStats &stats,
+        const BatchOptions &options,
+        int untilTimeStep,
+        std::vector<char> &checkpoint,
+        double &elapsed) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now() - std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(elapsed));
+
+    stats.detectPopulationPeriod = options.detectPopulationPeriod;
+    stats.periodDetector = options.periodDetector;
+    stats.keepStateLog = true;
+
+    int timeStep = 1;
+    if(!checkpoint.empty()) {
+        std::vector<char> savedStats;
+        Checkpoint::decode(gol, checkpoint.data(), checkpoint.size(), &savedStats);
+        stats.loadState(savedStats);
+        timeStep = gol.generation * GeneralizedCellularAutomaton::stagesPerGeneration + 1;
+    } else {
+        startRun(gol, rule, stats, options);
+    }
+
+    gol.publishSnapshots = false;
+    gol.active = true;
+    gol.state = ObjectState::run;
+
+    bool done = false;
+    while(!done) {
+        done = stepRun(gol, stats, options, timeStep, start);
+        if(!done && gol.cycleStage == 0 && timeStep >= untilTimeStep) {
+            break;
+        }
+        ++timeStep;
+    }
+
+    gol.state = ObjectState::stop;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    if(done) {
+        checkpoint.clear();
+    } else {
+        checkpoint = Checkpoint::encode(gol, stats.saveState());
+    }
+    return done;
+}
+
+/**
+ * BatchRunner.runRuleRecorded()
+ * Runs a rule in full, as in runRule(), while recording the run for reuse:
+ * which rule table entries it uses, and in-memory Checkpoints. Given the
+ * recording of a run of a similar rule (a parent), the run starts from the
+ * parent's last Checkpoint before the first generation in which the rules
+ * act differently, or if they never do, reuses the parent's statistics
+ * without simulating at all.
+ * @param gol: The automaton to run the rule on. Reset first.
+ * @param rule: The rule to run.
+ * @param stats: Receives the run's statistics.
+ * @param options: Initial conditions and limits.
+ * @param record: Receives the recording of the run. Its checkpointEvery sets
+ *                how often Checkpoints are kept, unless it's taken from the
+ *                parent.
+ * @param parent: Recording of a run of a similar rule, or null.
+ * @return The generation the rule was simulated from, or -1 if the parent's
+ *         run was reused whole (in which case gol isn't run).
+ */
+int BatchRunner::runRuleRecorded(
+        GeneralizedCellularAutomaton &gol,
+        const Rule &rule,
+        RunStats &stats,
+        const BatchOptions &options,
+        RecordedRun &record,
+        const RecordedRun *parent) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+
+    stats.detectPopulationPeriod = options.detectPopulationPeriod;
+    stats.periodDetector = options.periodDetector;
+    stats.keepStateLog = true;
+
+    int divergence = parent ? parent->divergence(rule) : 0;
+    if(parent && divergence < 0 && parent->reusable()) {
+        if(&record != parent) {
+            record = *parent;
+        }
+        record.rule = rule;
+        stats.loadState(parent->finalStats);
+        gol.setRule(rule.table, rule.liveStates);
+        return -1;
+    }
+
+    int startGeneration = 0;
+    if(parent && !parent->checkpoints.empty()) {
+        // The last Checkpoint from before the divergence, or the last one if
+        // the rules never diverge but the parent's run was cut short.
+        size_t i = parent->checkpoints.size() - 1;
+        if(divergence >= 0) {
+            i = std::min(i, (size_t)(divergence / parent->checkpointEvery));
+        }
+        std::vector<char> savedStats;
+        Checkpoint::decode(gol, parent->checkpoints[i].data(), parent->checkpoints[i].size(), &savedStats);
+        stats.loadState(savedStats);
+
+        // Swap in the rule, keeping the state counts setRule() clears.
+        std::vector<int> stateCounts = gol.stateCounts;
+        gol.setRule(rule.table, rule.liveStates);
+        gol.stateCounts = stateCounts;
+        startGeneration = gol.generation;
+
+        // Up to here the runs match, so the parent's history is this run's.
+        std::vector<std::vector<int>> firstUse = parent->firstUse;
+        for(auto &row : firstUse) {
+            for(int &used : row) {
+                if(used >= startGeneration) {
+                    used = -1;
+                }
+            }
+        }
+        std::vector<std::vector<char>> checkpoints(parent->checkpoints.begin(),
+                                                   parent->checkpoints.begin() + (long)i + 1);
+        record.checkpointEvery = parent->checkpointEvery;
+        record.checkpoints = std::move(checkpoints);
+        gol.ruleFirstUse = std::move(firstUse);
+
+    } else {
+        startRun(gol, rule, stats, options);
+        record.checkpoints.clear();
+        record.checkpoints.push_back(Checkpoint::encode(gol, stats.saveState()));
+    }
+    record.checkpointEvery = std::max(record.checkpointEvery, 1);
+    record.rule = rule;
+
+    gol.publishSnapshots = false;
+    gol.trackRuleUse = true;
+    gol.active = true;
+    gol.state = ObjectState::run;
+
+    bool done = false;
+    for(int timeStep = startGeneration * GeneralizedCellularAutomaton::stagesPerGeneration + 1; !done; ++timeStep) {
+        done = stepRun(gol, stats, options, timeStep, start);
+        if(!done && gol.cycleStage == 0 && gol.generation % record.checkpointEvery == 0) {
+            record.checkpoints.push_back(Checkpoint::encode(gol, stats.saveState()));
+        }
+    }
+
+    gol.state = ObjectState::stop;
+    gol.trackRuleUse = false;
+    record.firstUse = gol.ruleFirstUse;
+    record.finalStats = stats.saveState();
+    record.endStatus = stats.endStatus;
+    return startGeneration;
+}
+
+/**
+ * BatchRunner.runRuleCached()
+ * Like runRule(), but takes the statistics from the results cache if an
+ * equivalent run is there, and caches them otherwise.
+ * @param gol: The automaton to run the rule on.
+ * @param rule: The rule to run.
+ * @param stats: Receives the run's statistics.
+ * @param options: Initial conditions, limits and the cache.
+ * @param logFile: See runRule().
+ * @param checkpointFile: See runRule().
+ * @return true if the statistics came from the cache.
+ */
+bool BatchRunner::runRuleCached(
+        GeneralizedCellularAutomaton &gol,
+        const Rule &rule,
+        RunStats &stats,
+        const BatchOptions &options,
+        const std::string &logFile,
+        const std::string &checkpointFile) {
+    bool resuming = options.resume && options.checkpointEvery > 0 && fs::exists(checkpointFile);
+    CanonicalRule canonical;
+    std::string key;
+    bool cached = lookupCached(rule, stats, options, canonical, key, !resuming);
+
+    if(cached) {
+        gol.setRule(rule.table, rule.liveStates);
+        if(!logFile.empty()) {
+            writeLog(stats, logFile, gol.ruleString, rule, options);
+        }
+    } else {
+        runRule(gol, rule, stats, options, logFile, checkpointFile);
+        storeCached(key, canonical, stats, options, logFile);
+    }
+    return cached;
+}
+
+/**
+ * BatchRunner.saveEnsemble()
+ * Writes a summary of an ensemble's runs to a JSON file: each run's seed,
+ * end status and value, the fraction of runs ending with each status, the
+ * values' mean and standard deviation, and optionally the mean and variance
+ * of the number of active Cubes at each recorded time step (over the runs
+ * still going at that step).
+ * @param ruleString: String representation of the rule that was run.
+ * @param liveStates: The rule's live states.
+ * @param ensembleSize: Number of runs the ensemble was set to have.
+ * @param runs: The runs that were made.
+ * @param includePopulation: If true, include the population statistics.
+ * @param saveFile: Path of the file to write.
+ */
+void BatchRunner::saveEnsemble(
+        const std::string &ruleString,
+        const std::set<int> &liveStates,
+        int ensembleSize,
+        const std::vector<EnsembleRun> &runs,
+        bool includePopulation,
+        const std::string &saveFile) {
+    json outputJson;
+    outputJson["ruleString"] = ruleString;
+    outputJson["liveStates"] = liveStates;
+    outputJson["ensembleSize"] = ensembleSize;
+    outputJson["numRuns"] = runs.size();
+
+    outputJson["runs"] = json::array();
+    std::map<std::string, int> statusCounts;
+    double valueSum = 0.;
+    double valueSumSquares = 0.;
+    size_t numRecords = 0;
+    for(auto &run : runs) {
+        json runJson;
+        runJson["seed"] = run.seed;
+        runJson["endStatus"] = run.endStatus;
+        if(run.endStatus == "periodic") {
+            runJson["period"] = run.period;
+            runJson["periodExact"] = run.periodExact;
+        }
+        runJson["value"] = run.value;
+        if(run.cached) {
+            runJson["cached"] = true;
+        }
+        outputJson["runs"].push_back(runJson);
+
+        statusCounts[run.endStatus]++;
+        valueSum += run.value;
+        valueSumSquares += run.value * run.value;
+        numRecords = std::max(numRecords, run.activeCubeLog.size());
+    }
+
+    double n = std::max((double)runs.size(), 1.);
+    outputJson["endStatusFractions"] = json::object();
+    for(auto &statusCount : statusCounts) {
+        outputJson["endStatusFractions"][statusCount.first] = statusCount.second / n;
+    }
+    double valueMean = valueSum / n;
+    outputJson["value"]["mean"] = valueMean;
+    outputJson["value"]["std"] = std::sqrt(std::max(valueSumSquares / n - valueMean * valueMean, 0.));
+
+    if(includePopulation) {
+        outputJson["populationRecord"] = json::object();
+        for(size_t r = 0; r < numRecords; ++r) {
+            int timeStep = 0;
+            int numRuns = 0;
+            double sum = 0.;
+            double sumSquares = 0.;
+            for(auto &run : runs) {
+                if(r < run.activeCubeLog.size()) {
+                    timeStep = run.timeStepLog[r];
+                    numRuns++;
+                    sum += run.activeCubeLog[r];
+                    sumSquares += (double)run.activeCubeLog[r] * run.activeCubeLog[r];
+                }
+            }
+            double mean = sum / numRuns;
+
+            json timeStepEntry;
+            timeStepEntry["numActiveCubesMean"] = mean;
+            timeStepEntry["numActiveCubesVariance"] = std::max(sumSquares / numRuns - mean * mean, 0.);
+            timeStepEntry["numRuns"] = numRuns;
+            outputJson["populationRecord"][std::to_string(timeStep)] = timeStepEntry;
+        }
+    }
+
+    fs::path filePath(saveFile);
+    if(filePath.has_parent_path()) {
+        fs::create_directories(filePath.parent_path());
+    }
+
+    std::ofstream outFile(saveFile);
+    if(!outFile.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + saveFile);
+    }
+    outFile << outputJson.dump(2);
+}
+
+/**
+ * BatchRunner.saveScore()
+ * Writes a run's score breakdown to a JSON file, with the same keys as
+ * compute_rule_value.py's breakdown.
+ * @param ruleString: String representation of the rule that was run.
+ * @param stats: The run's statistics.
+ * @param score: The run's score.
+ * @param saveFile: Path of the file to write.
+ */
+void BatchRunner::saveScore(
+        const std::string &ruleString,
+        const RunStats &stats,
+        const RuleScore &score,
+        const std::string &saveFile) {
+    json outputJson;
+    outputJson["ruleString"] = ruleString;
+    outputJson["endStatus"] = stats.endStatus;
+    if(stats.endStatus == "periodic") {
+        outputJson["period"] = stats.period;
+        outputJson["periodOnset"] = stats.periodOnset;
+        outputJson["periodExact"] = stats.periodExact;
+    }
+    if(!score.reason.empty()) {
+        outputJson["reason"] = score.reason;
+    }
+    if(score.hasLosses) {
+        outputJson["early_termination_loss"] = score.earlyTerminationLoss;
+        outputJson["growth_loss"] = score.growthLoss;
+        outputJson["periodicity_loss"] = score.periodicityLoss;
+        outputJson["complexity_loss"] = score.complexityLoss;
+        outputJson["total_loss"] = score.totalLoss;
+    }
+    outputJson["value"] = score.value;
+    if(!stats.damage.empty()) {
+        outputJson["damage_hamming"] = stats.damage.hammingLog.back();
+        outputJson["damage_max_radius"] = stats.damage.maxRadius();
+        outputJson["damage_spread_rate"] = stats.damage.spreadRate();
+        outputJson["damage_lyapunov"] = stats.damage.lyapunovExponent();
+    }
+
+    fs::path filePath(saveFile);
+    if(filePath.has_parent_path()) {
+        fs::create_directories(filePath.parent_path());
+    }
+
+    std::ofstream outFile(saveFile);
+    if(!outFile.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + saveFile);
+    }
+    outFile << outputJson.dump(2);
+}
+
+/**
+ * BatchRunner.work()
+ * Worker thread body. Takes rule files off the list until there are none
+ * left.
+ */
+void BatchRunner::work() {
+    GeneralizedCellularAutomaton gol;
+    gol.init(glm::vec3(0, 0, 0), 0.5, options.initNumCubes);
+    RunStats stats;
+
+    size_t i;
+    while((i = nextRule.fetch_add(1)) < ruleFiles.size()) {
+        const std::string &ruleFile = ruleFiles[i];
+        fs::path savePath = fs::path(outDir) / fs::path(ruleFile).filename();
+        std::string saveFile = savePath.string();
+        std::string logFile;
+        if(options.binaryStats) {
+            logFile = fs::path(savePath).replace_extension(".gstats").string();
+        }
+        std::string checkpointFile = fs::path(savePath).replace_extension(".gckpt").string();
+
+        bool failed = false;
+        bool cached = false;
+        RuleScore score;
+        try {
+            if(options.resume && !fs::exists(checkpointFile) && hasResult(saveFile, logFile)) {
+                int done = ++numDone;
+                std::lock_guard<std::mutex> lock(printMutex);
+                printf("[%i/%zu] %s: already done\n", done, ruleFiles.size(), ruleFile.c_str());
+                continue;
+            }
+
+            const Rule rule = parseRuleFromJson(ruleFile);
+            cached = runRuleCached(gol, rule, stats, options, logFile, checkpointFile);
+            score = options.valueFunction.evaluate(stats);
+            if(options.scoreOnly) {
+                saveScore(gol.ruleString, stats, score, saveFile);
+            } else if(!options.binaryStats) {
+                stats.save(gol.ruleString, gol.liveStates, saveFile);
+            }
+
+        } catch(const std::exception &e) {
+            std::lock_guard<std::mutex> lock(printMutex);
+            printf("%s: %s\n", ruleFile.c_str(), e.what());
+            failed = true;
+        }
+
+        if(failed) {
+            numFailed++;
+        }
+        int done = ++numDone;
+
+        std::lock_guard<std::mutex> lock(printMutex);
+        if(!failed) {
+            printf("[%i/%zu] %s: %s, value %.3f%s\n", done, ruleFiles.size(), ruleFile.c_str(),
+                   stats.endStatus.c_str(), score.value, cached ? " (cached)" : "");
+        }
+    }
+}
+
+/**
+ * BatchRunner.workEnsemble()
+ * Worker thread body in ensemble mode. Takes runs (a rule file and a seed)
+ * off the list until there are none left. Whichever worker finishes a rule's
+ * last run saves the rule's summary.
+ */
+void BatchRunner::workEnsemble() {
+    GeneralizedCellularAutomaton gol;
+    gol.init(glm::vec3(0, 0, 0), 0.5, options.initNumCubes);
+    RunStats stats;
+
+    const size_t ensembleSize = options.ensembleSize;
+    size_t task;
+    while((task = nextRule.fetch_add(1)) < ruleFiles.size() * ensembleSize) {
+        size_t ruleIndex = task / ensembleSize;
+        int member = (int)(task % ensembleSize);
+        const std::string &ruleFile = ruleFiles[ruleIndex];
+        Ensemble &ensemble = *ensembles[ruleIndex];
+
+        // The first of a rule's runs to start loads it, once for them all.
+        bool skip;
+        {
+            std::lock_guard<std::mutex> lock(ensemble.mutex);
+            if(!ensemble.loaded) {
+                ensemble.loaded = true;
+                try {
+                    std::string saveFile = (fs::path(outDir) / fs::path(ruleFile).filename()).string();
+                    if(options.resume && hasResult(saveFile, "")) {
+                        ensemble.skipped = true;
+                    } else {
+                        ensemble.rule = parseRuleFromJson(ruleFile);
+                    }
+                } catch(const std::exception &e) {
+                    ensemble.error = e.what();
+                }
+            }
+            skip = ensemble.skipped || ensemble.stopped || !ensemble.error.empty();
+        }
+
+        if(!skip) {
+            BatchOptions runOptions = options;
+            runOptions.seed = (options.seed >= 0) ? options.seed + member : -1;
+            runOptions.binaryStats = false;
+            runOptions.checkpointEvery = 0;
+
+            EnsembleRun run;
+            std::string error;
+            try {
+                run.cached = runRuleCached(gol, ensemble.rule, stats, runOptions);
+                run.seed = (runOptions.seed >= 0) ? runOptions.seed : gol.seed;
+                run.endStatus = stats.endStatus;
+                run.period = stats.period;
+                run.periodExact = stats.periodExact;
+                run.value = options.valueFunction.evaluate(stats).value;
+                run.activeCubeLog = stats.activeCubeLog;
+                run.timeStepLog = stats.timeStepLog;
+            } catch(const std::exception &e) {
+                error = e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(ensemble.mutex);
+            if(!error.empty()) {
+                ensemble.error = error;
+            } else {
+                ensemble.ruleString = gol.ruleString;
+                ensemble.runs.push_back(std::move(run));
+
+                // Stop once enough runs agree, and none disagree.
+                int quorum = options.unanimousAfter;
+                if(quorum > 0 && (int)ensemble.runs.size() >= quorum) {
+                    ensemble.stopped = std::all_of(ensemble.runs.begin(), ensemble.runs.end(), [&](const EnsembleRun &r) {
+                        return r.endStatus == ensemble.runs.front().endStatus;
+                    });
+                }
+            }
+        }
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(ensemble.mutex);
+            last = (++ensemble.numTasksDone == (int)ensembleSize);
+        }
+        if(last) {
+            finishEnsemble(ruleIndex);
+        }
+    }
+}
+
+/**
+ * BatchRunner.workLockstep()
+ * Worker thread body in lockstep mode. Runs up to lanesPerWorker rules at once
+ * on a LockstepTorus, one per lane, taking the next rule file off the list
+ * whenever a lane's run ends, until there are none left. Statistics are
+ * recorded at the same time steps as by runRule().
+ */
+void BatchRunner::workLockstep() {
+    using clock = std::chrono::steady_clock;
+
+    LockstepTorus torus;
+    try {
+        torus.init(options.torusSize);
+    } catch(const std::exception &e) {
+        std::lock_guard<std::mutex> lock(printMutex);
+        printf("%s\n", e.what());
+        size_t i;
+        while((i = nextRule.fetch_add(1)) < ruleFiles.size()) {
+            numFailed++;
+            numDone++;
+        }
+        return;
+    }
+
+    struct Lane {
+        bool busy = false;
+
+        // Set once the lane's configuration has changed since its last
+        // record.
+        bool due = false;
+
+        size_t ruleIndex = 0;
+        Rule rule;
+        std::string ruleString;
+        std::string saveFile;
+        std::string logFile;
+        CanonicalRule canonical;
+        std::string key;
+        RunStats stats;
+        int timeStep = 1;
+        clock::time_point start;
+    };
+    std::vector<Lane> lanes(lanesPerWorker);
+
+    // Scores and saves a rule's results, and reports them.
+    auto finish = [&](Lane &lane, bool cached) {
+        const std::string &ruleFile = ruleFiles[lane.ruleIndex];
+        RuleScore score;
+        bool failed = false;
+        try {
+            lane.stats.log.close(lane.stats);
+            if(!cached) {
+                storeCached(lane.key, lane.canonical, lane.stats, options, lane.logFile);
+            }
+            score = options.valueFunction.evaluate(lane.stats);
+            if(options.scoreOnly) {
+                saveScore(lane.ruleString, lane.stats, score, lane.saveFile);
+            } else if(!options.binaryStats) {
+                lane.stats.save(lane.ruleString, lane.rule.liveStates, lane.saveFile);
+            }
+        } catch(const std::exception &e) {
+            std::lock_guard<std::mutex> lock(printMutex);
+            printf("%s: %s\n", ruleFile.c_str(), e.what());
+            failed = true;
+        }
+
+        if(failed) {
+            numFailed++;
+        }
+        int done = ++numDone;
+
+        std::lock_guard<std::mutex> lock(printMutex);
+        if(!failed) {
+            printf("[%i/%zu] %s: %s, value %.3f%s\n", done, ruleFiles.size(), ruleFile.c_str(),
+                   lane.stats.endStatus.c_str(), score.value, cached ? " (cached)" : "");
+        }
+    };
+
+    // Starts the next rule that needs running on a lane. Returns false once
+    // there are none left.
+    auto start = [&](int l) {
+        Lane &lane = lanes[l];
+        size_t i;
+        while((i = nextRule.fetch_add(1)) < ruleFiles.size()) {
+            const std::string &ruleFile = ruleFiles[i];
+            fs::path savePath = fs::path(outDir) / fs::path(ruleFile).filename();
+            lane.ruleIndex = i;
+            lane.saveFile = savePath.string();
+            lane.logFile = options.binaryStats ? fs::path(savePath).replace_extension(".gstats").string() : "";
+            lane.key.clear();
+
+            try {
+                if(options.resume && hasResult(lane.saveFile, lane.logFile)) {
+                    int done = ++numDone;
+                    std::lock_guard<std::mutex> lock(printMutex);
+                    printf("[%i/%zu] %s: already done\n", done, ruleFiles.size(), ruleFile.c_str());
+                    continue;
+                }
+
+                lane.rule = parseRuleFromJson(ruleFile);
+                lane.ruleString = GeneralizedCellularAutomaton::formatRule(lane.rule.table);
+                if(lookupCached(lane.rule, lane.stats, options, lane.canonical, lane.key)) {
+                    if(!lane.logFile.empty()) {
+                        writeLog(lane.stats, lane.logFile, lane.ruleString, lane.rule, options);
+                    }
+                    finish(lane, true);
+                    continue;
+                }
+
+                torus.setRule(l, lane.rule);
+                torus.cubeCube(l, options.hwidth, options.cubeCubeProbs, options.seed);
+
+                RunStats &stats = lane.stats;
+                stats.detectPopulationPeriod = options.detectPopulationPeriod;
+                stats.periodDetector = options.periodDetector;
+                stats.keepStateLog = lane.logFile.empty();
+                int numSeeded = 0;
+                for(int count : torus.stateCounts[l]) {
+                    numSeeded += count;
+                }
+                stats.begin(numSeeded);
+                if(!lane.logFile.empty()) {
+                    stats.log.open(lane.logFile, lane.ruleString, lane.rule.liveStates, torus.numStates[l],
+                                   options.seed, stats.maxTimeSteps, stats.logEveryT);
+                }
+
+            } catch(const std::exception &e) {
+                torus.clearLane(l);
+                numFailed++;
+                ++numDone;
+                std::lock_guard<std::mutex> lock(printMutex);
+                printf("%s: %s\n", ruleFile.c_str(), e.what());
+                continue;
+            }
+
+            lane.busy = true;
+            lane.due = true;
+            lane.timeStep = 1;
+            lane.start = clock::now();
+            return true;
+        }
+        return false;
+    };
+
+    bool rulesLeft = true;
+    while(true) {
+        for(int l = 0; l < lanesPerWorker && rulesLeft; ++l) {
+            if(!lanes[l].busy) {
+                rulesLeft = start(l);
+            }
+        }
+
+        // Record every lane whose configuration changed, and retire the
+        // lanes whose runs are over.
+        bool anyBusy = false;
+        bool anyFinished = false;
+        for(int l = 0; l < lanesPerWorker; ++l) {
+            Lane &lane = lanes[l];
+            if(!lane.busy || !lane.due) {
+                anyBusy = anyBusy || lane.busy;
+                continue;
+            }
+            lane.due = false;
+
+            RunStats &stats = lane.stats;
+            bool done = false;
+            if(stats.shouldRecord(lane.timeStep)) {
+                done = stats.record(lane.timeStep, torus.stateCounts[l], torus.numActiveCells[l], torus.configHash[l]);
+
+                int numRecords = (int)stats.activeCubeLog.size();
+                if(!done && options.stopHopeless && numRecords % options.hopelessCheckInterval == 0) {
+                    RuleScore partial = options.valueFunction.evaluate(
+                            stats.activeCubeLog, lane.timeStep, stats.maxTimeSteps, "continue");
+                    if(partial.hasLosses && partial.value < options.hopelessValue) {
+                        stats.endStatus = "hopeless";
+                        done = true;
+                    }
+                }
+            }
+
+            if(!done && options.timeLimit > 0.) {
+                std::chrono::duration<double> elapsed = clock::now() - lane.start;
+                if(elapsed.count() > options.timeLimit) {
+                    stats.endStatus = "timeout";
+                    done = true;
+                }
+            }
+
+            if(done) {
+                finish(lane, false);
+                torus.clearLane(l);
+                lane.busy = false;
+                anyFinished = true;
+            } else {
+                anyBusy = true;
+            }
+        }
+
+        // Fill freed lanes before stepping, so they don't sit idle for a
+        // generation.
+        if(anyFinished && rulesLeft) {
+            continue;
+        }
+        if(!anyBusy) {
+            break;
+        }
+
+        torus.step();
+        for(auto &lane : lanes) {
+            if(lane.busy) {
+                lane.timeStep += GeneralizedCellularAutomaton::stagesPerGeneration;
+                lane.due = true;
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "BloomFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * BloomFilter()
+ * Sizes the filter for a number of items and false positive rate.
+ * @constructor
+ * @param expectedItems: Number of items the filter should hold.
+ * @param falsePositiveRate: Chance that contains() is true for an item that
+ *                           was never inserted, once expectedItems have been.
+ */
+BloomFilter::BloomFilter(size_t expectedItems, double falsePositiveRate) {
+    // The optimal sizes: m = -n ln(p) / ln(2)^2 bits and k = (m / n) ln(2)
+    // hashes.
+    double n = (double)std::max(expectedItems, (size_t)1);
+    double p = std::clamp(falsePositiveRate, 1e-12, 0.5);
+    double ln2 = std::log(2.);
+    numBits = std::max((uint64_t)64, (uint64_t)std::ceil(-n * std::log(p) / (ln2 * ln2)));
+    numBits = (numBits + 63) / 64 * 64;
+    numHashes = std::clamp((int)std::round((double)numBits / n * ln2), 1, 32);
+    bits.assign(numBits / 64, 0);
+}
+
+/**
+ * BloomFilter.contains()
+ * Checks whether an item might have been inserted.
+ * @param hash: The item's hash.
+ */
+bool BloomFilter::contains(uint64_t hash) const {
+    for(int i = 0; i < numHashes; ++i) {
+        uint64_t bit = position(hash, i);
+        if(!(bits[bit / 64] & (1ULL << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * BloomFilter.insert()
+ * Inserts an item.
+ * @param hash: The item's hash.
+ * @return true if the item might already have been inserted.
+ */
+bool BloomFilter::insert(uint64_t hash) {
+    bool present = true;
+    for(int i = 0; i < numHashes; ++i) {
+        uint64_t bit = position(hash, i);
+        uint64_t mask = 1ULL << (bit % 64);
+        if(!(bits[bit / 64] & mask)) {
+            present = false;
+            bits[bit / 64] |= mask;
+        }
+    }
+    return present;
+}
+
+/**
+ * BloomFilter.position()
+ * Returns the bit an item sets for one of the hash functions. The hash
+ * functions are combinations of two independent hashes (h1 + i h2), which is
+ * as good as k independent ones.
+ * @param hash: The item's hash.
+ * @param i: Index of the hash function.
+ */
+uint64_t BloomFilter::position(uint64_t hash, int i) const {
+    // splitmix64 finalizer, for a second hash independent of the first.
+    uint64_t h2 = hash + 0x9E3779B97F4A7C15ULL;
+    h2 = (h2 ^ (h2 >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h2 = (h2 ^ (h2 >> 27)) * 0x94D049BB133111EBULL;
+    h2 = (h2 ^ (h2 >> 31)) | 1;
+    return (hash + (uint64_t)i * h2) % numBits;
+}
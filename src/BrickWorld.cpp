@@ -0,0 +1,249 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "BrickWorld.h"
+
+#include <stdexcept>
+#include <unordered_set>
+
+#include "GeneralizedCellularAutomaton.h"
+
+/**
+ * BrickWorld.capture()
+ * Captures a GCA's configuration. A generation under way is finished first,
+ * since worlds are only captured between generations.
+ * @param gol: The GCA.
+ * @return the captured world, sharing nothing with any other.
+ */
+BrickWorld BrickWorld::capture(GeneralizedCellularAutomaton &gol) {
+    if(gol.numStates > 255) {
+        throw std::runtime_error("BrickWorlds support at most 255 states");
+    }
+    gol.finishGeneration();
+
+    BrickWorld world;
+    world.rule = std::make_shared<const Rule>(Rule{gol.ruleMatrixExt, gol.liveStates});
+    world.generation = gol.generation;
+    world.seed = gol.seed;
+    world.stateCounts = gol.stateCounts;
+
+    // The active Cubes are those the next generation will work on: what the
+    // first stage of the update cycle leaves once it's processed removeCubes
+    // and then addCubes.
+    std::unordered_set<glm::ivec3, KeyFuncs, KeyFuncs> removed(gol.removeCubes.begin(), gol.removeCubes.end());
+    auto mark = [&](const glm::ivec3 &center, int state) {
+        auto &brick = world.bricks[brickOf(center)];
+        if(!brick) {
+            brick = std::make_shared<brick_t>();
+            brick->fill(0);
+        }
+        uint8_t &cell = (*brick)[cellIndex(center)];
+        if(cell == 0) {
+            world.numCubes++;
+        }
+        cell = (uint8_t)(state + 1);
+    };
+    for(auto &activeCube : gol.activeCubes) {
+        if(removed.find(activeCube.first) == removed.end()) {
+            mark(activeCube.first, activeCube.second->state);
+        }
+    }
+    for(auto &addCube : gol.addCubes) {
+        if(!gol.findIn(gol.activeCubes, addCube.first) || removed.find(addCube.first) != removed.end()) {
+            mark(addCube.first, 0);
+        }
+    }
+    return world;
+}
+
+/**
+ * BrickWorld.brickOf()
+ * Brick coordinates of the brick holding a Cube.
+ * @param position: The Cube's logical coordinates.
+ */
+glm::ivec3 BrickWorld::brickOf(const glm::ivec3 &position) {
+    return glm::ivec3(position.x >> brickShift, position.y >> brickShift, position.z >> brickShift);
+}
+
+/**
+ * BrickWorld.cellIndex()
+ * Index of a Cube's cell in its brick, in x, y, z order.
+ * @param position: The Cube's logical coordinates.
+ */
+int BrickWorld::cellIndex(const glm::ivec3 &position) {
+    glm::ivec3 local = position - brickOf(position) * brickWidth;
+    return (local.x * brickWidth + local.y) * brickWidth + local.z;
+}
+
+/**
+ * BrickWorld.getBricks()
+ * The world's bricks. Forks holding the same brick pointer hold the same
+ * cells there, so comparing two worlds can skip every brick they share.
+ */
+const BrickWorld::brickMap_t &BrickWorld::getBricks() const {
+    return bricks;
+}
+
+/**
+ * BrickWorld.fork()
+ * Makes a copy of the world that shares all of its bricks. Either can then be
+ * edited without affecting the other.
+ */
+BrickWorld BrickWorld::fork() const {
+    return *this;
+}
+
+/**
+ * BrickWorld.get()
+ * State of the Cube at a position, or -1 if no Cube is active there.
+ * @param position: The Cube's logical coordinates.
+ */
+int BrickWorld::get(const glm::ivec3 &position) const {
+    auto brick = bricks.find(brickOf(position));
+    if(brick == bricks.end()) {
+        return -1;
+    }
+    return (int)(*brick->second)[cellIndex(position)] - 1;
+}
+
+/**
+ * BrickWorld.memoryUsage()
+ * Estimates the memory, in bytes, held by this world alone: its brick table,
+ * and the bricks (and rule) no other fork shares. This is the cost of a fork
+ * on top of the world it was forked from.
+ */
+size_t BrickWorld::memoryUsage() const {
+    // Each hashmap entry is a node holding the key/value pair and a next
+    // pointer (plus a cached hash), and each bucket is a pointer. Each
+    // shared_ptr allocation adds a control block of two counts.
+    const size_t nodeOverhead = 2 * sizeof(void*);
+    const size_t controlBlock = 2 * sizeof(long);
+    size_t bytes = sizeof(BrickWorld) + stateCounts.capacity() * sizeof(int);
+    bytes += bricks.size() * (sizeof(brickMap_t::value_type) + nodeOverhead);
+    bytes += bricks.bucket_count() * sizeof(void*);
+    bytes += (bricks.size() - numSharedBricks()) * (sizeof(brick_t) + controlBlock);
+    if(rule && rule.use_count() == 1) {
+        for(auto &row : rule->table) {
+            for(auto &entry : row) {
+                bytes += sizeof(std::string) + entry.capacity();
+            }
+        }
+    }
+    return bytes;
+}
+
+/**
+ * BrickWorld.numSharedBricks()
+ * Number of the world's bricks that another fork also holds.
+ */
+size_t BrickWorld::numSharedBricks() const {
+    size_t numShared = 0;
+    for(auto &brick : bricks) {
+        if(brick.second.use_count() > 1) {
+            numShared++;
+        }
+    }
+    return numShared;
+}
+
+/**
+ * BrickWorld.restore()
+ * Restores a GCA to the world, replacing its rule and Cubes. It's left between
+ * generations, ready to run on from the world's generation.
+ * @param gol: The GCA.
+ */
+void BrickWorld::restore(GeneralizedCellularAutomaton &gol) const {
+    if(!rule) {
+        throw std::runtime_error("Restoring an empty BrickWorld");
+    }
+    gol.reset();
+    gol.setRule(rule->table, rule->liveStates);
+    for(int i = 0; i < gol.numStates && i < (int)stateCounts.size(); ++i) {
+        gol.stateCounts[i] = stateCounts[i];
+    }
+
+    // Insert every Cube, then set the states directly: the next generation's
+    // first stage sees nothing to add or remove.
+    gol.activeCubes.reserve(numCubes);
+    for(auto &entry : bricks) {
+        glm::ivec3 origin = entry.first * brickWidth;
+        const brick_t &brick = *entry.second;
+        for(int j = 0; j < brickSize; ++j) {
+            if(brick[j] == 0) {
+                continue;
+            }
+            int x = origin.x + j / (brickWidth * brickWidth);
+            int y = origin.y + (j / brickWidth) % brickWidth;
+            int z = origin.z + j % brickWidth;
+            gol.add(x, y, z);
+            int state = brick[j] - 1;
+            if(state != 0) {
+                Cube *c = gol.activeCubes[glm::ivec3(x, y, z)];
+                c->state = state;
+                gol.drawCubes.insert({c->center, c});
+                gol.recordChange(c, 0);
+            }
+        }
+    }
+    gol.changes.clear();
+    gol.generation = generation;
+    gol.seed = seed;
+}
+
+/**
+ * BrickWorld.set()
+ * Sets the state of the Cube at a position, copying its brick first if
+ * another fork holds it. Changing a Cube's state also activates its
+ * neighbors, which the next generation has to update, as
+ * GeneralizedCellularAutomaton.setCube() does.
+ * @param position: The Cube's logical coordinates.
+ * @param state: Its new state.
+ */
+void BrickWorld::set(const glm::ivec3 &position, int state) {
+    if(state < 0 || state >= (int)stateCounts.size()) {
+        throw std::runtime_error("State " + std::to_string(state) + " out of range");
+    }
+    int prevState = get(position);
+    if(prevState == state || (state == 0 && prevState < 0)) {
+        return;
+    }
+
+    uint8_t *cell = writableCell(position);
+    if(*cell == 0) {
+        numCubes++;
+    } else {
+        stateCounts[*cell - 1]--;
+    }
+    *cell = (uint8_t)(state + 1);
+    stateCounts[state]++;
+
+    for(int dx = -1; dx <= 1; ++dx) {
+        for(int dy = -1; dy <= 1; ++dy) {
+            for(int dz = -1; dz <= 1; ++dz) {
+                glm::ivec3 neighbor = position + glm::ivec3(dx, dy, dz);
+                if(get(neighbor) < 0) {
+                    *writableCell(neighbor) = 1;
+                    numCubes++;
+                    stateCounts[0]++;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * BrickWorld.writableCell()
+ * The cell of a Cube, in a brick this world holds alone, creating the brick
+ * or copying a shared one as needed.
+ * @param position: The Cube's logical coordinates.
+ */
+uint8_t *BrickWorld::writableCell(const glm::ivec3 &position) {
+    auto &brick = bricks[brickOf(position)];
+    if(!brick) {
+        brick = std::make_shared<brick_t>();
+        brick->fill(0);
+    } else if(brick.use_count() > 1) {
+        brick = std::make_shared<brick_t>(*brick);
+    }
+    return &(*brick)[cellIndex(position)];
+}
@@ -56,7 +56,9 @@ void CellularAutomaton::cubeCube(
  */
 void CellularAutomaton::flip(Cube *c) {
     // Increment state (mod numStates).
+    int prevState = c->state;
     c->state = (c->state + 1) % numStates;
+    recordChange(c, prevState);
 
 
     // Update the Cube's status in drawCubes.
@@ -87,36 +89,6 @@ void CellularAutomaton::flip(Cube *c) {
     }
 }
 
-/**
- * CellularAutomaton.handleInput()
- * Handles events triggered by user input.
- */
-void CellularAutomaton::handleInput() {
-    // Only handle IO if this Object is active.
-    if(active) {
-        // CellularAutomaton state changes use keys 1, 2, 3.
-        if(io.toggled(GLFW_KEY_1)) {
-            state = stop;
-
-        } else if(io.toggled(GLFW_KEY_3)) {
-            state = run;
-
-        } else if(io.toggled(GLFW_KEY_E)) {
-            // Step forward one step, if stopped.
-            if(state == stop) {
-                state = step;
-                // Record which stage of the update cycle the step
-                // starts on.
-                stepStart = cycleStage;
-            }
-
-        } else if(io.toggled(GLFW_KEY_R)) {
-            // Reset.
-            reset();
-        }
-    }
-}
-
 /**
  * CellularAutomaton.setCube()
  * Sets Cube *c's state to (state).
@@ -132,6 +104,7 @@ void CellularAutomaton::setCube(Cube *c, int state) {
     if(state != prevState) {
         // Set state.
         c->state = state;
+        recordChange(c, prevState);
 
         // Update the Cube's status in drawCubes.
         if (c->state == 0) {
@@ -198,11 +171,11 @@ void CellularAutomaton::setRule(std::vector<int> born_vals, std::vector<int> sta
 
 /**
  * CellularAutomaton.update()
- * Updates the Cubes in activeCubes.
+ * Applies posted commands, then advances the update cycle one stage.
  */
 void CellularAutomaton::update() {
-    // Handle user input.
-    handleInput();
+    // Apply edits and run state changes posted since the last update.
+    commands.execute();
 
     // If this is the active Object, and it's in the 'run' state or
     // undergoing a single update step, update.
@@ -225,6 +198,7 @@ void CellularAutomaton::update() {
         } else if(cycleStage == 4) {
             // End of the update cycle.
             cycleStage = 0;
+            generation++;
 
         } else {
             printf("Something has gone wrong with a CellularAutomaton update.\n");
@@ -236,6 +210,9 @@ void CellularAutomaton::update() {
             state = stop;
         }
     }
+
+    // Hand the renderer a new snapshot, if anything changed.
+    publishSnapshot();
 }
 
 /**
@@ -319,6 +296,9 @@ void CellularAutomaton::updateResetCount() {
  * Updates the state of each Cube in activeCubes.
  */
 void CellularAutomaton::updateState() {
+    // Start this generation's change list.
+    beginChanges();
+
     for(auto & activeCube : activeCubes) {
         Cube *c = activeCube.second;
 
@@ -0,0 +1,327 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "Checkpoint.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <tuple>
+
+#include "BrickWorld.h"
+#include "GeneralizedCellularAutomaton.h"
+
+namespace fs = std::filesystem;
+
+static const char magic[8] = {'G', 'O', 'L', '3', 'D', 'C', 'K', 'P'};
+
+// Byte offsets of the header fields. See Checkpoint.h.
+static const size_t offsetVersion = 8;
+static const size_t offsetHeaderSize = 12;
+static const size_t offsetGeneration = 16;
+static const size_t offsetNumStates = 20;
+static const size_t offsetSeed = 24;
+static const size_t offsetConfigHash = 32;
+static const size_t offsetLiveStates = 40;
+static const size_t offsetNumCubes = 44;
+static const size_t offsetNumBricks = 48;
+static const size_t offsetRuleSize = 52;
+static const size_t offsetExtraSize = 56;
+static const size_t headerSize = 64;
+
+// Bricks are laid out as in BrickWorlds.
+static const int brickWidth = BrickWorld::brickWidth;
+static const int brickSize = BrickWorld::brickSize;
+
+/**
+ * append()
+ * Appends a value's bytes to a buffer.
+ * @param buffer: The buffer.
+ * @param value: The value.
+ */
+template<typename T>
+static void append(std::vector<char> &buffer, T value) {
+    size_t at = buffer.size();
+    buffer.resize(at + sizeof(T));
+    std::memcpy(buffer.data() + at, &value, sizeof(T));
+}
+
+/**
+ * put()
+ * Copies a value into a byte buffer.
+ * @param buffer: The buffer.
+ * @param offset: Where in the buffer to put it.
+ * @param value: The value.
+ */
+template<typename T>
+static void put(std::vector<char> &buffer, size_t offset, T value) {
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+// Reads values off the front of a byte range, throwing if it runs out.
+struct Reader {
+    const char *data;
+    size_t size;
+    size_t offset = 0;
+
+    template<typename T>
+    T next() {
+        T value;
+        std::memcpy(&value, bytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    const char *bytes(size_t n) {
+        if(n > size - offset) {
+            throw std::runtime_error("Truncated checkpoint");
+        }
+        const char *start = data + offset;
+        offset += n;
+        return start;
+    }
+};
+
+/**
+ * Checkpoint.encode()
+ * Takes a checkpoint of a GCA. A generation under way is finished first, since
+ * checkpoints are only taken between generations.
+ * @param gol: The GCA.
+ * @param extra: Extra data to store with the checkpoint.
+ * @return the checkpoint.
+ */
+std::vector<char> Checkpoint::encode(GeneralizedCellularAutomaton &gol, const std::vector<char> &extra) {
+    if(gol.numStates > 255) {
+        throw std::runtime_error("Checkpoints support at most 255 states");
+    }
+    BrickWorld world = BrickWorld::capture(gol);
+    const BrickWorld::brickMap_t &bricks = world.getBricks();
+    uint32_t numCubes = (uint32_t)world.numCubes;
+
+    std::vector<glm::ivec3> brickCenters;
+    brickCenters.reserve(bricks.size());
+    for(auto &brick : bricks) {
+        brickCenters.push_back(brick.first);
+    }
+    std::sort(brickCenters.begin(), brickCenters.end(), [](const glm::ivec3 &a, const glm::ivec3 &b) {
+        return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+    });
+
+    std::vector<char> out(headerSize, 0);
+    std::memcpy(out.data(), magic, sizeof(magic));
+
+    // Rule.
+    size_t ruleStart = out.size();
+    append<uint32_t>(out, (uint32_t)gol.ruleMatrixExt.size());
+    for(auto &row : gol.ruleMatrixExt) {
+        append<uint32_t>(out, (uint32_t)row.size());
+        for(auto &entry : row) {
+            append<uint32_t>(out, (uint32_t)entry.size());
+            out.insert(out.end(), entry.begin(), entry.end());
+        }
+    }
+    size_t ruleSize = out.size() - ruleStart;
+
+    // State counts.
+    for(int i = 0; i < gol.numStates; ++i) {
+        append<int32_t>(out, i < (int)gol.stateCounts.size() ? gol.stateCounts[i] : 0);
+    }
+
+    // Bricks, run-length encoded.
+    for(auto &brickCenter : brickCenters) {
+        const BrickWorld::brick_t &brick = *bricks.at(brickCenter);
+        append<int32_t>(out, brickCenter.x);
+        append<int32_t>(out, brickCenter.y);
+        append<int32_t>(out, brickCenter.z);
+        size_t numRunsOffset = out.size();
+        append<uint16_t>(out, 0);
+
+        uint16_t numRuns = 0;
+        for(int i = 0; i < brickSize;) {
+            int length = 1;
+            while(i + length < brickSize && length < 256 && brick[i + length] == brick[i]) {
+                length++;
+            }
+            append<uint8_t>(out, brick[i]);
+            append<uint8_t>(out, (uint8_t)(length - 1));
+            numRuns++;
+            i += length;
+        }
+        put<uint16_t>(out, numRunsOffset, numRuns);
+    }
+
+    out.insert(out.end(), extra.begin(), extra.end());
+
+    uint32_t liveStatesMask = 0;
+    for(int s : gol.liveStates) {
+        if(s >= 0 && s < 32) {
+            liveStatesMask |= 1u << s;
+        }
+    }
+    put<uint32_t>(out, offsetVersion, version);
+    put<uint32_t>(out, offsetHeaderSize, (uint32_t)headerSize);
+    put<int32_t>(out, offsetGeneration, gol.generation);
+    put<uint32_t>(out, offsetNumStates, (uint32_t)gol.numStates);
+    put<int64_t>(out, offsetSeed, gol.seed);
+    put<uint64_t>(out, offsetConfigHash, gol.configHash);
+    put<uint32_t>(out, offsetLiveStates, liveStatesMask);
+    put<uint32_t>(out, offsetNumCubes, numCubes);
+    put<uint32_t>(out, offsetNumBricks, (uint32_t)brickCenters.size());
+    put<uint32_t>(out, offsetRuleSize, (uint32_t)ruleSize);
+    put<uint32_t>(out, offsetExtraSize, (uint32_t)extra.size());
+    return out;
+}
+
+/**
+ * Checkpoint.decode()
+ * Restores a GCA from a checkpoint, replacing its rule and Cubes. It's left
+ * between generations, ready to carry on from where the checkpoint was taken.
+ * @param gol: The GCA.
+ * @param data: The checkpoint.
+ * @param size: Size of the checkpoint, in bytes.
+ * @param extra: If not null, receives the checkpoint's extra data.
+ */
+void Checkpoint::decode(GeneralizedCellularAutomaton &gol, const char *data, size_t size, std::vector<char> *extra) {
+    Reader in{data, size};
+    if(std::memcmp(in.bytes(headerSize), magic, sizeof(magic)) != 0) {
+        throw std::runtime_error("Not a checkpoint");
+    }
+    in.offset = offsetVersion;
+    if(in.next<uint32_t>() != version) {
+        throw std::runtime_error("Unsupported checkpoint version");
+    }
+    in.offset = offsetGeneration;
+    int generation = in.next<int32_t>();
+    int numStates = (int)in.next<uint32_t>();
+    long long seed = in.next<int64_t>();
+    uint64_t configHash = in.next<uint64_t>();
+    uint32_t liveStatesMask = in.next<uint32_t>();
+    uint32_t numCubes = in.next<uint32_t>();
+    uint32_t numBricks = in.next<uint32_t>();
+    in.next<uint32_t>();
+    uint32_t extraSize = in.next<uint32_t>();
+    in.offset = headerSize;
+
+    std::vector<std::vector<std::string>> table(in.next<uint32_t>());
+    for(auto &row : table) {
+        row.resize(in.next<uint32_t>());
+        for(auto &entry : row) {
+            uint32_t length = in.next<uint32_t>();
+            entry.assign(in.bytes(length), length);
+        }
+    }
+    std::set<int> liveStates;
+    for(int s = 0; s < 32; ++s) {
+        if(liveStatesMask & (1u << s)) {
+            liveStates.insert(s);
+        }
+    }
+    if((int)table.size() != numStates) {
+        throw std::runtime_error("Corrupt checkpoint");
+    }
+
+    gol.reset();
+    gol.setRule(table, liveStates);
+    for(int i = 0; i < numStates; ++i) {
+        gol.stateCounts[i] = in.next<int32_t>();
+    }
+
+    // Insert every Cube, then set the states directly: the next generation's
+    // first stage sees nothing to add or remove, just like the original's.
+    gol.activeCubes.reserve(numCubes);
+    for(uint32_t b = 0; b < numBricks; ++b) {
+        glm::ivec3 brickCenter;
+        brickCenter.x = in.next<int32_t>();
+        brickCenter.y = in.next<int32_t>();
+        brickCenter.z = in.next<int32_t>();
+        glm::ivec3 origin = brickCenter * brickWidth;
+        uint16_t numRuns = in.next<uint16_t>();
+
+        int i = 0;
+        for(uint16_t r = 0; r < numRuns; ++r) {
+            int value = in.next<uint8_t>();
+            int length = in.next<uint8_t>() + 1;
+            if(i + length > brickSize || value > numStates) {
+                throw std::runtime_error("Corrupt checkpoint");
+            }
+            int state = value - 1;
+            for(int j = i; value > 0 && j < i + length; ++j) {
+                int x = origin.x + j / (brickWidth * brickWidth);
+                int y = origin.y + (j / brickWidth) % brickWidth;
+                int z = origin.z + j % brickWidth;
+                gol.add(x, y, z);
+                if(state != 0) {
+                    Cube *c = gol.activeCubes[glm::ivec3(x, y, z)];
+                    c->state = state;
+                    gol.drawCubes.insert({c->center, c});
+                    gol.recordChange(c, 0);
+                }
+            }
+            i += length;
+        }
+    }
+    gol.changes.clear();
+    gol.generation = generation;
+    gol.seed = seed;
+
+    if(gol.activeCubes.size() != numCubes || gol.configHash != configHash) {
+        throw std::runtime_error("Corrupt checkpoint");
+    }
+
+    if(extra != nullptr) {
+        const char *extraData = in.bytes(extraSize);
+        extra->assign(extraData, extraData + extraSize);
+    }
+}
+
+/**
+ * Checkpoint.load()
+ * Restores a GCA from a checkpoint file.
+ * @param gol: The GCA.
+ * @param path: Path of the file to read.
+ * @param extra: If not null, receives the checkpoint's extra data.
+ */
+void Checkpoint::load(GeneralizedCellularAutomaton &gol, const std::string &path, std::vector<char> *extra) {
+    FILE *in = fopen(path.c_str(), "rb");
+    if(in == nullptr) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+
+    // Read the whole file in one go.
+    std::vector<char> data(fs::file_size(path));
+    size_t numRead = fread(data.data(), 1, data.size(), in);
+    fclose(in);
+    if(numRead != data.size()) {
+        throw std::runtime_error("Could not read file: " + path);
+    }
+
+    decode(gol, data.data(), data.size(), extra);
+}
+
+/**
+ * Checkpoint.save()
+ * Writes a checkpoint of a GCA to a file, creating its directory if needed.
+ * The file is written under a temporary name and then renamed, so a crash
+ * never leaves a partial checkpoint behind.
+ * @param gol: The GCA.
+ * @param path: Path of the file to write.
+ * @param extra: Extra data to store with the checkpoint.
+ */
+void Checkpoint::save(GeneralizedCellularAutomaton &gol, const std::string &path, const std::vector<char> &extra) {
+    std::vector<char> data = encode(gol, extra);
+
+    fs::path filePath(path);
+    if(filePath.has_parent_path()) {
+        fs::create_directories(filePath.parent_path());
+    }
+    std::string tempPath = path + ".tmp";
+    FILE *out = fopen(tempPath.c_str(), "wb");
+    if(out == nullptr) {
+        throw std::runtime_error("Failed to open file for writing: " + tempPath);
+    }
+    size_t numWritten = fwrite(data.data(), 1, data.size(), out);
+    if(fclose(out) != 0 || numWritten != data.size()) {
+        throw std::runtime_error("Failed to write file: " + tempPath);
+    }
+    fs::rename(tempPath, path);
+}
@@ -0,0 +1,43 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "CommandQueue.h"
+
+/**
+ * CommandQueue.clear()
+ * Drops all pending commands without running them.
+ */
+void CommandQueue::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.clear();
+}
+
+/**
+ * CommandQueue.execute()
+ * Runs every command posted so far, in the order they were posted. Commands
+ * posted while executing run on the next call.
+ */
+void CommandQueue::execute() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(pending.empty()) {
+            return;
+        }
+        std::swap(pending, executing);
+    }
+
+    for(auto &command : executing) {
+        command();
+    }
+    executing.clear();
+}
+
+/**
+ * CommandQueue.post()
+ * Adds a command to the queue.
+ * @param command: The action to run on the next execute().
+ */
+void CommandQueue::post(std::function<void()> command) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(std::move(command));
+}
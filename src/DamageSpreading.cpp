@@ -0,0 +1,152 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "DamageSpreading.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "BrickWorld.h"
+#include "GeneralizedCellularAutomaton.h"
+
+/**
+ * stateAt()
+ * State of a GCA's Cube, 0 if it isn't active.
+ * @param gol: The GCA.
+ * @param position: The Cube's logical coordinates.
+ */
+static int stateAt(const GeneralizedCellularAutomaton &gol, const glm::ivec3 &position) {
+    auto cube = gol.activeCubes.find(position);
+    return cube == gol.activeCubes.end() ? 0 : cube->second->state;
+}
+
+/**
+ * DamageSpreading.begin()
+ * Starts measuring a run between generations: makes the perturbed copy of the
+ * reference, with the Cube at the site flipped from dead to the rule's first
+ * live state, or from any other state to dead, and records generation 0.
+ * @param reference: The run being measured.
+ * @param perturbed: Automaton to run the perturbed copy on. Reset first.
+ * @param site_: Logical coordinates of the Cube to perturb.
+ */
+void DamageSpreading::begin(GeneralizedCellularAutomaton &reference,
+                            GeneralizedCellularAutomaton &perturbed,
+                            const glm::ivec3 &site_) {
+    clear();
+    site = site_;
+    BrickWorld::capture(reference).restore(perturbed);
+
+    int state = stateAt(perturbed, site);
+    int flipped = 0;
+    if(state == 0) {
+        flipped = perturbed.liveStates.empty() ? 1 : *perturbed.liveStates.begin();
+    }
+    if(!perturbed.findIn(perturbed.activeCubes, site)) {
+        perturbed.add(site.x, site.y, site.z);
+    }
+    perturbed.setCube(perturbed.activeCubes[site], flipped);
+
+    differing.insert(site);
+    generationLog.push_back(reference.generation);
+    hammingLog.push_back(1);
+    radiusLog.push_back(0);
+}
+
+/**
+ * DamageSpreading.clear()
+ * Drops the measurements.
+ */
+void DamageSpreading::clear() {
+    differing.clear();
+    generationLog.clear();
+    hammingLog.clear();
+    radiusLog.clear();
+}
+
+/**
+ * DamageSpreading.compare()
+ * Updates whether a Cube differs between the runs.
+ * @param reference: The reference run.
+ * @param perturbed: The perturbed run.
+ * @param position: The Cube's logical coordinates.
+ */
+void DamageSpreading::compare(const GeneralizedCellularAutomaton &reference,
+                              const GeneralizedCellularAutomaton &perturbed,
+                              const glm::ivec3 &position) {
+    if(stateAt(reference, position) != stateAt(perturbed, position)) {
+        differing.insert(position);
+    } else {
+        differing.erase(position);
+    }
+}
+
+/**
+ * DamageSpreading.empty()
+ * True if nothing has been measured.
+ */
+bool DamageSpreading::empty() const {
+    return hammingLog.empty();
+}
+
+/**
+ * DamageSpreading.lyapunovExponent()
+ * Estimate of the damage's growth exponent: the mean growth of the log of the
+ * Hamming distance per generation, from the perturbation to the last record.
+ * Damage that healed counts as not having grown.
+ */
+double DamageSpreading::lyapunovExponent() const {
+    if(generationLog.size() < 2) {
+        return 0.;
+    }
+    int numGenerations = generationLog.back() - generationLog.front();
+    return std::log((double)std::max(hammingLog.back(), 1)) / numGenerations;
+}
+
+/**
+ * DamageSpreading.maxRadius()
+ * Largest radius the difference region reached, or -1 if there never was
+ * one.
+ */
+int DamageSpreading::maxRadius() const {
+    return radiusLog.empty() ? -1 : *std::max_element(radiusLog.begin(), radiusLog.end());
+}
+
+/**
+ * DamageSpreading.record()
+ * Records the damage after a generation of both runs. Call it between
+ * generations, after every generation since begin().
+ * @param reference: The reference run.
+ * @param perturbed: The perturbed run.
+ */
+void DamageSpreading::record(const GeneralizedCellularAutomaton &reference,
+                             const GeneralizedCellularAutomaton &perturbed) {
+    for(auto &change : reference.getChanges()) {
+        compare(reference, perturbed, change.center);
+    }
+    for(auto &change : perturbed.getChanges()) {
+        compare(reference, perturbed, change.center);
+    }
+
+    int radius = -1;
+    for(auto &position : differing) {
+        glm::ivec3 offset = position - site;
+        radius = std::max(radius, std::max(std::abs(offset.x), std::max(std::abs(offset.y), std::abs(offset.z))));
+    }
+    generationLog.push_back(reference.generation);
+    hammingLog.push_back((int)differing.size());
+    radiusLog.push_back(radius);
+}
+
+/**
+ * DamageSpreading.spreadRate()
+ * Speed the difference region spread at: its largest radius over the number
+ * of generations measured, at most 1.
+ */
+double DamageSpreading::spreadRate() const {
+    if(generationLog.size() < 2) {
+        return 0.;
+    }
+    int numGenerations = generationLog.back() - generationLog.front();
+    return (double)std::max(maxRadius(), 0) / numGenerations;
+}
@@ -13,6 +13,7 @@
 GeneralizedCellularAutomaton::GeneralizedCellularAutomaton() : Object() {
     numStates = -1;
     stepStart = 0;
+    resumableUpdates = true;
 }
 
 GeneralizedCellularAutomaton::~GeneralizedCellularAutomaton() {
@@ -27,15 +28,21 @@ GeneralizedCellularAutomaton::~GeneralizedCellularAutomaton() {
  * @param hwidth: Setup volume half-width.
  * @param ps: Live Cube state activation probabilities.
  * @param center: Center of the cube of Cubes.
+ * @param seed: Random seed, or -1 to seed from the system clock.
  */
 void GeneralizedCellularAutomaton::cubeCube(
         int hwidth,
         std::vector<float> ps,
-        glm::ivec3 center) {
-    // Obtain a seed from the system clock:
-    auto seed = static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count());
+        glm::ivec3 center,
+        long long seed) {
+    // Obtain a seed from the system clock, if none was given.
+    if(seed < 0) {
+        seed = std::chrono::system_clock::now().time_since_epoch().count() & 0xFFFFFFFF;
+    }
+
+    this->seed = seed;
 
-    std::mt19937 gen(seed);
+    std::mt19937 gen(static_cast<unsigned int>(seed));
     std::uniform_real_distribution<float> u(0.f, 1.f);
 
     int cx = center.x;
@@ -70,36 +77,6 @@ void GeneralizedCellularAutomaton::cubeCube(
     recomputeStateCounts();
 }
 
-/**
- * GeneralizedCellularAutomaton.handleInput()
- * Handles events triggered by user input.
- */
-void GeneralizedCellularAutomaton::handleInput() {
-    // Only handle IO if this Object is active.
-    if(active) {
-        // CellularAutomaton state changes use keys 1, 2, 3.
-        if(io.toggled(GLFW_KEY_1)) {
-            state = stop;
-
-        } else if(io.toggled(GLFW_KEY_3)) {
-            state = run;
-
-        } else if(io.toggled(GLFW_KEY_E)) {
-            // Step forward one step, if stopped.
-            if(state == stop) {
-                state = step;
-                // Record which stage of the update cycle the step
-                // starts on.
-                stepStart = cycleStage;
-            }
-
-        } else if(io.toggled(GLFW_KEY_R)) {
-            // Reset.
-            reset();
-        }
-    }
-}
-
 /**
  * GeneralizedCellularAutomaton.parseRuleRow()
  * Convert a rule row from its human-friendly string-based "external"
@@ -209,6 +186,22 @@ void GeneralizedCellularAutomaton::recomputeStateCounts() {
 }
 
 
+/**
+ * GeneralizedCellularAutomaton.reset()
+ * Resets the GCA, abandoning any stage or fast-forward in progress. The rule
+ * is kept.
+ */
+void GeneralizedCellularAutomaton::reset() {
+    Object::reset();
+
+    stageInProgress = false;
+    pendingStates.clear();
+    fastForwardActive = false;
+    fastForwardLeft = 0;
+    stateCounts.assign(stateCounts.size(), 0);
+    seed = -1;
+}
+
 /**
  * GeneralizedCellularAutomaton.setCube()
  * Sets Cube *c's state to (state).
@@ -224,6 +217,7 @@ void GeneralizedCellularAutomaton::setCube(Cube *c, int state) {
     if(state != prevState) {
         // Set state.
         c->state = state;
+        recordChange(c, prevState);
 
         // Update the Cube's status in drawCubes.
         if (c->state == 0) {
@@ -254,6 +248,35 @@ void GeneralizedCellularAutomaton::setCube(Cube *c, int state) {
 }
 
 
+/**
+ * GeneralizedCellularAutomaton.formatRule()
+ * Writes a rule matrix, in its external representation, as a string.
+ * @param rule: The rule matrix.
+ */
+std::string GeneralizedCellularAutomaton::formatRule(const std::vector<std::vector<std::string>> &rule) {
+    std::stringstream ruleStringStream;
+    ruleStringStream << "{";
+    for (int i = 0; i < rule.size(); ++i) {
+        ruleStringStream << "{";
+        const std::vector<std::string> &ruleRow = rule.at(i);
+        for (int j = 0; j < ruleRow.size(); ++j) {
+            const std::string &s = ruleRow.at(j);
+            ruleStringStream << s;
+            if (j < ruleRow.size() - 1) {
+                ruleStringStream << "/";
+            } else {
+                ruleStringStream << "}";
+            }
+        }
+        if (i < rule.size() - 1) {
+            ruleStringStream << ", ";
+        } else {
+            ruleStringStream << "}";
+        }
+    }
+    return ruleStringStream.str();
+}
+
 /**
  * GeneralizedCellularAutomaton.setRule()
  * Sets the update rule for the Cube states. Given k states {0,...,k-1}, the
@@ -279,33 +302,15 @@ void GeneralizedCellularAutomaton::setRule(
     // transition to
     ruleMatrixExt = _ruleMatrixExt;
     liveStates = _liveStates;
+    ruleMatrixInt.clear();
     for (auto &row : ruleMatrixExt) {
         ruleMatrixInt.push_back(parseRuleRow(row));
     }
     numStates = (int)ruleMatrixExt.size();
     stateCounts = std::vector<int>(numStates, 0);
+    ruleFirstUse.assign(numStates, std::vector<int>(27, -1));
 
-    std::stringstream ruleStringStream;
-    ruleStringStream << "{";
-    for (int i = 0; i < ruleMatrixExt.size(); ++i) {
-        ruleStringStream << "{";
-        const std::vector<std::string> &ruleRow = ruleMatrixExt.at(i);
-        for (int j = 0; j < ruleRow.size(); ++j) {
-            const std::string &s = ruleRow.at(j);
-            ruleStringStream << s;
-            if (j < ruleRow.size() - 1) {
-                ruleStringStream << "/";
-            } else {
-                ruleStringStream << "}";
-            }
-        }
-        if (i < ruleMatrixExt.size() - 1) {
-            ruleStringStream << ", ";
-        } else {
-            ruleStringStream << "}";
-        }
-    }
-    ruleString = ruleStringStream.str();
+    ruleString = formatRule(ruleMatrixExt);
 
 
 //    std::ofstream debugFile;
@@ -326,45 +331,137 @@ void GeneralizedCellularAutomaton::setRule(
 
 
 /**
- * GeneralizedCellularAutomaton.update()
- * Updates the Cubes in activeCubes.
+ * GeneralizedCellularAutomaton.finishGeneration()
+ * Runs the rest of the current generation, if one is under way, ignoring the
+ * run state and the update budget.
  */
-void GeneralizedCellularAutomaton::update() {
-    // Handle user input.
-    handleInput();
+void GeneralizedCellularAutomaton::finishGeneration() {
+    deadline = std::chrono::steady_clock::time_point::max();
+    while(stageInProgress || cycleStage != 0) {
+        runStage();
+    }
+}
+
+/**
+ * GeneralizedCellularAutomaton.outOfTime()
+ * Checks whether the current update() call has used up its time budget.
+ * Reading the clock is comparatively slow, so it's only read once every
+ * `timeCheckInterval` calls.
+ * @param counter: Per-pass call counter.
+ */
+bool GeneralizedCellularAutomaton::outOfTime(int &counter) {
+    if(++counter < timeCheckInterval) {
+        return false;
+    }
+    counter = 0;
+    return std::chrono::steady_clock::now() >= deadline;
+}
+
+/**
+ * GeneralizedCellularAutomaton.runStage()
+ * Works on the current stage of the update cycle until it's finished or the
+ * deadline passes, and keeps track of how long each generation takes.
+ */
+void GeneralizedCellularAutomaton::runStage() {
+    auto stageStart = std::chrono::steady_clock::now();
+
+    if(cycleStage == 0) {
+        if(!stageInProgress) {
+            // A new generation is starting.
+            generationStart = stageStart;
+            generationWork = 0.;
+        }
+        updateActiveCubes();
 
-    // If this is the active Object, and it's in the 'run' state or
-    // undergoing a single update step, update.
-    if(active && (state != stop)) {
-        // Track the cycleStage at the beginning of each frame's update, to see when it changes.
-        int initCycleStage = cycleStage;
+    } else if(cycleStage == 1) {
+        updateNeighborCount();
 
-        if(cycleStage == 0) {
-            updateActiveCubes();
+    } else if(cycleStage == 2) {
+        updateState();
 
-        } else if(cycleStage == 1) {
-            updateNeighborCount();
+    } else if(cycleStage == 3) {
+        updateResetCount();
 
-        } else if(cycleStage == 2) {
-            updateState();
+    } else if(cycleStage == 4) {
+        // End of the update cycle.
+        cycleStage = 0;
+        generation++;
 
-        } else if(cycleStage == 3) {
-            updateResetCount();
+        std::chrono::duration<double, std::milli> latency = stageStart - generationStart;
+        generationLatency = latency.count();
+        generationWorkTime = generationWork;
 
-        } else if(cycleStage == 4) {
-            // End of the update cycle.
-            cycleStage = 0;
+    } else {
+        printf("Something has gone wrong with a CellularAutomaton update.\n");
+        abort();
+    }
 
+    std::chrono::duration<double, std::milli> work = std::chrono::steady_clock::now() - stageStart;
+    generationWork += work.count();
+}
+
+/**
+ * GeneralizedCellularAutomaton.update()
+ * Applies posted commands, then advances the update cycle. With no update
+ * budget, that's one whole stage per call. With a budget, stages are worked on
+ * in chunks until the budget runs out or a generation finishes, and the next
+ * call picks up where this one left off.
+ */
+void GeneralizedCellularAutomaton::update() {
+    // Apply edits and run state changes posted since the last update. Edits
+    // can reshape the Cube maps, so they wait while a stage is part way
+    // through a pass over them.
+    if(!stageInProgress) {
+        commands.execute();
+    }
+
+    if(fastForwardLeft.load() > 0) {
+        fastForwardActive = true;
+    }
+
+    // If this is the active Object, and it's in the 'run' state, undergoing a
+    // single update step, or fast-forwarding, update.
+    if(active && (state != stop || fastForwardActive)) {
+        // Fast-forwarding works in longer slices, and isn't limited to one
+        // generation per update.
+        double budget = fastForwardActive ? fastForwardSlice : updateBudget;
+        if(budget > 0.) {
+            deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double, std::milli>(budget));
         } else {
-            printf("Something has gone wrong with a CellularAutomaton update.\n");
-            abort();
+            deadline = std::chrono::steady_clock::time_point::max();
         }
 
-        if(state == step && initCycleStage != cycleStage && cycleStage == stepStart) {
-            // We've made one loop through the update cycle since beginning a step.
-            state = stop;
+        bool keepGoing = true;
+        while(keepGoing) {
+            // Track the cycleStage before each stage, to see when it changes.
+            int initCycleStage = cycleStage;
+
+            runStage();
+
+            if(state == step && initCycleStage != cycleStage && cycleStage == stepStart) {
+                // We've made one loop through the update cycle since beginning a step.
+                state = stop;
+            }
+
+            bool generationDone = (initCycleStage == 4);
+            if(fastForwardActive) {
+                // Count down, and finish at a generation boundary once the
+                // count runs out or the fast-forward is cancelled.
+                if(generationDone && fastForwardLeft.fetch_sub(1) <= 1) {
+                    fastForwardLeft = 0;
+                    fastForwardActive = false;
+                    keepGoing = false;
+                }
+            } else {
+                keepGoing = (state != stop) && !generationDone;
+            }
+            keepGoing = keepGoing && (budget > 0.) && (std::chrono::steady_clock::now() < deadline);
         }
     }
+
+    // Hand the renderer a new snapshot, if anything changed.
+    publishSnapshot();
 }
 
 /**
@@ -372,14 +469,27 @@ void GeneralizedCellularAutomaton::update() {
  * Processes removeCubes and addCubes to update activeCubes.
  */
 void GeneralizedCellularAutomaton::updateActiveCubes() {
+    if(!stageInProgress) {
+        removeCursor = 0;
+        addCursor = addCubes.begin();
+        stageInProgress = true;
+    }
+    int counter = 0;
+
     // First remove inactive Cubes from activeCubes.
-    for(auto &center : removeCubes) {
-        remove(center);
+    for(; removeCursor < removeCubes.size(); ++removeCursor) {
+        if(outOfTime(counter)) {
+            return;
+        }
+        remove(removeCubes[removeCursor]);
     }
 
     // Second, add newly-active Cubes to activeCubes.
-    for(auto & addCube : addCubes) {
-        glm::ivec3 center = addCube.first;
+    for(; addCursor != addCubes.end(); ++addCursor) {
+        if(outOfTime(counter)) {
+            return;
+        }
+        glm::ivec3 center = addCursor->first;
         add(center.x, center.y, center.z);
     }
 
@@ -387,6 +497,7 @@ void GeneralizedCellularAutomaton::updateActiveCubes() {
     addCubes.clear();
     removeCubes.clear();
 
+    stageInProgress = false;
     cycleStage++;
 }
 
@@ -395,8 +506,17 @@ void GeneralizedCellularAutomaton::updateActiveCubes() {
  * Counts the number of live Cubes neighboring each Cube in activeCubes.
  */
 void GeneralizedCellularAutomaton::updateNeighborCount() {
-    for(auto & activeCube : activeCubes) {
-        Cube *c = activeCube.second;
+    if(!stageInProgress) {
+        stageCursor = activeCubes.begin();
+        stageInProgress = true;
+    }
+    int counter = 0;
+
+    for(; stageCursor != activeCubes.end(); ++stageCursor) {
+        if(outOfTime(counter)) {
+            return;
+        }
+        Cube *c = stageCursor->second;
 
         // Only update if c is live.
         if(in(liveStates, c->state)) {
@@ -423,6 +543,8 @@ void GeneralizedCellularAutomaton::updateNeighborCount() {
             }
         }
     }
+
+    stageInProgress = false;
     cycleStage++;
 }
 
@@ -431,35 +553,68 @@ void GeneralizedCellularAutomaton::updateNeighborCount() {
  * Resets the liveNeighbors property to 0 for all Cubes in activeCubes.
  */
 void GeneralizedCellularAutomaton::updateResetCount() {
-    for(auto & activeCube : activeCubes) {
-        Cube *c = activeCube.second;
+    if(!stageInProgress) {
+        stageCursor = activeCubes.begin();
+        stageInProgress = true;
+    }
+    int counter = 0;
+
+    for(; stageCursor != activeCubes.end(); ++stageCursor) {
+        if(outOfTime(counter)) {
+            return;
+        }
+        Cube *c = stageCursor->second;
 
         c->liveNeighbors = 0;
     }
 
+    stageInProgress = false;
     cycleStage++;
 }
 
 
 /**
  * GeneralizedCellularAutomaton.updateState()
- * Updates the state of each Cube in activeCubes.
+ * Updates the state of each Cube in activeCubes. New states are collected in
+ * pendingStates and applied together once every Cube has been visited, so a
+ * generation never appears half-applied, however many calls the pass takes.
  */
 void GeneralizedCellularAutomaton::updateState() {
-    // Reset state counts for record keeping
-    std::fill(stateCounts.begin(), stateCounts.end(), 0);
+    if(!stageInProgress) {
+        // Reset state counts for record keeping
+        std::fill(stateCounts.begin(), stateCounts.end(), 0);
+        pendingStates.clear();
 
-    // Iterate through Cubes and update their states
-    for (auto &activeCube : activeCubes) {
-        Cube *c = activeCube.second;
+        stageCursor = activeCubes.begin();
+        stageInProgress = true;
+    }
+    int counter = 0;
+
+    // Iterate through Cubes and compute their new states
+    for (; stageCursor != activeCubes.end(); ++stageCursor) {
+        if(outOfTime(counter)) {
+            return;
+        }
+        Cube *c = stageCursor->second;
         int oldState = c->state;
         int newState = ruleMatrixInt.at(oldState).at(c->liveNeighbors);
+        if (trackRuleUse && ruleFirstUse[oldState][c->liveNeighbors] < 0) {
+            ruleFirstUse[oldState][c->liveNeighbors] = generation;
+        }
         if (newState != oldState) {
-            setCube(c, newState);
+            pendingStates.emplace_back(c, newState);
         } else if (oldState == 0) {
             removeCubes.push_back(c->center);
         }
         stateCounts[newState]++;
     }
+
+    // Start this generation's change list, and apply the new states.
+    beginChanges();
+    for (auto &pending : pendingStates) {
+        setCube(pending.first, pending.second);
+    }
+
+    stageInProgress = false;
     cycleStage++;
 }
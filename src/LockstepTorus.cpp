@@ -0,0 +1,320 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "LockstepTorus.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "GeneralizedCellularAutomaton.h"
+
+/**
+ * sumAlongAxis()
+ * Adds each cell's value (in every lane) to those of its two neighbors along
+ * one axis of the torus.
+ * @param in: Values, as [cell][lane].
+ * @param out: Receives the sums, laid out the same way.
+ * @param size: Torus side length.
+ * @param stride: Distance between neighboring cells along the axis: 1 for z,
+ *                size for y, size^2 for x.
+ */
+static void sumAlongAxis(const uint8_t *in, uint8_t *out, int size, int stride) {
+    const int L = LockstepTorus::maxLanes;
+    int numCells = size * size * size;
+    // Cells 'stride' apart along the axis share everything but their
+    // coordinate on it, which wraps around every size * stride cells.
+    int span = size * stride;
+    for(int cell = 0; cell < numCells; ++cell) {
+        int offset = cell % span;
+        int base = cell - offset;
+        int prev = base + (offset - stride + span) % span;
+        int next = base + (offset + stride) % span;
+
+        const uint8_t *a = in + (size_t)prev * L;
+        const uint8_t *b = in + (size_t)cell * L;
+        const uint8_t *c = in + (size_t)next * L;
+        uint8_t *o = out + (size_t)cell * L;
+        for(int l = 0; l < L; ++l) {
+            o[l] = (uint8_t)(a[l] + b[l] + c[l]);
+        }
+    }
+}
+
+/**
+ * LockstepTorus.boxSum()
+ * Sums each cell's 3x3x3 neighborhood (itself included), in every lane. The
+ * sums are separable, so this takes three passes of two adds rather than one
+ * of 26.
+ * @param in: Values, as [cell][lane]. Each sum must fit in a byte.
+ * @param out: Receives the sums. Not in or scratch.
+ */
+void LockstepTorus::boxSum(const uint8_t *in, uint8_t *out) {
+    sumAlongAxis(in, out, size, 1);
+    sumAlongAxis(out, scratch.data(), size, size);
+    sumAlongAxis(scratch.data(), out, size, size * size);
+}
+
+/**
+ * LockstepTorus.clearLane()
+ * Empties a lane, and clears its rule.
+ * @param lane: The lane.
+ */
+void LockstepTorus::clearLane(int lane) {
+    size_t numCells = (size_t)size * size * size;
+    for(size_t cell = 0; cell < numCells; ++cell) {
+        states[cell * maxLanes + lane] = 0;
+        active[cell * maxLanes + lane] = 0;
+    }
+    std::fill(ruleTable.begin() + lane * maxStates * 27, ruleTable.begin() + (lane + 1) * maxStates * 27, 0);
+    std::fill(liveTable.begin() + lane * maxStates, liveTable.begin() + (lane + 1) * maxStates, 0);
+
+    numStates[lane] = 0;
+    seeds[lane] = -1;
+    stateCounts[lane].clear();
+    numActiveCells[lane] = 0;
+    configHash[lane] = 0;
+}
+
+/**
+ * LockstepTorus.cubeCube()
+ * Replaces a lane's cells with a random cube of them, exactly as
+ * GeneralizedCellularAutomaton.cubeCube() would place them around the origin.
+ * The lane's rule must already be set.
+ * @param lane: The lane.
+ * @param hwidth: Half-width of the cube. It must fit in the torus.
+ * @param ps: Cell state activation probabilities.
+ * @param seed: Random seed, or -1 to seed from the system clock.
+ */
+void LockstepTorus::cubeCube(int lane, int hwidth, const std::vector<float> &ps, long long seed) {
+    if(2 * hwidth + 1 > size) {
+        throw std::runtime_error("Initial cube of width " + std::to_string(2 * hwidth + 1)
+                                 + " doesn't fit in a torus of size " + std::to_string(size));
+    }
+    if((int)ps.size() >= maxStates) {
+        throw std::runtime_error("Too many initial states for the torus: " + std::to_string(ps.size()));
+    }
+
+    if(seed < 0) {
+        seed = std::chrono::system_clock::now().time_since_epoch().count() & 0xFFFFFFFF;
+    }
+
+    size_t numCells = (size_t)size * size * size;
+    for(size_t cell = 0; cell < numCells; ++cell) {
+        states[cell * maxLanes + lane] = 0;
+        active[cell * maxLanes + lane] = 0;
+    }
+    std::fill(stateCounts[lane].begin(), stateCounts[lane].end(), 0);
+    seeds[lane] = seed;
+    configHash[lane] = 0;
+
+    std::mt19937 gen(static_cast<unsigned int>(seed));
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    std::vector<float> ps_cdf;
+    float total = 0.f;
+    for(float p : ps) {
+        total += p;
+        ps_cdf.push_back(total);
+    }
+
+    // Same loop order as GeneralizedCellularAutomaton.cubeCube(), so the
+    // same seed draws the same cells.
+    int mask = size - 1;
+    for(int x = -hwidth; x <= hwidth; ++x) {
+        for(int y = -hwidth; y <= hwidth; ++y) {
+            for(int z = -hwidth; z <= hwidth; ++z) {
+                float v = u(gen);
+                for(int i = 0; i < (int)ps_cdf.size(); ++i) {
+                    if(v < ps_cdf[i]) {
+                        int state = i + 1;
+                        size_t cell = ((size_t)(x & mask) * size + (y & mask)) * size + (z & mask);
+                        states[cell * maxLanes + lane] = (uint8_t)state;
+                        configHash[lane] ^= Object::zobristKey(glm::ivec3(x, y, z), state);
+                        if(state < (int)stateCounts[lane].size()) {
+                            stateCounts[lane][state]++;
+                        }
+
+                        // Like the sparse automaton, start with the new cells'
+                        // neighborhoods active.
+                        for(int dx = -1; dx <= 1; ++dx) {
+                            for(int dy = -1; dy <= 1; ++dy) {
+                                for(int dz = -1; dz <= 1; ++dz) {
+                                    size_t neighbor = ((size_t)((x + dx) & mask) * size + ((y + dy) & mask)) * size
+                                            + ((z + dz) & mask);
+                                    active[neighbor * maxLanes + lane] = 1;
+                                }
+                            }
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    int numActive = 0;
+    for(size_t cell = 0; cell < numCells; ++cell) {
+        numActive += active[cell * maxLanes + lane];
+    }
+    numActiveCells[lane] = numActive;
+}
+
+/**
+ * LockstepTorus.init()
+ * Sets the torus size, and empties every lane.
+ * @param size_: Torus side length, a power of 2 of at least 4.
+ */
+void LockstepTorus::init(int size_) {
+    if(size_ < 4 || (size_ & (size_ - 1)) != 0) {
+        throw std::runtime_error("Torus size must be a power of 2 of at least 4: " + std::to_string(size_));
+    }
+    size = size_;
+
+    size_t numValues = (size_t)size * size * size * maxLanes;
+    states.assign(numValues, 0);
+    active.assign(numValues, 0);
+    live.assign(numValues, 0);
+    counts.assign(numValues, 0);
+    scratch.assign(numValues, 0);
+    ruleTable.assign(maxLanes * maxStates * 27, 0);
+    liveTable.assign(maxLanes * maxStates, 0);
+
+    numStates.assign(maxLanes, 0);
+    seeds.assign(maxLanes, -1);
+    stateCounts.assign(maxLanes, std::vector<int>());
+    numActiveCells.assign(maxLanes, 0);
+    configHash.assign(maxLanes, 0);
+}
+
+/**
+ * LockstepTorus.logical()
+ * Converts a torus coordinate to the logical coordinate the sparse automaton
+ * would use, with the origin at 0.
+ * @param i: Torus coordinate, in [0, size).
+ */
+int LockstepTorus::logical(int i) const {
+    return (i < size / 2) ? i : i - size;
+}
+
+/**
+ * LockstepTorus.setRule()
+ * Sets a lane's rule.
+ * @param lane: The lane.
+ * @param rule: The rule. At most maxStates states, and the dead state can't
+ *              be live.
+ */
+void LockstepTorus::setRule(int lane, const Rule &rule) {
+    int n = (int)rule.table.size();
+    if(n > maxStates) {
+        throw std::runtime_error("Too many states for the torus: " + std::to_string(n));
+    }
+    if(rule.liveStates.count(0) > 0) {
+        throw std::runtime_error("The torus can't run rules with a live dead state");
+    }
+
+    std::fill(ruleTable.begin() + lane * maxStates * 27, ruleTable.begin() + (lane + 1) * maxStates * 27, 0);
+    std::fill(liveTable.begin() + lane * maxStates, liveTable.begin() + (lane + 1) * maxStates, 0);
+    for(int s = 0; s < n; ++s) {
+        std::vector<int> row = GeneralizedCellularAutomaton::parseRuleRow(rule.table[s]);
+        for(int count = 0; count < 27; ++count) {
+            ruleTable[(lane * maxStates + s) * 27 + count] = (uint8_t)row[count];
+        }
+    }
+    for(int s : rule.liveStates) {
+        if(s < n) {
+            liveTable[lane * maxStates + s] = 1;
+        }
+    }
+
+    numStates[lane] = n;
+    stateCounts[lane].assign(n, 0);
+}
+
+/**
+ * LockstepTorus.step()
+ * Advances every lane by one generation, and updates their statistics.
+ */
+void LockstepTorus::step() {
+    const int L = maxLanes;
+    size_t numCells = (size_t)size * size * size;
+
+    // Count live neighbors.
+    for(size_t cell = 0; cell < numCells; ++cell) {
+        const uint8_t *s = &states[cell * L];
+        uint8_t *v = &live[cell * L];
+        for(int l = 0; l < L; ++l) {
+            v[l] = liveTable[l * maxStates + s[l]];
+        }
+    }
+    boxSum(live.data(), counts.data());
+
+    // Update the active cells. Inactive cells are dead, and stay that way.
+    // The live buffer is reused to flag the cells that changed.
+    int histogram[maxLanes * maxStates] = {};
+    uint64_t hashes[maxLanes] = {};
+    int mask = size - 1;
+    uint8_t *changed = live.data();
+    for(size_t cell = 0; cell < numCells; ++cell) {
+        uint8_t *s = &states[cell * L];
+        uint8_t *a = &active[cell * L];
+        uint8_t *n = &counts[cell * L];
+        uint8_t *v = &live[cell * L];
+
+        // Most cells of a small pattern are inactive in every lane.
+        uint64_t anyActive[L / 8];
+        memcpy(anyActive, a, L);
+        uint64_t any = 0;
+        for(int w = 0; w < L / 8; ++w) {
+            any |= anyActive[w];
+        }
+        if(any == 0) {
+            memset(changed + cell * L, 0, L);
+            continue;
+        }
+
+        for(int l = 0; l < L; ++l) {
+            int oldState = s[l];
+            if(!a[l]) {
+                changed[cell * L + l] = 0;
+                continue;
+            }
+            // The neighborhood sum includes the cell itself.
+            int newState = ruleTable[(l * maxStates + oldState) * 27 + n[l] - v[l]];
+            changed[cell * L + l] = (uint8_t)(newState != oldState);
+            histogram[l * maxStates + newState]++;
+            if(newState != oldState) {
+                int z = (int)(cell & mask);
+                int y = (int)((cell / size) & mask);
+                int x = (int)(cell / ((size_t)size * size));
+                glm::ivec3 center(logical(x), logical(y), logical(z));
+                hashes[l] ^= Object::zobristKey(center, oldState) ^ Object::zobristKey(center, newState);
+                s[l] = (uint8_t)newState;
+            }
+        }
+    }
+
+    // Next generation's active cells: the non-dead ones, and the
+    // neighborhoods of the ones that changed.
+    boxSum(changed, counts.data());
+    int numActive[maxLanes] = {};
+    for(size_t cell = 0; cell < numCells; ++cell) {
+        const uint8_t *s = &states[cell * L];
+        const uint8_t *n = &counts[cell * L];
+        uint8_t *a = &active[cell * L];
+        for(int l = 0; l < L; ++l) {
+            a[l] = (uint8_t)((s[l] != 0) | (n[l] != 0));
+            numActive[l] += a[l];
+        }
+    }
+
+    for(int l = 0; l < L; ++l) {
+        for(int s = 0; s < numStates[l]; ++s) {
+            stateCounts[l][s] = histogram[l * maxStates + s];
+        }
+        numActiveCells[l] = numActive[l];
+        configHash[l] ^= hashes[l];
+    }
+}
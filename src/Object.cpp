@@ -3,12 +3,37 @@
 //
 #include "Object.h"
 
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+/**
+ * Object.zobristKey()
+ * Pseudorandom 64-bit key for a Cube in a given state, used to build
+ * Object.configHash. Dead Cubes have key 0, so they never affect the hash.
+ * @param center: The Cube's logical coordinates.
+ * @param state: The Cube's state.
+ */
+uint64_t Object::zobristKey(const glm::ivec3 &center, int state) {
+    if(state == 0) {
+        return 0;
+    }
+    // splitmix64 finalizer over the packed coordinates and state.
+    uint64_t z = (uint64_t)(uint32_t)center.x;
+    z = z * 0x9E3779B97F4A7C15ULL + (uint64_t)(uint32_t)center.y;
+    z = z * 0x9E3779B97F4A7C15ULL + (uint64_t)(uint32_t)center.z;
+    z = z * 0x9E3779B97F4A7C15ULL + (uint64_t)(uint32_t)state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
 /**
  * Object()
  * Generic Object initialization.
  * @constructor
  */
-Object::Object() : io(IO::getInstance()) {}
+Object::Object() {}
 
 /**
  * ~Object()
@@ -27,26 +52,115 @@ Object::~Object() {}
 void Object::add(const int x, const int y, const int z) {
     auto center = glm::ivec3(x, y, z);
 
-    // If it's not empty, add a Cube from limbo.
-    if(!limbo.empty()) {
-        // Add the Cube if it's not already in activeCubes.
-        if(!findIn(activeCubes, center)) {
-            Cube *c = limbo.back();
+    // Add the Cube if it's not already in activeCubes.
+    if(!findIn(activeCubes, center)) {
+        Cube *c;
+        if(!limbo.empty()) {
+            // Take a Cube from limbo.
+            c = limbo.back();
             limbo.pop_back();
+        } else {
+            // Limbo is empty, create a new Cube.
+            c = new Cube();
+        }
 
-            // Set the Cube up.
-            c->setup(x, y, z);
+        // Set the Cube up.
+        c->setup(x, y, z);
 
-            // Add the Cube to activeCubes.
-            activeCubes.insert({center, c});
+        // Add the Cube to activeCubes.
+        activeCubes.insert({center, c});
+    }
+}
+
+/**
+ * Object.applyChangesToSnapshot()
+ * Applies the change list entries made since the last call to snapshotSlots,
+ * logging each slot that changed. Does nothing (but leave the slots to be
+ * rebuilt) while snapshots aren't being published.
+ */
+void Object::applyChangesToSnapshot() {
+    if(!publishSnapshots || snapshotChangesSeen > changes.size()) {
+        snapshotRebuild = true;
+    }
+    if(snapshotRebuild) {
+        snapshotChangesSeen = changes.size();
+        return;
+    }
 
+    for(size_t i = snapshotChangesSeen; i < changes.size(); ++i) {
+        const CubeChange &change = changes[i];
+        auto found = snapshotSlotOf.find(change.center);
+        int slot;
+        if(change.newState == 0) {
+            if(found == snapshotSlotOf.end()) {
+                continue;
+            }
+            // The Cube died, so free its slot.
+            slot = found->second;
+            snapshotSlots[slot].state = 0;
+            freeSnapshotSlots.push_back(slot);
+            snapshotSlotOf.erase(found);
         } else {
-            // Limbo is empty, create a new Cube.
-            Cube *c = new Cube();
-            c->setup(x, y, z);
-            activeCubes.insert({center, c});
+            if(found != snapshotSlotOf.end()) {
+                slot = found->second;
+            } else if(!freeSnapshotSlots.empty()) {
+                slot = freeSnapshotSlots.back();
+                freeSnapshotSlots.pop_back();
+                snapshotSlotOf.emplace(change.center, slot);
+            } else {
+                slot = (int)snapshotSlots.size();
+                snapshotSlots.emplace_back();
+                snapshotSlotOf.emplace(change.center, slot);
+            }
+            // If the Cube isn't drawn any more, a later change in the list
+            // kills it, so its texture doesn't matter.
+            auto drawn = drawCubes.find(change.center);
+            glm::ivec2 texBase = drawn == drawCubes.end() ? snapshotSlots[slot].texBase : drawn->second->texBase;
+            snapshotSlots[slot] = {change.center, change.newState, texBase};
         }
+        snapshotLog.push_back(slot);
+    }
+    snapshotChangesSeen = changes.size();
+}
+
+/**
+ * Object.beginChanges()
+ * Starts a generation's change list, once the last one's changes have gone
+ * into snapshotSlots.
+ */
+void Object::beginChanges() {
+    applyChangesToSnapshot();
+    changes.clear();
+    snapshotChangesSeen = 0;
+}
+
+/**
+ * Object.bounds()
+ * Finds the smallest box holding every non-dead Cube.
+ * @param lo: Set to the box's lowest corner.
+ * @param hi: Set to the box's highest corner (inclusive).
+ * @return True unless every Cube is dead, in which case lo and hi are
+ * untouched.
+ */
+bool Object::bounds(glm::ivec3 &lo, glm::ivec3 &hi) const {
+    if(drawCubes.empty()) {
+        return false;
+    }
+    lo = hi = drawCubes.begin()->first;
+    for(auto &entry : drawCubes) {
+        lo = glm::min(lo, entry.first);
+        hi = glm::max(hi, entry.first);
     }
+    return true;
+}
+
+/**
+ * Object.cancelFastForward()
+ * Cancels a fast-forward in progress. It stops at the end of the generation
+ * it's working on. Safe to call from any thread.
+ */
+void Object::cancelFastForward() {
+    fastForwardLeft = 0;
 }
 
 /**
@@ -78,6 +192,37 @@ bool Object::checkPoint(glm::vec3 &point) {
     return findIn(activeCubes, center);
 }
 
+/**
+ * Object.fastForward()
+ * Runs (numGenerations) generations as fast as possible, whether or not the
+ * Object is running, without publishing any RenderSnapshots until it's done.
+ * Only Objects with resumable updates support this; others ignore it.
+ * @param numGenerations: Number of generations to run.
+ */
+void Object::fastForward(int numGenerations) {
+    if(!resumableUpdates) {
+        return;
+    }
+    post([this, numGenerations] {
+        fastForwardTotal = numGenerations;
+        fastForwardLeft = numGenerations;
+    });
+}
+
+/**
+ * Object.fastForwardProgress()
+ * Returns the fraction of the current fast-forward that's done, or 1 if there
+ * isn't one running.
+ */
+float Object::fastForwardProgress() const {
+    int left = fastForwardLeft.load();
+    int total = fastForwardTotal.load();
+    if(left <= 0 || total <= 0) {
+        return 1.f;
+    }
+    return 1.f - (float)left / (float)total;
+}
+
 /**
  * Object.findIn
  * Checks whether a Cube with logical center (center) is contained in the hashmap
@@ -114,6 +259,20 @@ void Object::freeMemory() {
     drawCubes.clear();
     addCubes.clear();
     removeCubes.clear();
+    changes.clear();
+    snapshotChangesSeen = 0;
+    snapshotRebuild = true;
+    configHash = 0;
+}
+
+/**
+ * Object.getChanges()
+ * Returns a read-only view of the Cube state changes made by the most recent
+ * generation, followed by any changes (e.g. User edits) made since. The view
+ * is invalidated by the next update cycle.
+ */
+std::span<const CubeChange> Object::getChanges() const {
+    return {changes.data(), changes.size()};
 }
 
 /**
@@ -135,11 +294,208 @@ void Object::init(glm::vec3 origin_, float scale_, int initNumCubes_) {
 
     cycleStage = 0;
 
+    generation = 0;
+
+    stepStart = 0;
+
     active = false;
 
+    publishedGeneration = -1;
+
     reset();
 }
 
+/**
+ * Object.latestSnapshot()
+ * Returns the most recently published RenderSnapshot. Only call this from the
+ * rendering thread.
+ */
+const RenderSnapshot &Object::latestSnapshot() {
+    snapshots.update();
+    return snapshots.readBuffer();
+}
+
+/**
+ * Object.post()
+ * Queues a command to run at the start of the Object's next update. Anything
+ * that reads or modifies the Cubes from outside the update cycle (User edits,
+ * run state changes) goes through here, so it's safe whichever thread is
+ * running the simulation.
+ * @param command: The action to run.
+ */
+void Object::post(std::function<void()> command) {
+    commands.post(std::move(command));
+}
+
+/**
+ * Object.publishSnapshot()
+ * Brings snapshotSlots up to date from the change list and hands them to the
+ * renderer as a new RenderSnapshot, if anything changed since the last one. Snapshots are only taken between
+ * generations, or wherever the Object was stopped, so the renderer never sees
+ * a generation half-applied.
+ */
+void Object::publishSnapshot() {
+    if(!publishSnapshots || (!snapshotDirty && generation == publishedGeneration)) {
+        return;
+    }
+    // Rendering is suspended while fast-forwarding.
+    if(fastForwardLeft.load() > 0) {
+        return;
+    }
+    if(cycleStage != 0 && state != stop) {
+        return;
+    }
+
+    // Start over from drawCubes once most slots are free, and start a new
+    // log epoch once replaying the log would cost more than copying every
+    // slot.
+    applyChangesToSnapshot();
+    if(snapshotRebuild || freeSnapshotSlots.size() > snapshotSlotOf.size()) {
+        rebuildSnapshotSlots();
+    } else if(snapshotLog.size() > snapshotSlots.size()) {
+        snapshotLog.clear();
+        ++snapshotLogEpoch;
+    }
+
+    // The write buffer keeps its capacity between publishes, and only needs
+    // the slots changed since it was last written.
+    RenderSnapshot &snapshot = snapshots.writeBuffer();
+    snapshot.generation = generation;
+    snapshot.numActiveCubes = (int)activeCubes.size();
+    if(snapshot.logEpoch != snapshotLogEpoch) {
+        snapshot.cubes.assign(snapshotSlots.begin(), snapshotSlots.end());
+    } else {
+        snapshot.cubes.resize(snapshotSlots.size());
+        for(size_t i = snapshot.logPosition; i < snapshotLog.size(); ++i) {
+            int slot = snapshotLog[i];
+            snapshot.cubes[slot] = snapshotSlots[slot];
+        }
+    }
+    snapshot.logEpoch = snapshotLogEpoch;
+    snapshot.logPosition = snapshotLog.size();
+    snapshots.publish();
+
+    snapshotDirty = false;
+    publishedGeneration = generation;
+}
+
+/**
+ * parallelFor()
+ * Calls body(begin, end) on contiguous ranges covering [0, n), one per
+ * thread. Jobs too small to give each thread minPerThread items run on the
+ * calling thread alone.
+ * @param n: Number of items.
+ * @param minPerThread: Fewest items worth starting a thread for.
+ * @param numThreads: Most threads to use, or 0 for one per core.
+ * @param body: Work on a range of items.
+ */
+template<typename Body>
+static void parallelFor(size_t n, size_t minPerThread, int numThreads, Body body) {
+    if(numThreads <= 0) {
+        numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    size_t numRanges = std::min((size_t)numThreads, n / std::max(minPerThread, (size_t)1));
+    if(numRanges <= 1) {
+        body((size_t)0, n);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for(size_t r = 1; r < numRanges; ++r) {
+        threads.emplace_back(body, n * r / numRanges, n * (r + 1) / numRanges);
+    }
+    body((size_t)0, n / numRanges);
+    for(auto &thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Object.rasterize()
+ * Writes the states of the Cubes in a box into a dense, C-ordered array of
+ * shape (size.x, size.y, size.z): Cube (x, y, z) goes to
+ * out[((x - lo.x) * size.y + (y - lo.y)) * size.z + (z - lo.z)], and cells
+ * with no live Cube are 0. A box small next to the world is filled by looking
+ * each cell up; otherwise the box is cleared and the drawn Cubes scattered
+ * into it, so the cost is about that of a memset plus one pass over the
+ * Cubes. Both are split over threads. Reads the Cubes without locking, so
+ * call it between updates (headless, or from a posted command).
+ * @param lo: Lowest corner of the box.
+ * @param size: Size of the box along each axis.
+ * @param out: Array of size.x * size.y * size.z bytes to write into.
+ * @param numThreads: Most threads to use, or 0 for one per core.
+ */
+void Object::rasterize(const glm::ivec3 &lo, const glm::ivec3 &size, uint8_t *out, int numThreads) const {
+    if(size.x <= 0 || size.y <= 0 || size.z <= 0) {
+        return;
+    }
+    const size_t minPerThread = 1 << 15;
+    size_t slab = (size_t)size.y * size.z;
+    size_t volume = (size_t)size.x * slab;
+
+    if(volume * 4 < drawCubes.size()) {
+        parallelFor((size_t)size.x, minPerThread / slab + 1, numThreads, [&](size_t begin, size_t end) {
+            uint8_t *cell = out + begin * slab;
+            for(int x = lo.x + (int)begin; x < lo.x + (int)end; ++x) {
+                for(int y = lo.y; y < lo.y + size.y; ++y) {
+                    for(int z = lo.z; z < lo.z + size.z; ++z) {
+                        auto found = drawCubes.find(glm::ivec3(x, y, z));
+                        *cell++ = found == drawCubes.end() ? 0 : (uint8_t)found->second->state;
+                    }
+                }
+            }
+        });
+        return;
+    }
+
+    parallelFor(volume, minPerThread, numThreads, [&](size_t begin, size_t end) {
+        memset(out + begin, 0, end - begin);
+    });
+    parallelFor(drawCubes.bucket_count(), minPerThread, numThreads, [&](size_t begin, size_t end) {
+        for(size_t bucket = begin; bucket < end; ++bucket) {
+            for(auto entry = drawCubes.begin(bucket); entry != drawCubes.end(bucket); ++entry) {
+                glm::ivec3 p = entry->first - lo;
+                if((unsigned)p.x < (unsigned)size.x && (unsigned)p.y < (unsigned)size.y &&
+                   (unsigned)p.z < (unsigned)size.z) {
+                    out[(size_t)p.x * slab + (size_t)p.y * size.z + p.z] = (uint8_t)entry->second->state;
+                }
+            }
+        }
+    });
+}
+
+/**
+ * Object.rebuildSnapshotSlots()
+ * Refills snapshotSlots from drawCubes, with no free slots, and starts a new
+ * log epoch so every snapshot buffer is recopied.
+ */
+void Object::rebuildSnapshotSlots() {
+    snapshotSlots.clear();
+    snapshotSlotOf.clear();
+    freeSnapshotSlots.clear();
+    for(auto &drawCube : drawCubes) {
+        Cube *c = drawCube.second;
+        snapshotSlotOf.emplace(c->center, (int)snapshotSlots.size());
+        snapshotSlots.push_back({c->center, c->state, c->texBase});
+    }
+    snapshotLog.clear();
+    ++snapshotLogEpoch;
+    snapshotChangesSeen = changes.size();
+    snapshotRebuild = false;
+}
+
+/**
+ * Object.recordChange()
+ * Appends a Cube's state transition to the change list, and updates
+ * configHash.
+ * @param c: The Cube whose state just changed.
+ * @param oldState: The Cube's state before the change.
+ */
+void Object::recordChange(const Cube *c, int oldState) {
+    changes.push_back({c->center, oldState, c->state});
+    configHash ^= zobristKey(c->center, oldState) ^ zobristKey(c->center, c->state);
+    snapshotDirty = true;
+}
+
 /**
  * Object.remove()
  * Removes a Cube with center (center) from activeCubes, if it's there.
@@ -154,18 +510,76 @@ void Object::remove(glm::ivec3 &center) {
     }
 }
 
+/**
+ * Object.memoryUsage()
+ * Estimates the memory, in bytes, used by the Cubes in use and the structures
+ * tracking them. Cubes waiting in limbo aren't counted.
+ */
+size_t Object::memoryUsage() const {
+    // Each hashmap entry is a node holding the key/value pair and a next
+    // pointer (plus a cached hash), and each bucket is a pointer.
+    const size_t nodeOverhead = 2 * sizeof(void*);
+    size_t bytes = activeCubes.size() * (sizeof(Cube) + sizeof(cubeMap_t::value_type) + nodeOverhead);
+    bytes += drawCubes.size() * (sizeof(cubeMap_t::value_type) + nodeOverhead);
+    bytes += addCubes.size() * (sizeof(boolMap_t::value_type) + nodeOverhead);
+    bytes += (activeCubes.bucket_count() + drawCubes.bucket_count() + addCubes.bucket_count()) * sizeof(void*);
+    bytes += removeCubes.capacity() * sizeof(glm::ivec3);
+    bytes += changes.capacity() * sizeof(CubeChange);
+    bytes += snapshotSlots.capacity() * sizeof(SnapshotCube) + snapshotLog.capacity() * sizeof(int);
+    bytes += snapshotSlotOf.size() * (sizeof(intMap_t::value_type) + nodeOverhead);
+    bytes += snapshotSlotOf.bucket_count() * sizeof(void*) + freeSnapshotSlots.capacity() * sizeof(int);
+    return bytes;
+}
+
 /**
  * Object.reset()
- * Resets the Object.
+ * Resets the Object. Cubes in use go back to limbo, which is then topped up
+ * (or trimmed) to initNumCubes, so resetting doesn't reallocate the Cubes.
  */
 void Object::reset() {
-    freeMemory();
+    // Move all the Cubes back to limbo.
+    for(auto &activeCube : activeCubes) {
+        limbo.push_back(activeCube.second);
+    }
+    activeCubes.clear();
+    drawCubes.clear();
+    addCubes.clear();
+    removeCubes.clear();
+    changes.clear();
+    snapshotChangesSeen = 0;
+    snapshotRebuild = true;
+    configHash = 0;
 
-    // Reset cycleStage.
+    // Reset cycleStage and the generation counter.
     cycleStage = 0;
+    generation = 0;
+    snapshotDirty = true;
 
-    // Construct new Cubes.
-    for(int i = 0; i < initNumCubes; ++i) {
+    // Construct new Cubes, or free the extras left over from a large run.
+    while(limbo.size() < (size_t)initNumCubes) {
         limbo.push_back(new Cube());
     }
+    while(limbo.size() > (size_t)initNumCubes) {
+        delete limbo.back();
+        limbo.pop_back();
+    }
+}
+
+/**
+ * Object.setRunState()
+ * Posts a change to the Object's update state. Stepping only starts from the
+ * stop state, and runs one full update cycle from the current stage.
+ * @param newState: The state to change to.
+ */
+void Object::setRunState(ObjectState newState) {
+    post([this, newState] {
+        if(newState != step) {
+            state = newState;
+
+        } else if(state == stop) {
+            state = step;
+            // Record which stage of the update cycle the step starts on.
+            stepStart = cycleStage;
+        }
+    });
 }
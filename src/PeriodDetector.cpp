@@ -0,0 +1,112 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "PeriodDetector.h"
+
+#include <algorithm>
+
+/**
+ * PeriodDetector.clear()
+ * Forgets all samples and any detected period, and sizes the buffers for the
+ * current settings.
+ */
+void PeriodDetector::clear() {
+    ring.assign(window + maxPeriod + 1, 0);
+    diffSums.assign(maxPeriod + 1, 0);
+    numSamples = 0;
+    sum = 0;
+    sumSquares = 0;
+    candidate = 0;
+    candidateCount = 0;
+    candidateStart = 0;
+    period = 0;
+    onset = -1;
+}
+
+/**
+ * PeriodDetector.push()
+ * Adds a sample, and checks for a period.
+ * @param x: The new sample.
+ * @return true once a period has been detected.
+ */
+bool PeriodDetector::push(int64_t x) {
+    if(ring.empty()) {
+        clear();
+    }
+    if(period > 0) {
+        return true;
+    }
+
+    int t = numSamples;
+    ring[t % ring.size()] = x;
+    numSamples++;
+
+    // Slide the window: add the new sample's lagged differences, drop those
+    // of the sample leaving the window.
+    int u = t - window;
+    for(int lag = 1; lag <= maxPeriod; ++lag) {
+        if(t - lag >= 0) {
+            int64_t d = x - sample(t - lag);
+            diffSums[lag] += d * d;
+        }
+        if(u - lag >= 0) {
+            int64_t d = sample(u) - sample(u - lag);
+            diffSums[lag] -= d * d;
+        }
+    }
+    sum += x;
+    sumSquares += x * x;
+    if(u >= 0) {
+        sum -= sample(u);
+        sumSquares -= sample(u) * sample(u);
+    }
+
+    // Wait until every lag's sum covers the whole window.
+    if(numSamples < window + maxPeriod) {
+        return false;
+    }
+
+    double mean = (double)sum / window;
+    double variance = (double)sumSquares / window - mean * mean;
+    int found = 0;
+    if(variance > 1e-9) {
+        // Normalized so uncorrelated samples score about 1.
+        double norm = 2. * window * variance;
+        double largest = (double)diffSums[1] / norm;
+        for(int lag = 2; lag <= maxPeriod; ++lag) {
+            double nd = (double)diffSums[lag] / norm;
+            if(nd < threshold * largest) {
+                found = lag;
+                break;
+            }
+            largest = std::max(largest, nd);
+        }
+    }
+
+    if(found == 0) {
+        candidateCount = 0;
+    } else if(found == candidate && candidateCount > 0) {
+        candidateCount++;
+    } else {
+        candidate = found;
+        candidateCount = 1;
+        candidateStart = t;
+    }
+
+    if(candidateCount >= confirmations) {
+        period = candidate;
+        onset = std::max(0, candidateStart - window - period + 1);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * PeriodDetector.sample()
+ * Returns one of the buffered samples.
+ * @param i: Index of the sample, counting from the first pushed since the
+ *           last clear(). Must be one of the last window + maxPeriod + 1.
+ */
+int64_t PeriodDetector::sample(int i) const {
+    return ring[i % ring.size()];
+}
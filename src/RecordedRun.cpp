@@ -0,0 +1,48 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "RecordedRun.h"
+
+#include <algorithm>
+
+#include "GeneralizedCellularAutomaton.h"
+
+/**
+ * RecordedRun.divergence()
+ * Finds the first generation in which a run of another rule would differ from
+ * this one: the first use of a rule table entry the rules disagree on.
+ * @param other: The other rule.
+ * @return The generation, or -1 if the runs are identical. Rules with
+ *         different live states or numbers of states diverge at 0.
+ */
+int RecordedRun::divergence(const Rule &other) const {
+    if(other.liveStates != rule.liveStates || other.table.size() != rule.table.size()) {
+        return 0;
+    }
+
+    int first = -1;
+    for(size_t s = 0; s < rule.table.size(); ++s) {
+        if(other.table[s] == rule.table[s]) {
+            continue;
+        }
+        std::vector<int> row = GeneralizedCellularAutomaton::parseRuleRow(rule.table[s]);
+        std::vector<int> otherRow = GeneralizedCellularAutomaton::parseRuleRow(other.table[s]);
+        for(size_t n = 0; n < row.size(); ++n) {
+            int used = firstUse[s][n];
+            if(row[n] != otherRow[n] && used >= 0) {
+                first = first < 0 ? used : std::min(first, used);
+            }
+        }
+    }
+    return first;
+}
+
+/**
+ * RecordedRun.reusable()
+ * Checks whether the whole run can stand in for a run of another rule that
+ * never diverges from it. Runs cut short by a time or memory limit can't, as
+ * the other run may have got further.
+ */
+bool RecordedRun::reusable() const {
+    return !finalStats.empty() && endStatus != "timeout" && endStatus != "memoryLimit";
+}
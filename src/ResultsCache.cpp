@@ -0,0 +1,98 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "ResultsCache.h"
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+#include "utils.h"
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+/**
+ * ResultsCache.enabled()
+ * Checks whether the cache is in use.
+ */
+bool ResultsCache::enabled() const {
+    return !dir.empty();
+}
+
+/**
+ * ResultsCache.lookup()
+ * Looks up a run's statistics.
+ * @param key: Everything the run's results depend on.
+ * @param stats: Receives the statistics, on a hit.
+ * @return true on a hit.
+ */
+bool ResultsCache::lookup(const std::string &key, RunStats &stats) const {
+    std::ifstream inFile(pathFor(key), std::ios::binary);
+    if(!inFile.is_open()) {
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+
+    // A damaged entry is just a miss; it's overwritten once the run is done.
+    try {
+        json entry = json::from_cbor(data);
+        if(entry["key"] != key) {
+            return false;
+        }
+        std::vector<uint8_t> state = entry["stats"].get_binary();
+        stats.loadState(std::vector<char>(state.begin(), state.end()));
+    } catch(const json::exception &e) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * ResultsCache.pathFor()
+ * Returns the path of the file a key is stored in.
+ * @param key: The key.
+ */
+std::string ResultsCache::pathFor(const std::string &key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.cbor", (unsigned long long)stringHash(key));
+    return (fs::path(dir) / name).string();
+}
+
+/**
+ * ResultsCache.store()
+ * Stores a finished run's statistics. The file is written under a temporary
+ * name and then renamed, so concurrent lookups never see a partial entry.
+ * @param key: Everything the run's results depend on.
+ * @param stats: The run's statistics.
+ */
+void ResultsCache::store(const std::string &key, const RunStats &stats) const {
+    std::vector<char> state = stats.saveState();
+    json entry;
+    entry["key"] = key;
+    entry["stats"] = json::binary(std::vector<uint8_t>(state.begin(), state.end()));
+    std::vector<char> data;
+    json::to_cbor(entry, data);
+
+    fs::create_directories(dir);
+    std::string path = pathFor(key);
+
+    // Workers can store at the same time, so give each temporary file its
+    // own name.
+    static std::atomic<unsigned> counter{0};
+    size_t threadHash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    std::string tempPath = path + ".tmp" + std::to_string(threadHash) + "-" + std::to_string(counter.fetch_add(1));
+    {
+        std::ofstream outFile(tempPath, std::ios::binary);
+        if(!outFile.is_open()) {
+            throw std::runtime_error("Failed to open file for writing: " + tempPath);
+        }
+        outFile.write(data.data(), (std::streamsize)data.size());
+    }
+    fs::rename(tempPath, path);
+}
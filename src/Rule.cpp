@@ -4,6 +4,8 @@
 #include "Rule.h"
 
 #include <fstream>
+#include "GeneralizedCellularAutomaton.h"
+#include "utils.h"
 #include "nlohmann/json.hpp"
 
 using json = nlohmann::json;
@@ -96,6 +98,57 @@ Rule generateRule(
 }
 
 
+/**
+ * Read a Rule from parsed JSON, as stored in rule files
+ *
+ * @param jsonData The rule's JSON object
+ * @return Rule struct containing the parsed rule
+ * @throws std::runtime_error if the table or live states are missing or
+ *         malformed
+ */
+static Rule ruleFromJson(const json& jsonData) {
+    Rule rule;
+
+    // Parse the table
+    if (jsonData.contains("table") && jsonData["table"].is_array()) {
+        auto& tableJson = jsonData["table"];
+        rule.table.resize(tableJson.size());
+
+        for (size_t i = 0; i < tableJson.size(); ++i) {
+            auto& row = tableJson[i];
+            if (!row.is_array()) {
+                throw std::runtime_error("Table row is not an array at index " + std::to_string(i));
+            }
+
+            rule.table[i].resize(row.size());
+            for (size_t j = 0; j < row.size(); ++j) {
+                if (!row[j].is_string()) {
+                    throw std::runtime_error("Table element is not a string at [" +
+                                             std::to_string(i) + "][" + std::to_string(j) + "]");
+                }
+                rule.table[i][j] = row[j];
+            }
+        }
+    } else {
+        throw std::runtime_error("JSON is missing 'table' array");
+    }
+
+    // Parse live states
+    if (jsonData.contains("live_states") && jsonData["live_states"].is_array()) {
+        auto& liveStatesJson = jsonData["live_states"];
+        for (const auto& state : liveStatesJson) {
+            if (!state.is_number_integer()) {
+                throw std::runtime_error("Live state is not an integer");
+            }
+            rule.liveStates.insert(state.get<int>());
+        }
+    } else {
+        throw std::runtime_error("JSON is missing 'live_states' array");
+    }
+
+    return rule;
+}
+
 /**
  * Parse a JSON rule file and return a Rule struct
  *
@@ -104,9 +157,6 @@ Rule generateRule(
  * @throws std::runtime_error if file cannot be opened or JSON is invalid
  */
 Rule parseRuleFromJson(const std::string& filePath) {
-    // Result rule
-    Rule rule;
-
     try {
         // Open the file
         std::ifstream file(filePath);
@@ -117,49 +167,277 @@ Rule parseRuleFromJson(const std::string& filePath) {
         // Parse JSON
         json jsonData;
         file >> jsonData;
+        return ruleFromJson(jsonData);
+
+    } catch (const json::parse_error& e) {
+        throw std::runtime_error("JSON parse error: " + std::string(e.what()));
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Error parsing rule: " + std::string(e.what()));
+    }
+}
 
-        // Parse the table
-        if (jsonData.contains("table") && jsonData["table"].is_array()) {
-            auto& tableJson = jsonData["table"];
-            rule.table.resize(tableJson.size());
+/**
+ * Parse a rule from JSON text, in the rule file format
+ *
+ * @param text The rule's JSON
+ * @return Rule struct containing the parsed rule
+ * @throws std::runtime_error if the JSON is invalid
+ */
+Rule parseRuleFromJsonText(const std::string& text) {
+    try {
+        return ruleFromJson(json::parse(text));
 
-            for (size_t i = 0; i < tableJson.size(); ++i) {
-                auto& row = tableJson[i];
-                if (!row.is_array()) {
-                    throw std::runtime_error("Table row is not an array at index " + std::to_string(i));
-                }
+    } catch (const json::parse_error& e) {
+        throw std::runtime_error("JSON parse error: " + std::string(e.what()));
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Error parsing rule: " + std::string(e.what()));
+    }
+}
 
-                rule.table[i].resize(row.size());
-                for (size_t j = 0; j < row.size(); ++j) {
-                    if (!row[j].is_string()) {
-                        throw std::runtime_error("Table element is not a string at [" +
-                                                 std::to_string(i) + "][" + std::to_string(j) + "]");
-                    }
-                    rule.table[i][j] = row[j];
-                }
+/**
+ * Save a Rule to a JSON rule file, in the format parseRuleFromJson() and
+ * python/generate_rule.py use
+ *
+ * @param rule Rule to save
+ * @param filePath Path of the file to write
+ * @param params Extra numbers to store with the rule, e.g. how it was made
+ * @throws std::runtime_error if the file cannot be written
+ */
+void saveRuleToJson(const Rule& rule, const std::string& filePath, const std::map<std::string, double>& params) {
+    json data;
+    data["table"] = rule.table;
+    data["live_states"] = rule.liveStates;
+    data["params"] = params;
+
+    std::ofstream file(filePath);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file for writing: " + filePath);
+    }
+    file << data.dump(2);
+}
+
+/**
+ * Put a rule in canonical form, so that rules that are bound to run
+ * identically from the same initial conditions compare equal.
+ *
+ * Two things are normalized:
+ *   - States that can't be reached from the dead state or the states the
+ *     initial conditions use are dropped, rows and all.
+ *   - The remaining states the initial conditions don't use are relabelled,
+ *     choosing the labelling with the lexicographically smallest table. The
+ *     dead state and the seeded states keep their labels, since relabelling
+ *     them would change the initial conditions.
+ * Trying every labelling is only affordable for a handful of states, so with
+ * more than maxPermutedStates free states, they're ordered by a cheap
+ * signature instead. That still never merges rules that differ, but may miss
+ * some that don't.
+ *
+ * @param rule Rule to canonicalize
+ * @param numSeededStates Number of non-dead states the initial conditions use
+ *                        (states 1 ... numSeededStates)
+ * @return The canonical form
+ */
+CanonicalRule canonicalizeRule(const Rule& rule, int numSeededStates) {
+    const int maxPermutedStates = 8;
+    const int numStates = (int)rule.table.size();
+
+    std::vector<std::vector<int>> rows;
+    rows.reserve(numStates);
+    for (const auto& row : rule.table) {
+        rows.push_back(GeneralizedCellularAutomaton::parseRuleRow(row));
+    }
+
+    /* -------- reachable states ---------------------------------------- */
+    std::vector<bool> reachable(numStates, false);
+    std::vector<int> frontier;
+    for (int s = 0; s <= std::min(numSeededStates, numStates - 1); ++s) {
+        reachable[s] = true;
+        frontier.push_back(s);
+    }
+    while (!frontier.empty()) {
+        int s = frontier.back();
+        frontier.pop_back();
+        for (int next : rows[s]) {
+            if (next >= 0 && next < numStates && !reachable[next]) {
+                reachable[next] = true;
+                frontier.push_back(next);
             }
-        } else {
-            throw std::runtime_error("JSON is missing 'table' array");
         }
+    }
 
-        // Parse live states
-        if (jsonData.contains("live_states") && jsonData["live_states"].is_array()) {
-            auto& liveStatesJson = jsonData["live_states"];
-            for (const auto& state : liveStatesJson) {
-                if (!state.is_number_integer()) {
-                    throw std::runtime_error("Live state is not an integer");
-                }
-                rule.liveStates.insert(state.get<int>());
+    std::vector<int> fixedStates, freeStates;
+    for (int s = 0; s < numStates; ++s) {
+        if (!reachable[s]) continue;
+        (s <= numSeededStates ? fixedStates : freeStates).push_back(s);
+    }
+
+    /* -------- table under a labelling --------------------------------- */
+    // `order` lists the kept states, by new label. The table is flattened,
+    // followed by the live flag of each state.
+    std::vector<int> stateMap(numStates, -1);
+    auto relabel = [&](const std::vector<int>& order) -> std::vector<int> {
+        std::fill(stateMap.begin(), stateMap.end(), -1);
+        for (size_t i = 0; i < order.size(); ++i) stateMap[order[i]] = (int)i;
+
+        std::vector<int> flat;
+        for (int s : order) {
+            for (int next : rows[s]) {
+                flat.push_back(next >= 0 && next < numStates ? stateMap[next] : -1);
             }
-        } else {
-            throw std::runtime_error("JSON is missing 'live_states' array");
         }
+        for (int s : order) {
+            flat.push_back(rule.liveStates.count(s) ? 1 : 0);
+        }
+        return flat;
+    };
 
-    } catch (const json::parse_error& e) {
-        throw std::runtime_error("JSON parse error: " + std::string(e.what()));
-    } catch (const std::exception& e) {
-        throw std::runtime_error("Error parsing rule: " + std::string(e.what()));
+    if ((int)freeStates.size() > maxPermutedStates) {
+        // Order by a signature that doesn't depend on the labels: how many
+        // neighbor counts lead to each kept state, and liveness.
+        auto signature = [&](int s) {
+            std::vector<int> sig(1, rule.liveStates.count(s) ? 1 : 0);
+            for (int t : fixedStates) {
+                sig.push_back((int)std::count(rows[s].begin(), rows[s].end(), t));
+            }
+            std::vector<int> toFree;
+            for (int t : freeStates) {
+                toFree.push_back((int)std::count(rows[s].begin(), rows[s].end(), t));
+            }
+            std::sort(toFree.begin(), toFree.end());
+            sig.insert(sig.end(), toFree.begin(), toFree.end());
+            return sig;
+        };
+        std::stable_sort(freeStates.begin(), freeStates.end(),
+                         [&](int a, int b) { return signature(a) < signature(b); });
     }
 
-    return rule;
-}
\ No newline at end of file
+    std::vector<int> order = fixedStates;
+    order.insert(order.end(), freeStates.begin(), freeStates.end());
+    std::vector<int> best = relabel(order);
+    std::vector<int> bestOrder = order;
+    if ((int)freeStates.size() <= maxPermutedStates) {
+        std::sort(freeStates.begin(), freeStates.end());
+        do {
+            std::copy(freeStates.begin(), freeStates.end(), order.begin() + (long)fixedStates.size());
+            std::vector<int> flat = relabel(order);
+            if (flat < best) {
+                best = std::move(flat);
+                bestOrder = order;
+            }
+        } while (std::next_permutation(freeStates.begin(), freeStates.end()));
+    }
+
+    /* -------- canonical form ------------------------------------------ */
+    CanonicalRule canonical;
+    relabel(bestOrder);
+    canonical.stateMap = stateMap;
+    const int numKept = (int)bestOrder.size();
+    const int rowSize = best.empty() ? 0 : (int)(best.size() / numKept) - 1;
+    std::string key = std::to_string(numKept) + ":";
+    for (int i = 0; i < numKept; ++i) {
+        canonical.table.emplace_back(best.begin() + i * rowSize, best.begin() + (i + 1) * rowSize);
+        if (best[numKept * rowSize + i]) canonical.liveStates.insert(i);
+
+        for (int j = 0; j < rowSize; ++j) {
+            key += std::to_string(canonical.table[i][j]);
+            key += (j + 1 < rowSize) ? ',' : '/';
+        }
+    }
+    key += "live";
+    for (int s : canonical.liveStates) {
+        key += ',';
+        key += std::to_string(s);
+    }
+    canonical.key = key;
+
+    canonical.hash = stringHash(key);
+
+    return canonical;
+}
+
+/**
+ * Make a random small change to a rule: either move one live neighbor count
+ * of one state's row to a different next state, or toggle whether one
+ * non-dead state is live (never leaving no live states)
+ *
+ * @param rule Rule to change
+ * @param liveToggleRate Chance of toggling a live state instead of moving a
+ *                       count
+ * @param rng Random number generator
+ * @param description If not null, receives a short description of the
+ *                    change, e.g. "2:13 1->4" (state 2's count 13 moved
+ *                    from next state 1 to 4) or "live 3 off"
+ * @return The changed rule
+ */
+Rule mutateRule(const Rule& rule, double liveToggleRate, std::mt19937& rng, std::string* description) {
+    const int numStates = (int)rule.table.size();
+    Rule mutant = rule;
+
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    if (numStates > 1 && uniform(rng) < liveToggleRate) {
+        std::uniform_int_distribution<int> pickState(1, numStates - 1);
+        int state = pickState(rng);
+        bool live = mutant.liveStates.count(state) > 0;
+        if (!live || mutant.liveStates.size() > 1) {
+            if (live) {
+                mutant.liveStates.erase(state);
+            } else {
+                mutant.liveStates.insert(state);
+            }
+            if (description) {
+                *description = "live " + std::to_string(state) + (live ? " off" : " on");
+            }
+            return mutant;
+        }
+        // The only live state: move a count instead.
+    }
+
+    std::uniform_int_distribution<int> pickState(0, numStates - 1);
+    int state = pickState(rng);
+    std::vector<int> row = GeneralizedCellularAutomaton::parseRuleRow(rule.table[state]);
+    std::uniform_int_distribution<int> pickCount(0, (int)row.size() - 1);
+    int count = pickCount(rng);
+    int from = row[count];
+    std::uniform_int_distribution<int> pickOther(0, numStates - 2);
+    int to = pickOther(rng);
+    if (to >= from) {
+        ++to;
+    }
+    row[count] = to;
+    mutant.table[state] = formatRuleRow(row, numStates);
+
+    if (description) {
+        *description = std::to_string(state) + ":" + std::to_string(count) + " "
+                + std::to_string(from) + "->" + std::to_string(to);
+    }
+    return mutant;
+}
+
+/**
+ * Write a rule table row in the external representation, from its internal
+ * one (see GeneralizedCellularAutomaton::parseRuleRow())
+ *
+ * @param row Next state for each live neighbor count
+ * @param numStates Number of states
+ * @return One entry per next state: its counts, comma-separated, "A" if it
+ *         takes every count, or "-" if none
+ */
+std::vector<std::string> formatRuleRow(const std::vector<int>& row, int numStates) {
+    std::vector<std::string> rowExt(numStates);
+    for (int next = 0; next < numStates; ++next) {
+        std::string entry;
+        int numCounts = 0;
+        for (size_t n = 0; n < row.size(); ++n) {
+            if (row[n] == next) {
+                if (!entry.empty()) entry += ',';
+                entry += std::to_string(n);
+                ++numCounts;
+            }
+        }
+        if (numCounts == (int)row.size()) {
+            entry = "A";
+        }
+        rowExt[next] = entry.empty() ? "-" : entry;
+    }
+    return rowExt;
+}
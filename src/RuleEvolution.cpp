@@ -0,0 +1,274 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "RuleEvolution.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <unordered_set>
+
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+namespace fs = std::filesystem;
+
+/**
+ * RuleEvolution.work()
+ * Worker thread body: runs children until none are left, each from its
+ * parent's RecordedRun if it has a parent.
+ */
+void RuleEvolution::work() {
+    GeneralizedCellularAutomaton gol;
+    gol.init(glm::vec3(0, 0, 0), 0.5, options.initNumCubes);
+    RunStats stats;
+
+    size_t i;
+    while((i = nextChild.fetch_add(1)) < children.size()) {
+        Individual &child = children[i];
+        const RecordedRun *parentRun = child.parentIndex >= 0 ? &parents[child.parentIndex].record : nullptr;
+        try {
+            child.record.checkpointEvery = checkpointEvery;
+            child.startGeneration = BatchRunner::runRuleRecorded(gol, child.rule, stats, options,
+                                                                 child.record, parentRun);
+            RuleScore score = options.valueFunction.evaluate(stats);
+            child.ruleString = gol.ruleString;
+            child.endStatus = stats.endStatus;
+            child.value = score.value;
+            child.scored = score.hasLosses;
+        } catch(const std::exception &e) {
+            child.failed = true;
+            ++numFailed;
+            std::lock_guard<std::mutex> lock(printMutex);
+            printf("Rule %zu: %s\n", child.id, e.what());
+            continue;
+        }
+        ++numRun;
+        if(child.startGeneration < 0) {
+            ++numReused;
+        }
+    }
+}
+
+/**
+ * RuleEvolution.evaluate()
+ * Runs the current generation's children, spread over the workers.
+ */
+void RuleEvolution::evaluate() {
+    int numWorkers = options.numWorkers;
+    if(numWorkers <= 0) {
+        numWorkers = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    numWorkers = (int)std::min((size_t)numWorkers, children.size());
+
+    nextChild = 0;
+    std::vector<std::thread> workers;
+    for(int i = 0; i < numWorkers; ++i) {
+        workers.emplace_back(&RuleEvolution::work, this);
+    }
+    for(auto &worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * RuleEvolution.select()
+ * Replaces the parents with the numParents best of the parents and children,
+ * by value (rules whose runs were too short to score last). Ties go to the
+ * newer rule, so the search can drift across the plateaus of the value
+ * function (e.g. every run ending before its first 5% scores the same)
+ * instead of stalling on the first rules found.
+ */
+void RuleEvolution::select() {
+    std::vector<Individual> pool = std::move(parents);
+    for(auto &child : children) {
+        if(!child.failed) {
+            pool.push_back(std::move(child));
+        }
+    }
+    children.clear();
+
+    std::sort(pool.begin(), pool.end(), [](const Individual &a, const Individual &b) {
+        if(a.scored != b.scored) {
+            return a.scored;
+        }
+        if(a.value != b.value) {
+            return a.value > b.value;
+        }
+        return a.id > b.id;
+    });
+    if((int)pool.size() > numParents) {
+        pool.resize(numParents);
+    }
+    parents = std::move(pool);
+}
+
+/**
+ * RuleEvolution.writeBest()
+ * Writes the final parents as best/rank_<rank>.json, and ranking.json, which
+ * lists them with their lineage: every ancestor's id and mutation, from the
+ * first generation on.
+ */
+void RuleEvolution::writeBest() const {
+    fs::path bestDir = fs::path(outDir) / "best";
+    if(fs::exists(bestDir)) {
+        for(const auto &entry : fs::directory_iterator(bestDir)) {
+            if(entry.path().filename().string().rfind("rank_", 0) == 0) {
+                fs::remove(entry.path());
+            }
+        }
+    }
+    fs::create_directories(bestDir);
+
+    json ranking = json::array();
+    for(size_t rank = 0; rank < parents.size(); ++rank) {
+        const Individual &parent = parents[rank];
+        char name[32];
+        snprintf(name, sizeof(name), "rank_%04zu.json", rank);
+        saveRuleToJson(parent.rule, (bestDir / name).string(),
+                       {{"seed", (double)options.seed},
+                        {"id", (double)parent.id},
+                        {"generation", (double)parent.generation},
+                        {"value", parent.value}});
+
+        json lineage = json::array();
+        for(long long id = (long long)parent.id; id >= 0; id = history[id].first) {
+            lineage.push_back({{"id", id}, {"mutation", history[id].second}});
+        }
+        std::reverse(lineage.begin(), lineage.end());
+
+        ranking.push_back({
+            {"rank", rank},
+            {"file", (fs::path("best") / name).string()},
+            {"id", parent.id},
+            {"generation", parent.generation},
+            {"rule_string", parent.ruleString},
+            {"end_status", parent.endStatus},
+            {"value", parent.value},
+            {"lineage", lineage}
+        });
+    }
+
+    std::ofstream file((fs::path(outDir) / "ranking.json").string());
+    if(!file) {
+        throw std::runtime_error("Could not write ranking to " + outDir);
+    }
+    file << ranking.dump(2);
+}
+
+/**
+ * RuleEvolution.run()
+ * Runs the search: a first generation of the initial rules and random ones,
+ * then numGenerations generations of children of the current parents.
+ * Mutants that canonicalize the same as a rule already run are made again.
+ */
+void RuleEvolution::run() {
+    if(populationSize < 1 || numParents < 1) {
+        throw std::runtime_error("Evolution needs a population and parents");
+    }
+    if(outDir.empty()) {
+        throw std::runtime_error("No output directory for the evolution");
+    }
+    fs::create_directories(outDir);
+    if(options.seed < 0) {
+        options.seed = std::chrono::system_clock::now().time_since_epoch().count() & 0xFFFFFFFF;
+    }
+
+    std::string lineageFile = (fs::path(outDir) / "lineage.tsv").string();
+    FILE *lineage = fopen(lineageFile.c_str(), "w");
+    if(!lineage) {
+        throw std::runtime_error("Could not open " + lineageFile);
+    }
+    fprintf(lineage, "id\tparent\tgeneration\tvalue\tendStatus\tstartGeneration\tmutation\truleString\n");
+
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+
+    const int numDims = 3;
+    const int maxTries = 100;
+    std::mt19937 rng((uint32_t)options.seed);
+    int numSeededStates = (int)options.cubeCubeProbs.size();
+    std::unordered_set<uint64_t> seen;
+
+    auto addChild = [&](Rule &&rule, int generation, int parentIndex, std::string &&mutation) {
+        Individual child;
+        child.id = history.size();
+        child.generation = generation;
+        child.parentIndex = parentIndex;
+        if(parentIndex >= 0) {
+            child.parentId = (long long)parents[parentIndex].id;
+        }
+        child.mutation = std::move(mutation);
+        child.rule = std::move(rule);
+        history.emplace_back(child.parentId, child.mutation);
+        children.push_back(std::move(child));
+    };
+
+    for(int generation = 0; generation <= numGenerations; ++generation) {
+        if(generation == 0) {
+            for(const Rule &rule : initialRules) {
+                seen.insert(canonicalizeRule(rule, numSeededStates).hash);
+                addChild(Rule(rule), generation, -1, "initial");
+            }
+            for(int tries = 0; (int)children.size() < populationSize && tries < maxTries * populationSize; ++tries) {
+                Rule rule = generateRule(numDims, numStates, searchLiveRate, searchSparseRate, rng);
+                if(seen.insert(canonicalizeRule(rule, numSeededStates).hash).second) {
+                    addChild(std::move(rule), generation, -1, "random");
+                }
+            }
+        } else {
+            std::uniform_int_distribution<int> pickParent(0, (int)parents.size() - 1);
+            for(int k = 0; k < populationSize; ++k) {
+                int parentIndex = pickParent(rng);
+                std::string mutation;
+                for(int tries = 0; tries < maxTries; ++tries) {
+                    Rule rule = mutateRule(parents[parentIndex].rule, liveToggleRate, rng, &mutation);
+                    if(seen.insert(canonicalizeRule(rule, numSeededStates).hash).second) {
+                        addChild(std::move(rule), generation, parentIndex, std::move(mutation));
+                        break;
+                    }
+                }
+            }
+        }
+        if(children.empty()) {
+            printf("Generation %i: no new rules to run\n", generation);
+            break;
+        }
+
+        int reusedBefore = numReused.load();
+        evaluate();
+
+        size_t numChildren = children.size();
+        for(const auto &child : children) {
+            if(child.failed) {
+                continue;
+            }
+            fprintf(lineage, "%zu\t%lli\t%i\t%g\t%s\t%i\t%s\t%s\n", child.id, child.parentId, child.generation,
+                    child.value, child.endStatus.c_str(), child.startGeneration, child.mutation.c_str(),
+                    child.ruleString.c_str());
+        }
+        fflush(lineage);
+
+        select();
+        if(parents.empty()) {
+            fclose(lineage);
+            throw std::runtime_error("Every rule in the first generation failed");
+        }
+        const Individual &best = parents.front();
+        printf("Generation %i: ran %zu rules (%i reused from their parents), best %zu, value %g (%s)\n",
+               generation, numChildren, numReused.load() - reusedBefore, best.id, best.value,
+               best.endStatus.c_str());
+    }
+    fclose(lineage);
+
+    writeBest();
+
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+    printf("Evolved with seed %lli: ran %i rules (%i reused from their parents, %i failed) in %.1f s\n",
+           options.seed, numRun.load(), numReused.load(), numFailed.load(), seconds);
+}
@@ -0,0 +1,272 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "RuleSearch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+
+#include "BloomFilter.h"
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+namespace fs = std::filesystem;
+
+// Ranking of search results: higher value first, then earlier rules.
+static bool better(const SearchResult &a, const SearchResult &b) {
+    if(a.value != b.value) {
+        return a.value > b.value;
+    }
+    return a.index < b.index;
+}
+
+/**
+ * RuleSearch.generate()
+ * Generator stage: makes random rules until numRules new ones have been
+ * queued (or too many attempts have been repeats or prefiltered), then closes
+ * the queue. Repeats are detected by canonical rule, so relabelled copies of
+ * a rule are skipped too. Rules are made and predicted in blocks of
+ * RuleValueModel::blockSize.
+ * @param candidates: Queue to the simulation workers.
+ */
+void RuleSearch::generate(BoundedQueue<Candidate> &candidates) {
+    const int numDims = 3;
+    const size_t maxAttempts = 100 * numRules + 1000;
+
+    std::mt19937 rng((uint32_t)options.seed);
+    BloomFilter seen(2 * numRules + 1024, 1e-4);
+    int numSeededStates = (int)options.cubeCubeProbs.size();
+
+    std::vector<Rule> block;
+    std::vector<float> values;
+    std::vector<bool> predicted;
+    size_t numQueued = 0;
+    size_t attempts = 0;
+    while(numQueued < numRules && attempts < maxAttempts) {
+        block.clear();
+        while(block.size() < (size_t)RuleValueModel::blockSize && attempts < maxAttempts) {
+            ++attempts;
+            Rule rule = generateRule(numDims, numStates, searchLiveRate, searchSparseRate, rng);
+            ++numGenerated;
+            if(seen.insert(canonicalizeRule(rule, numSeededStates).hash)) {
+                ++numDuplicates;
+                continue;
+            }
+            block.push_back(std::move(rule));
+        }
+
+        if(options.valueModel.loaded()) {
+            options.valueModel.predict(block, values, predicted);
+        } else {
+            values.assign(block.size(), 0.f);
+            predicted.assign(block.size(), false);
+        }
+        for(size_t r = 0; r < block.size() && numQueued < numRules; ++r) {
+            if(predicted[r] && values[r] < options.minPredictedValue) {
+                ++numPrefiltered;
+                continue;
+            }
+            if(!candidates.push({numQueued, std::move(block[r])})) {
+                return;
+            }
+            ++numQueued;
+        }
+    }
+    candidates.close();
+}
+
+/**
+ * RuleSearch.simulate()
+ * Simulation stage: runs queued rules until the queue is closed and empty.
+ * @param candidates: Queue from the generator.
+ * @param results: Queue to the ranking stage.
+ */
+void RuleSearch::simulate(BoundedQueue<Candidate> &candidates, BoundedQueue<SearchResult> &results) {
+    GeneralizedCellularAutomaton gol;
+    gol.init(glm::vec3(0, 0, 0), 0.5, options.initNumCubes);
+    RunStats stats;
+
+    Candidate candidate;
+    while(candidates.pop(candidate)) {
+        SearchResult result;
+        try {
+            result.cached = BatchRunner::runRuleCached(gol, candidate.rule, stats, options);
+            result.value = options.valueFunction.evaluate(stats).value;
+        } catch(const std::exception &e) {
+            printf("Rule %zu: %s\n", candidate.index, e.what());
+            ++numFailed;
+            continue;
+        }
+        result.index = candidate.index;
+        result.rule = std::move(candidate.rule);
+        result.ruleString = gol.ruleString;
+        result.endStatus = stats.endStatus;
+        result.period = stats.period;
+        result.lastTimeStep = stats.timeStepLog.empty() ? 0 : stats.timeStepLog.back();
+        ++numSimulated;
+        results.push(std::move(result));
+    }
+}
+
+/**
+ * RuleSearch.writeTop()
+ * Writes the best rules, as top/rank_<rank>.json, and their ranking, as
+ * ranking.json. Rule files left from an earlier search are removed first.
+ * @param top: The best results, best first.
+ */
+void RuleSearch::writeTop(std::vector<SearchResult> &top) const {
+    fs::path topDir = fs::path(outDir) / "top";
+    if(fs::exists(topDir)) {
+        for(const auto &entry : fs::directory_iterator(topDir)) {
+            if(entry.path().filename().string().rfind("rank_", 0) == 0) {
+                fs::remove(entry.path());
+            }
+        }
+    }
+    fs::create_directories(topDir);
+
+    json ranking = json::array();
+    for(size_t rank = 0; rank < top.size(); ++rank) {
+        const SearchResult &result = top[rank];
+        char name[32];
+        snprintf(name, sizeof(name), "rank_%04zu.json", rank);
+        saveRuleToJson(result.rule, (topDir / name).string(),
+                       {{"seed", (double)options.seed},
+                        {"index", (double)result.index},
+                        {"value", result.value},
+                        {"period", (double)result.period},
+                        {"lastTimeStep", (double)result.lastTimeStep}});
+
+        ranking.push_back({
+            {"rank", rank},
+            {"file", (fs::path("top") / name).string()},
+            {"index", result.index},
+            {"rule_string", result.ruleString},
+            {"end_status", result.endStatus},
+            {"value", result.value},
+            {"period", result.period}
+        });
+    }
+
+    std::ofstream file((fs::path(outDir) / "ranking.json").string());
+    if(!file) {
+        throw std::runtime_error("Could not write ranking to " + outDir);
+    }
+    file << ranking.dump(2);
+}
+
+/**
+ * RuleSearch.run()
+ * Runs the search. The generator and simulation workers run on their own
+ * threads, while this one ranks results as they arrive, appending each to
+ * summary.tsv and keeping the keepTop best in a heap, so memory doesn't grow
+ * with numRules.
+ */
+void RuleSearch::run() {
+    if(outDir.empty()) {
+        throw std::runtime_error("No output directory for the search");
+    }
+    fs::create_directories(outDir);
+    if(options.seed < 0) {
+        options.seed = std::chrono::system_clock::now().time_since_epoch().count() & 0xFFFFFFFF;
+    }
+
+    std::string summaryFile = (fs::path(outDir) / "summary.tsv").string();
+    FILE *summary = fopen(summaryFile.c_str(), "w");
+    if(!summary) {
+        throw std::runtime_error("Could not open " + summaryFile);
+    }
+    fprintf(summary, "index\tendStatus\tvalue\tperiod\tlastTimeStep\tcached\truleString\n");
+
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+
+    int numWorkers = options.numWorkers;
+    if(numWorkers <= 0) {
+        numWorkers = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    BoundedQueue<Candidate> candidates(4 * numWorkers);
+    BoundedQueue<SearchResult> results(4 * numWorkers);
+
+    std::string error;
+    std::thread generator([&]() {
+        try {
+            generate(candidates);
+        } catch(const std::exception &e) {
+            error = e.what();
+            candidates.close();
+        }
+    });
+
+    // The last worker to finish closes the results queue, which ends the
+    // ranking loop below.
+    std::atomic<int> numRunning{numWorkers};
+    std::vector<std::thread> workers;
+    for(int i = 0; i < numWorkers; ++i) {
+        workers.emplace_back([&]() {
+            simulate(candidates, results);
+            if(--numRunning == 0) {
+                results.close();
+            }
+        });
+    }
+
+    std::vector<SearchResult> top;
+    SearchResult result;
+    size_t numRanked = 0;
+    double bestValue = 0.;
+    while(results.pop(result)) {
+        bestValue = numRanked == 0 ? result.value : std::max(bestValue, result.value);
+        fprintf(summary, "%zu\t%s\t%g\t%i\t%i\t%i\t%s\n", result.index, result.endStatus.c_str(),
+                result.value, result.period, result.lastTimeStep, (int)result.cached, result.ruleString.c_str());
+
+        if(++numRanked % 100 == 0) {
+            fflush(summary);
+            double seconds = std::chrono::duration<double>(clock::now() - start).count();
+            printf("[%zu/%zu] best value %g, %.1f rules/s\n", numRanked, numRules, bestValue,
+                   numRanked / seconds);
+        }
+
+        if(keepTop <= 0) {
+            continue;
+        }
+        // top is a heap with the worst kept result at the front.
+        if((int)top.size() == keepTop) {
+            if(!better(result, top.front())) {
+                continue;
+            }
+            std::pop_heap(top.begin(), top.end(), better);
+            top.pop_back();
+        }
+        top.push_back(std::move(result));
+        std::push_heap(top.begin(), top.end(), better);
+    }
+
+    generator.join();
+    for(auto &worker : workers) {
+        worker.join();
+    }
+    fclose(summary);
+    if(!error.empty()) {
+        throw std::runtime_error("Failed to generate rules: " + error);
+    }
+
+    std::sort(top.begin(), top.end(), better);
+    writeTop(top);
+
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+    printf("Searched with seed %lli: generated %zu rules, skipped %zu repeats and %zu prefiltered, "
+           "simulated %zu (%zu failed) in %.1f s\n",
+           options.seed, numGenerated.load(), numDuplicates.load(), numPrefiltered.load(),
+           numSimulated.load(), numFailed.load(), seconds);
+    if(!top.empty()) {
+        printf("Best rule: %zu, value %g (%s)\n", top.front().index, top.front().value,
+               top.front().endStatus.c_str());
+    }
+}
@@ -0,0 +1,200 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "RuleValue.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * RuleValue.complexityLoss()
+ * Loss for complexity, from the population's total variation. Less complex
+ * (lower variation) signals have higher loss.
+ * @param population: Steady-state population time series.
+ * @return Loss in [0, 1].
+ */
+double RuleValue::complexityLoss(const std::vector<double> &population) {
+    double maxPopulation = *std::max_element(population.begin(), population.end());
+    double norm = maxPopulation > 0. ? maxPopulation : 1.;
+
+    double tv = 0.;
+    for(size_t i = 1; i < population.size(); ++i) {
+        tv += std::abs(population[i] / norm - population[i - 1] / norm);
+    }
+    double scaledTv = tv / (double)(population.size() - 1);
+
+    return 1.0 - std::min(scaledTv, 1.0);
+}
+
+/**
+ * RuleValue.earlyTerminationLoss()
+ * Loss for a run that ended early, growing as the fraction of the run that
+ * was observed shrinks.
+ * @param maxObservedStep: Last time step recorded.
+ * @param maxSteps: Time step the run would have ended at.
+ */
+double RuleValue::earlyTerminationLoss(int maxObservedStep, int maxSteps) {
+    double observedFraction = std::clamp((double)maxObservedStep / (double)maxSteps, 0.05, 1.);
+    // Offset so that the loss goes to 0 as observedFraction goes to 1.
+    double offset = 1.;
+    return std::sqrt(std::pow(1. / observedFraction, 2.) - offset);
+}
+
+/**
+ * RuleValue.evaluate()
+ * Evaluates a finished run from its statistics.
+ * @param stats: The run's statistics.
+ */
+RuleScore RuleValue::evaluate(const RunStats &stats) const {
+    int maxObservedStep = 0;
+    for(int timeStep : stats.timeStepLog) {
+        maxObservedStep = std::max(maxObservedStep, timeStep);
+    }
+    return evaluate(stats.activeCubeLog, maxObservedStep, stats.maxTimeSteps, stats.endStatus);
+}
+
+/**
+ * RuleValue.evaluate()
+ * Evaluates a run from its population time series.
+ * @param numActiveCubes: Number of active Cubes at each recorded time step.
+ * @param maxObservedStep: Last time step recorded.
+ * @param maxSteps: Time step the run would have ended at.
+ * @param endStatus: How the run ended.
+ */
+RuleScore RuleValue::evaluate(
+        const std::vector<int> &numActiveCubes,
+        int maxObservedStep,
+        int maxSteps,
+        const std::string &endStatus) const {
+    RuleScore score;
+
+    if(isEarlyTermination(endStatus)) {
+        score.reason = "Early termination: " + endStatus;
+        score.earlyTerminationLoss = earlyTerminationLoss(maxObservedStep, maxSteps);
+        score.growthLoss = 1.;
+        score.periodicityLoss = 1.;
+        score.complexityLoss = 1.;
+        score.totalLoss = earlyTerminationWeight * score.earlyTerminationLoss
+                + growthWeight + periodicityWeight + complexityWeight;
+        score.value = -score.totalLoss;
+        score.hasLosses = true;
+        return score;
+    }
+
+    if(numActiveCubes.size() < 10) {
+        score.reason = "Insufficient data points";
+        return score;
+    }
+
+    // Remove the initial transient.
+    auto cutoff = (size_t)((double)numActiveCubes.size() * transientRatio);
+    std::vector<double> steadyPopulation(numActiveCubes.begin() + (long)cutoff, numActiveCubes.end());
+    if(steadyPopulation.size() < 5) {
+        score.reason = "Insufficient steady-state data";
+        return score;
+    }
+
+    score.growthLoss = growthRateLoss(steadyPopulation);
+    score.periodicityLoss = periodicityLoss(steadyPopulation);
+    score.complexityLoss = complexityLoss(steadyPopulation);
+    score.totalLoss = growthWeight * score.growthLoss
+            + periodicityWeight * score.periodicityLoss
+            + complexityWeight * score.complexityLoss;
+    score.value = -score.totalLoss;
+    score.hasLosses = true;
+    return score;
+}
+
+/**
+ * RuleValue.growthRateLoss()
+ * Loss for the growth rate: fits a power law to the population (a line in
+ * log-log space, by least squares) and measures the exponent's distance from
+ * idealGrowthExp.
+ * @param population: Steady-state population time series.
+ * @return Loss in [0, 1].
+ */
+double RuleValue::growthRateLoss(const std::vector<double> &population) const {
+    auto n = (double)population.size();
+
+    double sumX = 0., sumY = 0.;
+    for(size_t i = 0; i < population.size(); ++i) {
+        sumX += std::log((double)(i + 1));
+        sumY += std::log(std::max(population[i], 1e-10));
+    }
+    double meanX = sumX / n;
+    double meanY = sumY / n;
+
+    double sxy = 0., sxx = 0.;
+    for(size_t i = 0; i < population.size(); ++i) {
+        double dx = std::log((double)(i + 1)) - meanX;
+        double dy = std::log(std::max(population[i], 1e-10)) - meanY;
+        sxy += dx * dy;
+        sxx += dx * dx;
+    }
+    double exponent = sxx > 0. ? sxy / sxx : 0.;
+
+    // Assume a difference of 3 in the exponent is the maximum error.
+    double maxError = 3.0;
+    return std::min(std::abs(exponent - idealGrowthExp) / maxError, 1.0);
+}
+
+/**
+ * RuleValue.isEarlyTermination()
+ * Checks whether a run's end status counts as an early termination.
+ * @param endStatus: How the run ended.
+ */
+bool RuleValue::isEarlyTermination(const std::string &endStatus) {
+    return endStatus == "explosion"
+            || endStatus == "extinction"
+            || endStatus == "flatline"
+            || endStatus == "periodic";
+}
+
+/**
+ * RuleValue.periodicityLoss()
+ * Loss for periodicity: the ratio of the largest non-DC Fourier amplitude to
+ * the signal norm, log-transformed and capped. The series are a few hundred
+ * points long, so a direct DFT is plenty fast.
+ * @param population: Steady-state population time series.
+ * @return Loss in [0, 1], higher for more periodic signals.
+ */
+double RuleValue::periodicityLoss(const std::vector<double> &population) {
+    size_t n = population.size();
+
+    double mean = 0.;
+    for(double p : population) {
+        mean += p;
+    }
+    mean /= (double)n;
+
+    std::vector<double> normalized(n);
+    double signalNorm = 0.;
+    for(size_t i = 0; i < n; ++i) {
+        normalized[i] = population[i] - mean;
+        signalNorm += normalized[i] * normalized[i];
+    }
+    signalNorm = std::sqrt(signalNorm);
+
+    if(signalNorm < 1e-10) {
+        // Flat signal, maximum periodicity.
+        return 1.0;
+    }
+
+    // Peak amplitude over the real DFT's bins, excluding DC.
+    const double twoPi = 2. * 3.14159265358979323846;
+    double peakAmplitude = 0.;
+    for(size_t k = 1; k <= n / 2; ++k) {
+        double re = 0., im = 0.;
+        for(size_t j = 0; j < n; ++j) {
+            // Reduce j * k mod n first to keep the angle accurate.
+            double angle = twoPi * (double)((j * k) % n) / (double)n;
+            re += normalized[j] * std::cos(angle);
+            im -= normalized[j] * std::sin(angle);
+        }
+        peakAmplitude = std::max(peakAmplitude, std::sqrt(re * re + im * im));
+    }
+
+    double maxScore = std::log1p(50.);
+    double periodicityScore = std::min(std::log1p(peakAmplitude / signalNorm), maxScore);
+    return periodicityScore / maxScore;
+}
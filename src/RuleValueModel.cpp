@@ -0,0 +1,268 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "RuleValueModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * RuleValueModel.encode()
+ * Encodes a rule as the model's input, exactly as RuleEncoder.encode() does:
+ * for each (state, next state) entry, a flag per neighbor count 1 ... maxNeighbors
+ * for whether the entry includes it, then a flag per state for whether it's
+ * live.
+ * @param rule: The rule.
+ * @param input: Receives inputSize() values.
+ * @return false if the rule can't be encoded, e.g. it has the wrong number
+ *         of states.
+ */
+bool RuleValueModel::encode(const Rule &rule, float *input) const {
+    const int n = numStates;
+    if((int)rule.table.size() != n) {
+        return false;
+    }
+    std::fill(input, input + inputSize(), 0.f);
+
+    // Count c sets flag c - 1. RuleEncoder indexes with Python's negative
+    // indices, so a count of 0 sets the last flag, and that's kept here to
+    // match the trained weights.
+    auto flagIndex = [&](int count) {
+        return (count == 0) ? maxNeighbors - 1 : count - 1;
+    };
+
+    try {
+        for(int i = 0; i < n; ++i) {
+            const auto &row = rule.table[i];
+            if((int)row.size() != n) {
+                return false;
+            }
+
+            // Counts listed explicitly in each entry.
+            std::vector<std::vector<int>> listed(n);
+            for(int j = 0; j < n; ++j) {
+                const std::string &entry = row[j];
+                if(entry == "A" || entry == "C" || entry == "-") {
+                    continue;
+                }
+                std::stringstream entryStream(entry);
+                std::string value;
+                while(std::getline(entryStream, value, ',')) {
+                    if(value.find_first_not_of(" \t") == std::string::npos) {
+                        continue;
+                    }
+                    int count = std::stoi(value);
+                    if(count < 0 || count > maxNeighbors) {
+                        return false;
+                    }
+                    listed[j].push_back(count);
+                }
+            }
+
+            for(int j = 0; j < n; ++j) {
+                float *flags = input + ((size_t)i * n + j) * maxNeighbors;
+                const std::string &entry = row[j];
+                if(entry == "A") {
+                    std::fill(flags, flags + maxNeighbors, 1.f);
+                } else if(entry == "C") {
+                    std::vector<bool> used(maxNeighbors + 1, false);
+                    for(int k = 0; k < n; ++k) {
+                        if(k != j) {
+                            for(int count : listed[k]) {
+                                used[count] = true;
+                            }
+                        }
+                    }
+                    for(int count = 1; count <= maxNeighbors; ++count) {
+                        if(!used[count]) {
+                            flags[count - 1] = 1.f;
+                        }
+                    }
+                } else {
+                    for(int count : listed[j]) {
+                        flags[flagIndex(count)] = 1.f;
+                    }
+                }
+            }
+        }
+    } catch(const std::logic_error &e) {
+        // Entries that aren't numbers.
+        return false;
+    }
+
+    float *live = input + (size_t)n * n * maxNeighbors;
+    for(int s : rule.liveStates) {
+        if(s < 0 || s >= n) {
+            return false;
+        }
+        live[s] = 1.f;
+    }
+    return true;
+}
+
+/**
+ * RuleValueModel.inputSize()
+ * Returns the length of an encoded rule.
+ */
+int RuleValueModel::inputSize() const {
+    return numStates * numStates * maxNeighbors + numStates;
+}
+
+/**
+ * RuleValueModel.load()
+ * Loads weights exported by python/learn_rule_value.py.
+ * @param path: The JSON weights file.
+ */
+void RuleValueModel::load(const std::string &path) {
+    std::ifstream inFile(path);
+    if(!inFile.is_open()) {
+        throw std::runtime_error("Failed to open file for reading: " + path);
+    }
+
+    try {
+        json modelJson = json::parse(inFile);
+        if(modelJson.value("format", "") != "gol3d-rule-value-mlp") {
+            throw std::runtime_error("Not a rule value model: " + path);
+        }
+        numStates = modelJson["n_states"];
+        numDims = modelJson["n_dims"];
+        maxNeighbors = (int)std::lround(std::pow(3, numDims)) - 1;
+
+        layers.clear();
+        int prevSize = inputSize();
+        for(auto &layerJson : modelJson["layers"]) {
+            const json &weightJson = layerJson["weight"];
+            Layer layer;
+            layer.inSize = prevSize;
+            layer.outSize = (int)weightJson.size();
+            layer.bias = layerJson["bias"].get<std::vector<float>>();
+            if((int)layer.bias.size() != layer.outSize) {
+                throw std::runtime_error("Layer bias doesn't match its weights: " + path);
+            }
+
+            int numTiles = (layer.outSize + tileSize - 1) / tileSize;
+            layer.weights.assign((size_t)numTiles * layer.inSize * tileSize, 0.f);
+            for(int o = 0; o < layer.outSize; ++o) {
+                const json &rowJson = weightJson[o];
+                if((int)rowJson.size() != layer.inSize) {
+                    throw std::runtime_error("Layer sizes don't match: " + path);
+                }
+                int t = o / tileSize;
+                for(int i = 0; i < layer.inSize; ++i) {
+                    layer.weights[((size_t)t * layer.inSize + i) * tileSize + o % tileSize] = rowJson[i].get<float>();
+                }
+            }
+            prevSize = layer.outSize;
+            layers.push_back(std::move(layer));
+        }
+        if(layers.empty() || prevSize != 1) {
+            throw std::runtime_error("Model doesn't output a single value: " + path);
+        }
+    } catch(const json::exception &e) {
+        throw std::runtime_error("Failed to read model " + path + ": " + e.what());
+    }
+}
+
+/**
+ * RuleValueModel.loaded()
+ * Checks whether weights have been loaded.
+ */
+bool RuleValueModel::loaded() const {
+    return !layers.empty();
+}
+
+/**
+ * RuleValueModel.predict()
+ * Predicts the value of each of a list of rules.
+ * @param rules: The rules.
+ * @param values: Receives each rule's predicted value.
+ * @param predicted: Receives whether each rule could be predicted. Those that
+ *                   can't be encoded, e.g. with the wrong number of states,
+ *                   are left at value 0.
+ */
+void RuleValueModel::predict(const std::vector<Rule> &rules, std::vector<float> &values,
+                             std::vector<bool> &predicted) const {
+    values.assign(rules.size(), 0.f);
+    predicted.assign(rules.size(), false);
+
+    size_t maxWidth = inputSize();
+    for(auto &layer : layers) {
+        maxWidth = std::max(maxWidth, (size_t)layer.outSize);
+    }
+    std::vector<float> in(blockSize * maxWidth);
+    std::vector<float> out(blockSize * maxWidth);
+    std::vector<size_t> members;
+    std::vector<int> nonzero;
+    std::vector<size_t> offsets;
+
+    for(size_t first = 0; first < rules.size(); first += blockSize) {
+        size_t last = std::min(first + blockSize, rules.size());
+
+        // Encode the block, leaving out rules that can't be.
+        members.clear();
+        for(size_t r = first; r < last; ++r) {
+            if(encode(rules[r], &in[members.size() * maxWidth])) {
+                members.push_back(r);
+            }
+        }
+        int numRows = (int)members.size();
+
+        for(size_t l = 0; l < layers.size(); ++l) {
+            const Layer &layer = layers[l];
+            bool relu = (l + 1 < layers.size());
+
+            // Encoded rules are mostly zeros, as are the hidden layers after
+            // the ReLUs, so only the nonzero inputs are visited.
+            nonzero.clear();
+            offsets.assign(1, 0);
+            for(int b = 0; b < numRows; ++b) {
+                const float *x = &in[b * maxWidth];
+                for(int i = 0; i < layer.inSize; ++i) {
+                    if(x[i] != 0.f) {
+                        nonzero.push_back(i);
+                    }
+                }
+                offsets.push_back(nonzero.size());
+            }
+
+            // Work through the outputs a tile at a time. A tile's weights are
+            // reused by every rule in the block, and its sums stay in
+            // registers while each nonzero input adds its weights.
+            for(int t = 0; t * tileSize < layer.outSize; ++t) {
+                int o0 = t * tileSize;
+                int tile = std::min(tileSize, layer.outSize - o0);
+                const float *tileWeights = &layer.weights[(size_t)t * layer.inSize * tileSize];
+                for(int b = 0; b < numRows; ++b) {
+                    const float *x = &in[b * maxWidth];
+                    float sums[tileSize] = {};
+                    for(size_t k = offsets[b]; k < offsets[b + 1]; ++k) {
+                        int i = nonzero[k];
+                        const float *w = tileWeights + (size_t)i * tileSize;
+                        float xi = x[i];
+                        for(int o = 0; o < tileSize; ++o) {
+                            sums[o] += xi * w[o];
+                        }
+                    }
+                    float *y = &out[b * maxWidth + o0];
+                    for(int o = 0; o < tile; ++o) {
+                        float v = sums[o] + layer.bias[o0 + o];
+                        y[o] = relu ? std::max(v, 0.f) : v;
+                    }
+                }
+            }
+            std::swap(in, out);
+        }
+
+        for(int b = 0; b < numRows; ++b) {
+            values[members[b]] = in[b * maxWidth];
+            predicted[members[b]] = true;
+        }
+    }
+}
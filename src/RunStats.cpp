@@ -0,0 +1,284 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "RunStats.h"
+
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+#include "GeneralizedCellularAutomaton.h"
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+/**
+ * RunStats.begin()
+ * Starts a new run.
+ * @param numActiveCubes: Number of active Cubes the run starts with.
+ */
+void RunStats::begin(int numActiveCubes) {
+    clear();
+    activeCubesInit = numActiveCubes;
+}
+
+/**
+ * RunStats.clear()
+ * Drops everything recorded so far, keeping the thresholds. Doesn't touch
+ * the binary log.
+ */
+void RunStats::clear() {
+    cubeStateLog.clear();
+    activeCubeLog.clear();
+    timeStepLog.clear();
+    activeCubesInit = 0;
+    prevActiveCubes = -1;
+    prevPrevActiveCubes = -1;
+    prevPrevPrevActiveCubes = 0;
+    hashTimeSteps.clear();
+    periodDetector.clear();
+    period = 0;
+    periodOnset = -1;
+    periodExact = false;
+    damage.clear();
+    endStatus.clear();
+}
+
+/**
+ * RunStats.loadState()
+ * Restores the statistics of a run, as saved by saveState(), e.g. so a run
+ * in progress can carry on. The period detector is rebuilt by feeding it the
+ * recorded populations again.
+ * @param data: The saved state.
+ */
+void RunStats::loadState(const std::vector<char> &data) {
+    json state = json::from_cbor(data);
+
+    clear();
+    cubeStateLog = state["cubeStateLog"].get<std::vector<std::vector<int>>>();
+    activeCubeLog = state["activeCubeLog"].get<std::vector<int>>();
+    timeStepLog = state["timeStepLog"].get<std::vector<int>>();
+    activeCubesInit = state["activeCubesInit"];
+    prevActiveCubes = state["prevActiveCubes"];
+    prevPrevActiveCubes = state["prevPrevActiveCubes"];
+    prevPrevPrevActiveCubes = state["prevPrevPrevActiveCubes"];
+    endStatus = state["endStatus"];
+    period = state["period"];
+    periodOnset = state["periodOnset"];
+    periodExact = state["periodExact"];
+    for(auto &entry : state["hashTimeSteps"]) {
+        hashTimeSteps.emplace(entry[0].get<uint64_t>(), entry[1].get<int>());
+    }
+    if(detectPopulationPeriod) {
+        for(int numActiveCubes : activeCubeLog) {
+            periodDetector.push(numActiveCubes);
+        }
+    }
+}
+
+/**
+ * RunStats.record()
+ * Records the population at one time step, and checks whether the run is
+ * over. If it is, endStatus says why.
+ *
+ * A run is periodic once a configuration repeats exactly, as told by its
+ * configuration hash or, if detectPopulationPeriod is set, once the number
+ * of active Cubes is found to be periodic. Records are taken at the same
+ * point of the update cycle, so an exact repeat's period and onset are
+ * converted from time steps to generations. The population signal's are
+ * counted in records, which are generations while logEveryT is one update
+ * cycle.
+ * @param timeStep: Time step being recorded.
+ * @param stateCounts: Number of active Cubes in each state.
+ * @param numActiveCubes: Total number of active Cubes.
+ * @param configHash: Hash of the current configuration.
+ * @return true if the run should stop.
+ */
+bool RunStats::record(int timeStep, const std::vector<int> &stateCounts, int numActiveCubes, uint64_t configHash) {
+    if(keepStateLog) {
+        cubeStateLog.push_back(stateCounts);
+    }
+    activeCubeLog.push_back(numActiveCubes);
+    timeStepLog.push_back(timeStep);
+    if(log.isOpen()) {
+        log.append(timeStep, numActiveCubes, stateCounts);
+    }
+
+    prevPrevPrevActiveCubes = prevPrevActiveCubes;
+    prevPrevActiveCubes = prevActiveCubes;
+    prevActiveCubes = numActiveCubes;
+
+    if(activeCubesInit == 0) {
+        activeCubesInit = numActiveCubes;
+    }
+
+    float populationRatio = (float)numActiveCubes / (float)activeCubesInit;
+    bool explosion = populationRatio > populationGrowthThreshold;
+    bool extinction = populationRatio < populationDecayThreshold;
+    auto seen = hashTimeSteps.try_emplace(configHash, timeStep);
+    bool periodic = !seen.second;
+    if(periodic) {
+        int firstTimeStep = seen.first->second;
+        period = (timeStep - firstTimeStep) / GeneralizedCellularAutomaton::stagesPerGeneration;
+        periodOnset = (firstTimeStep - 1) / GeneralizedCellularAutomaton::stagesPerGeneration;
+        periodExact = true;
+    } else if(detectPopulationPeriod && periodDetector.push(numActiveCubes)) {
+        periodic = true;
+        period = periodDetector.period;
+        periodOnset = periodDetector.onset;
+        periodExact = false;
+    }
+    bool flatline = (prevPrevPrevActiveCubes == prevPrevActiveCubes)
+            && (prevPrevActiveCubes == prevActiveCubes)
+            && (prevActiveCubes == numActiveCubes);
+    bool reachedEnd = timeStep >= maxTimeSteps;
+    if(explosion) {
+        endStatus = "explosion";
+    } else if(extinction) {
+        endStatus = "extinction";
+    } else if(periodic) {
+        endStatus = "periodic";
+    } else if(flatline) {
+        endStatus = "flatline";
+    } else {
+        endStatus = "continue";
+    }
+    return explosion || extinction || periodic || flatline || reachedEnd;
+}
+
+/**
+ * RunStats.save()
+ * Writes the recorded statistics to a JSON file, creating its directory if
+ * needed.
+ * @param ruleString: String representation of the rule that was run.
+ * @param liveStates: The rule's live states.
+ * @param saveFile: Path of the file to write.
+ */
+void RunStats::save(const std::string &ruleString,
+                    const std::set<int> &liveStates,
+                    const std::string &saveFile) const {
+    json outputJson;
+    outputJson["ruleString"] = ruleString;
+    outputJson["endStatus"] = endStatus;
+    outputJson["maxSteps"] = maxTimeSteps;
+    if(endStatus == "periodic") {
+        outputJson["period"] = period;
+        outputJson["periodOnset"] = periodOnset;
+        outputJson["periodExact"] = periodExact;
+    }
+
+    outputJson["liveStates"] = json::array();
+    for(const auto &state : liveStates) {
+        outputJson["liveStates"].push_back(state);
+    }
+
+    // One populationRecord entry per recorded time step, keyed by the step.
+    outputJson["populationRecord"] = json::object();
+    for(size_t i = 0; i < cubeStateLog.size(); ++i) {
+        const auto &stateVector = cubeStateLog[i];
+        const int timeStep = timeStepLog[i];
+
+        int numActiveCubes = std::accumulate(stateVector.begin(), stateVector.end(), 0);
+
+        int numLiveCubes = 0;
+        for(const int &liveState : liveStates) {
+            if(liveState < (int)stateVector.size()) {
+                numLiveCubes += stateVector[liveState];
+            }
+        }
+
+        int numDyingCubes = 0;
+        for(size_t j = 1; j < stateVector.size(); ++j) {
+            if(liveStates.find((int)j) == liveStates.end()) {
+                numDyingCubes += stateVector[j];
+            }
+        }
+
+        json timeStepEntry;
+        timeStepEntry["stateCounts"] = stateVector;
+        timeStepEntry["numActiveCubes"] = numActiveCubes;
+        timeStepEntry["numLiveCubes"] = numLiveCubes;
+        timeStepEntry["numDyingCubes"] = numDyingCubes;
+        timeStepEntry["numNonDeadCubes"] = numLiveCubes + numDyingCubes;
+
+        outputJson["populationRecord"][std::to_string(timeStep)] = timeStepEntry;
+    }
+
+    if(!damage.empty()) {
+        outputJson["damage"] = {
+            {"site", json::array({damage.site.x, damage.site.y, damage.site.z})},
+            {"generation", damage.generationLog},
+            {"hamming", damage.hammingLog},
+            {"radius", damage.radiusLog}
+        };
+    }
+
+    fs::path filePath(saveFile);
+    if(filePath.has_parent_path()) {
+        fs::create_directories(filePath.parent_path());
+    }
+
+    std::ofstream outFile(saveFile);
+    if(!outFile.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + saveFile);
+    }
+    outFile << outputJson.dump(2);
+}
+
+/**
+ * RunStats.relabelStates()
+ * Relabels the states in the recorded state counts.
+ * @param stateMap: stateMap[s] is the new label of state s, or -1 to drop it.
+ * @param numStates: Number of states after relabelling.
+ */
+void RunStats::relabelStates(const std::vector<int> &stateMap, int numStates) {
+    for(auto &stateVector : cubeStateLog) {
+        std::vector<int> relabelled(numStates, 0);
+        for(size_t s = 0; s < stateVector.size() && s < stateMap.size(); ++s) {
+            if(stateMap[s] >= 0 && stateMap[s] < numStates) {
+                relabelled[stateMap[s]] += stateVector[s];
+            }
+        }
+        stateVector = std::move(relabelled);
+    }
+}
+
+/**
+ * RunStats.saveState()
+ * Saves the statistics of a run, finished or in progress, for loadState().
+ * The binary log isn't included.
+ * @return the saved state, as CBOR.
+ */
+std::vector<char> RunStats::saveState() const {
+    json state;
+    state["cubeStateLog"] = cubeStateLog;
+    state["activeCubeLog"] = activeCubeLog;
+    state["timeStepLog"] = timeStepLog;
+    state["activeCubesInit"] = activeCubesInit;
+    state["prevActiveCubes"] = prevActiveCubes;
+    state["prevPrevActiveCubes"] = prevPrevActiveCubes;
+    state["prevPrevPrevActiveCubes"] = prevPrevPrevActiveCubes;
+    state["endStatus"] = endStatus;
+    state["period"] = period;
+    state["periodOnset"] = periodOnset;
+    state["periodExact"] = periodExact;
+    state["hashTimeSteps"] = json::array();
+    for(auto &entry : hashTimeSteps) {
+        state["hashTimeSteps"].push_back({entry.first, entry.second});
+    }
+
+    std::vector<char> data;
+    json::to_cbor(state, data);
+    return data;
+}
+
+/**
+ * RunStats.shouldRecord()
+ * Checks whether statistics are due at a time step.
+ * @param timeStep: The time step, counting from 1.
+ */
+bool RunStats::shouldRecord(int timeStep) const {
+    return timeStep % logEveryT == 1 % logEveryT;
+}
@@ -0,0 +1,75 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "Simulation.h"
+
+#include <chrono>
+
+Simulation::~Simulation() {
+    stop();
+}
+
+/**
+ * Simulation.loop()
+ * Updates the World's Objects until stop() is called. Sleeps briefly whenever
+ * every Object is stopped, to avoid spinning while waiting for commands.
+ */
+void Simulation::loop() {
+    using clock = std::chrono::steady_clock;
+    auto lastGeneration = clock::now();
+
+    while(running.load()) {
+        bool busy = false;
+
+        for(auto &obj : world->objects) {
+            int generation = obj->generation;
+
+            obj->update();
+
+            busy = busy || (obj->state != ObjectState::stop);
+
+            // Throttle, if a rate limit is set and a generation just finished.
+            double maxRate = maxGenerationsPerSecond.load();
+            if(maxRate > 0. && obj->generation != generation) {
+                auto nextGeneration = lastGeneration + std::chrono::duration_cast<clock::duration>(
+                        std::chrono::duration<double>(1. / maxRate));
+                std::this_thread::sleep_until(nextGeneration);
+                lastGeneration = clock::now();
+            }
+        }
+
+        if(!busy) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+/**
+ * Simulation.start()
+ * Starts simulating the World's Objects on a new thread. From here on, the
+ * World no longer updates its Objects itself.
+ * @param world_: The World to simulate. Its objects list must not change
+ *                while the Simulation is running.
+ */
+void Simulation::start(World *world_) {
+    if(running.load()) {
+        return;
+    }
+    world = world_;
+    world->threaded = true;
+    running = true;
+    thread = std::thread(&Simulation::loop, this);
+}
+
+/**
+ * Simulation.stop()
+ * Stops the simulation thread and hands Object updates back to the World.
+ */
+void Simulation::stop() {
+    if(!running.load()) {
+        return;
+    }
+    running = false;
+    thread.join();
+    world->threaded = false;
+}
@@ -0,0 +1,364 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "SlabAutomaton.h"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+#include <mpi.h>
+
+#include "GeneralizedCellularAutomaton.h"
+
+/**
+ * SlabAutomaton.exchangeFaces()
+ * Swaps Cubes on the slab's faces with the neighboring ranks.
+ * @param lowFace: Cubes to send to the rank below (on the slab's lowest x).
+ * @param highFace: Cubes to send to the rank above (on the slab's highest x).
+ * @return the Cubes the neighbors sent: their faces next to this slab.
+ */
+SlabAutomaton::cubeSet_t SlabAutomaton::exchangeFaces(const std::vector<glm::ivec3> &lowFace,
+                                                      const std::vector<glm::ivec3> &highFace) const {
+    int below = rank > 0 ? rank - 1 : MPI_PROC_NULL;
+    int above = rank < numRanks - 1 ? rank + 1 : MPI_PROC_NULL;
+
+    cubeSet_t received;
+    auto swap = [&](const std::vector<glm::ivec3> &face, int to, int from) {
+        std::vector<int> sent;
+        sent.reserve(face.size() * 3);
+        for(auto &center : face) {
+            sent.insert(sent.end(), {center.x, center.y, center.z});
+        }
+        int numSent = (int)sent.size();
+        int numReceived = 0;
+        MPI_Sendrecv(&numSent, 1, MPI_INT, to, 0, &numReceived, 1, MPI_INT, from, 0,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        std::vector<int> data(numReceived);
+        MPI_Sendrecv(sent.data(), numSent, MPI_INT, to, 1, data.data(), numReceived, MPI_INT, from, 1,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        for(int i = 0; i + 2 < numReceived; i += 3) {
+            received.insert(glm::ivec3(data[i], data[i + 1], data[i + 2]));
+        }
+    };
+    swap(lowFace, below, above);
+    swap(highFace, above, below);
+    return received;
+}
+
+/**
+ * SlabAutomaton.init()
+ * Sets the rule, and finds this process' rank.
+ * @param rule: The rule.
+ */
+void SlabAutomaton::init(const Rule &rule) {
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+
+    numStates = (int)rule.table.size();
+    if(numStates > 255) {
+        throw std::runtime_error("SlabAutomatons support at most 255 states");
+    }
+    ruleTable.clear();
+    for(auto &row : rule.table) {
+        for(int next : GeneralizedCellularAutomaton::parseRuleRow(row)) {
+            ruleTable.push_back((uint8_t)next);
+        }
+    }
+    liveTable.assign(numStates, 0);
+    for(int s : rule.liveStates) {
+        if(s >= 0 && s < numStates) {
+            liveTable[s] = 1;
+        }
+    }
+    stateCounts.assign(numStates, 0);
+    cubes.clear();
+    localHash = 0;
+    generation = 0;
+}
+
+/**
+ * SlabAutomaton.load()
+ * Starts from a captured configuration, which every rank passes in whole.
+ * The slabs are split so each holds about as many of its Cubes as the others,
+ * and each rank keeps its own.
+ * @param world: The configuration, with the rule init() was given.
+ */
+void SlabAutomaton::load(const BrickWorld &world) {
+    const int width = BrickWorld::brickWidth;
+    auto forEachCube = [&](auto body) {
+        for(auto &entry : world.getBricks()) {
+            glm::ivec3 origin = entry.first * width;
+            const BrickWorld::brick_t &brick = *entry.second;
+            for(int j = 0; j < BrickWorld::brickSize; ++j) {
+                if(brick[j] != 0) {
+                    glm::ivec3 center(origin.x + j / (width * width), origin.y + (j / width) % width,
+                                      origin.z + j % width);
+                    body(center, brick[j] - 1);
+                }
+            }
+        }
+    };
+
+    int minX = INT_MAX;
+    int maxX = INT_MIN;
+    for(auto &entry : world.getBricks()) {
+        minX = std::min(minX, entry.first.x * width);
+        maxX = std::max(maxX, entry.first.x * width + width - 1);
+    }
+    std::vector<long long> planeCounts(minX <= maxX ? (size_t)(maxX - minX + 1) : 0, 0);
+    forEachCube([&](const glm::ivec3 &center, int) {
+        planeCounts[center.x - minX]++;
+    });
+    splitSlabs(planeCounts, minX);
+
+    cubes.clear();
+    localHash = 0;
+    forEachCube([&](const glm::ivec3 &center, int state) {
+        if(ownerOf(center.x) == rank) {
+            cubes.emplace(center, (uint8_t)state);
+            localHash ^= Object::zobristKey(center, state);
+        }
+    });
+    generation = world.generation;
+
+    reduce(std::vector<int>(numStates, 0));
+    stateCounts = world.stateCounts;
+    stateCounts.resize(numStates, 0);
+}
+
+/**
+ * SlabAutomaton.migrate()
+ * Sends every Cube outside this rank's slab to the rank whose slab it's in,
+ * and takes in the Cubes sent here.
+ */
+void SlabAutomaton::migrate() {
+    std::vector<std::vector<int>> outgoing(numRanks);
+    for(auto cube = cubes.begin(); cube != cubes.end();) {
+        int owner = ownerOf(cube->first.x);
+        if(owner == rank) {
+            ++cube;
+            continue;
+        }
+        const glm::ivec3 &center = cube->first;
+        outgoing[owner].insert(outgoing[owner].end(), {center.x, center.y, center.z, (int)cube->second});
+        localHash ^= Object::zobristKey(center, cube->second);
+        cube = cubes.erase(cube);
+    }
+
+    std::vector<int> sendCounts(numRanks), sendOffsets(numRanks), receiveCounts(numRanks), receiveOffsets(numRanks);
+    std::vector<int> sent;
+    for(int r = 0; r < numRanks; ++r) {
+        sendCounts[r] = (int)outgoing[r].size();
+        sendOffsets[r] = (int)sent.size();
+        sent.insert(sent.end(), outgoing[r].begin(), outgoing[r].end());
+    }
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, receiveCounts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    int numReceived = 0;
+    for(int r = 0; r < numRanks; ++r) {
+        receiveOffsets[r] = numReceived;
+        numReceived += receiveCounts[r];
+    }
+    std::vector<int> data(numReceived);
+    MPI_Alltoallv(sent.data(), sendCounts.data(), sendOffsets.data(), MPI_INT,
+                  data.data(), receiveCounts.data(), receiveOffsets.data(), MPI_INT, MPI_COMM_WORLD);
+
+    for(int i = 0; i + 3 < numReceived; i += 4) {
+        glm::ivec3 center(data[i], data[i + 1], data[i + 2]);
+        cubes.emplace(center, (uint8_t)data[i + 3]);
+        localHash ^= Object::zobristKey(center, data[i + 3]);
+    }
+}
+
+/**
+ * SlabAutomaton.numLocalCubes()
+ * Number of active Cubes this rank holds.
+ */
+size_t SlabAutomaton::numLocalCubes() const {
+    return cubes.size();
+}
+
+/**
+ * SlabAutomaton.ownerOf()
+ * Rank whose slab holds the Cubes with a given x.
+ * @param x: The x coordinate.
+ */
+int SlabAutomaton::ownerOf(int x) const {
+    return (int)(std::upper_bound(slabStarts.begin(), slabStarts.end(), x) - slabStarts.begin()) - 1;
+}
+
+/**
+ * SlabAutomaton.rebalance()
+ * Moves the slab boundaries so each rank holds about as many active Cubes as
+ * the others, and moves the Cubes to their new ranks.
+ */
+void SlabAutomaton::rebalance() {
+    int localRange[2] = {INT_MAX, INT_MIN};
+    for(auto &cube : cubes) {
+        localRange[0] = std::min(localRange[0], cube.first.x);
+        localRange[1] = std::max(localRange[1], cube.first.x);
+    }
+    int minX, maxX;
+    MPI_Allreduce(&localRange[0], &minX, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(&localRange[1], &maxX, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if(minX > maxX) {
+        return;
+    }
+
+    std::vector<long long> localCounts((size_t)(maxX - minX + 1), 0);
+    for(auto &cube : cubes) {
+        localCounts[cube.first.x - minX]++;
+    }
+    std::vector<long long> planeCounts(localCounts.size());
+    MPI_Allreduce(localCounts.data(), planeCounts.data(), (int)planeCounts.size(), MPI_LONG_LONG, MPI_SUM,
+                  MPI_COMM_WORLD);
+
+    splitSlabs(planeCounts, minX);
+    migrate();
+}
+
+/**
+ * SlabAutomaton.reduce()
+ * Sums the ranks' state counts and numbers of active Cubes, and combines
+ * their configuration hashes.
+ * @param localCounts: This rank's state counts.
+ */
+void SlabAutomaton::reduce(const std::vector<int> &localCounts) {
+    stateCounts.assign(numStates, 0);
+    MPI_Allreduce(localCounts.data(), stateCounts.data(), numStates, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    long long numLocal = (long long)cubes.size();
+    MPI_Allreduce(&numLocal, &numActiveCubes, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&localHash, &configHash, 1, MPI_UINT64_T, MPI_BXOR, MPI_COMM_WORLD);
+}
+
+/**
+ * SlabAutomaton.splitSlabs()
+ * Sets the slab boundaries so each slab holds about the same number of
+ * Cubes, and is at least one Cube wide, so halos only reach the neighboring
+ * ranks.
+ * @param planeCounts: Number of Cubes at each x, from minX on.
+ * @param minX: x of planeCounts[0].
+ */
+void SlabAutomaton::splitSlabs(const std::vector<long long> &planeCounts, int minX) {
+    long long total = 0;
+    for(long long count : planeCounts) {
+        total += count;
+    }
+
+    slabStarts.assign(numRanks + 1, INT_MIN);
+    slabStarts[numRanks] = INT_MAX;
+    size_t plane = 0;
+    long long below = 0;
+    for(int r = 1; r < numRanks; ++r) {
+        long long target = total * r / numRanks;
+        while(plane < planeCounts.size() && below + planeCounts[plane] <= target) {
+            below += planeCounts[plane++];
+        }
+        int start = minX + (int)plane;
+        slabStarts[r] = r > 1 ? std::max(start, slabStarts[r - 1] + 1) : start;
+    }
+}
+
+/**
+ * SlabAutomaton.step()
+ * Runs one generation on every rank, as the serial engine's update cycle
+ * would: every active Cube is updated from its live neighbor count, dead
+ * Cubes that didn't change stop being active, and the neighborhoods of the
+ * Cubes that changed become active.
+ */
+void SlabAutomaton::step() {
+    const int lo = slabStarts[rank];
+    const int hi = slabStarts[rank + 1];
+
+    // Live Cubes on the slab's faces, for the neighbors' live neighbor counts.
+    std::vector<glm::ivec3> lowFace, highFace;
+    for(auto &cube : cubes) {
+        if(liveTable[cube.second]) {
+            if(cube.first.x == lo) {
+                lowFace.push_back(cube.first);
+            }
+            if(cube.first.x == hi - 1) {
+                highFace.push_back(cube.first);
+            }
+        }
+    }
+    cubeSet_t haloLive = exchangeFaces(lowFace, highFace);
+
+    auto isLive = [&](const glm::ivec3 &center) {
+        if(center.x < lo || center.x >= hi) {
+            return haloLive.find(center) != haloLive.end();
+        }
+        auto cube = cubes.find(center);
+        return cube != cubes.end() && liveTable[cube->second];
+    };
+
+    // Compute the new states.
+    std::vector<int> localCounts(numStates, 0);
+    std::vector<std::pair<glm::ivec3, uint8_t>> changes;
+    std::vector<glm::ivec3> removed;
+    for(auto &cube : cubes) {
+        const glm::ivec3 &center = cube.first;
+        int count = 0;
+        for(int dx = -1; dx <= 1; ++dx) {
+            for(int dy = -1; dy <= 1; ++dy) {
+                for(int dz = -1; dz <= 1; ++dz) {
+                    if((dx != 0 || dy != 0 || dz != 0) && isLive(center + glm::ivec3(dx, dy, dz))) {
+                        count++;
+                    }
+                }
+            }
+        }
+        int oldState = cube.second;
+        int newState = ruleTable[oldState * 27 + count];
+        localCounts[newState]++;
+        if(newState != oldState) {
+            changes.emplace_back(center, (uint8_t)newState);
+        } else if(oldState == 0) {
+            removed.push_back(center);
+        }
+    }
+
+    // Apply them, and swap the changes on the faces, which activate Cubes in
+    // the neighbors' slabs.
+    lowFace.clear();
+    highFace.clear();
+    for(auto &change : changes) {
+        const glm::ivec3 &center = change.first;
+        uint8_t &state = cubes[center];
+        localHash ^= Object::zobristKey(center, state) ^ Object::zobristKey(center, change.second);
+        state = change.second;
+        if(center.x == lo) {
+            lowFace.push_back(center);
+        }
+        if(center.x == hi - 1) {
+            highFace.push_back(center);
+        }
+    }
+    cubeSet_t haloChanged = exchangeFaces(lowFace, highFace);
+
+    // Next generation's active Cubes.
+    for(auto &center : removed) {
+        cubes.erase(center);
+    }
+    auto activate = [&](const glm::ivec3 &center) {
+        for(int x = std::max(center.x - 1, lo); x <= std::min(center.x + 1, hi - 1); ++x) {
+            for(int dy = -1; dy <= 1; ++dy) {
+                for(int dz = -1; dz <= 1; ++dz) {
+                    cubes.try_emplace(glm::ivec3(x, center.y + dy, center.z + dz), 0);
+                }
+            }
+        }
+    };
+    for(auto &change : changes) {
+        activate(change.first);
+    }
+    for(auto &center : haloChanged) {
+        activate(center);
+    }
+
+    reduce(localCounts);
+    generation++;
+    if(rebalanceEvery > 0 && generation % rebalanceEvery == 0) {
+        rebalance();
+    }
+}
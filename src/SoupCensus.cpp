@@ -0,0 +1,468 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "SoupCensus.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+#include <unordered_set>
+
+#include "utils.h"
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+namespace fs = std::filesystem;
+
+// Soup end statuses whose leftovers are censused. Soups that explode, time
+// out or run out of time steps never settle.
+static const std::set<std::string> settledStatuses = {"periodic", "flatline", "extinction"};
+
+// Past this many entries, a worker's classification cache is emptied.
+static const size_t maxCachedClassifications = 100000;
+
+// Number of Cubes each worker's scratch automaton preallocates.
+static const int scratchNumCubes = 4096;
+
+// Cell order for canonical forms: by x, then y, then z, then state.
+static bool cellLess(const glm::ivec4 &a, const glm::ivec4 &b) {
+    if(a.x != b.x) {
+        return a.x < b.x;
+    }
+    if(a.y != b.y) {
+        return a.y < b.y;
+    }
+    if(a.z != b.z) {
+        return a.z < b.z;
+    }
+    return a.w < b.w;
+}
+
+/**
+ * normalize()
+ * Moves cells to start at the origin, and sorts them.
+ * @param cells: The cells, as (x, y, z, state). Updated.
+ * @return the cells' lowest corner before the move.
+ */
+static glm::ivec3 normalize(std::vector<glm::ivec4> &cells) {
+    glm::ivec3 lo = cells.empty() ? glm::ivec3(0, 0, 0) : glm::ivec3(cells.front());
+    for(auto &cell : cells) {
+        lo = glm::min(lo, glm::ivec3(cell));
+    }
+    for(auto &cell : cells) {
+        cell -= glm::ivec4(lo, 0);
+    }
+    std::sort(cells.begin(), cells.end(), cellLess);
+    return lo;
+}
+
+/**
+ * cellText()
+ * Text form of a list of cells, as "x,y,z,state;" per cell.
+ * @param cells: The cells.
+ */
+static std::string cellText(const std::vector<glm::ivec4> &cells) {
+    std::string text;
+    text.reserve(cells.size() * 12);
+    for(auto &cell : cells) {
+        text += std::to_string(cell.x) + "," + std::to_string(cell.y) + "," + std::to_string(cell.z) + ","
+                + std::to_string(cell.w) + ";";
+    }
+    return text;
+}
+
+/**
+ * nonDeadCells()
+ * A GCA's non-dead Cubes, as (x, y, z, state).
+ * @param gol: The GCA.
+ */
+static std::vector<glm::ivec4> nonDeadCells(const GeneralizedCellularAutomaton &gol) {
+    std::vector<glm::ivec4> cells;
+    cells.reserve(gol.drawCubes.size());
+    for(auto &drawCube : gol.drawCubes) {
+        cells.emplace_back(drawCube.first, drawCube.second->state);
+    }
+    return cells;
+}
+
+/**
+ * canonicalForm()
+ * The canonical form of an object: of all its phases, in all 48 rotations
+ * and reflections of the cube, the one with the fewest cells, and of those
+ * the one whose sorted cells come first. Outer totalistic rules don't tell
+ * these apart, so every copy of the object has the same canonical form.
+ * @param phases: The object's cells in each phase of its period.
+ */
+static std::vector<glm::ivec4> canonicalForm(const std::vector<std::vector<glm::ivec4>> &phases) {
+    static const int permutations[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+
+    std::vector<glm::ivec4> best;
+    std::vector<glm::ivec4> turned;
+    for(auto &phase : phases) {
+        if(!best.empty() && phase.size() > best.size()) {
+            continue;
+        }
+        for(auto &permutation : permutations) {
+            for(int signs = 0; signs < 8; ++signs) {
+                turned.clear();
+                for(auto &cell : phase) {
+                    glm::ivec4 t(0, 0, 0, cell.w);
+                    for(int axis = 0; axis < 3; ++axis) {
+                        int coordinate = cell[permutation[axis]];
+                        t[axis] = (signs >> axis) & 1 ? -coordinate : coordinate;
+                    }
+                    turned.push_back(t);
+                }
+                normalize(turned);
+                if(best.empty() || turned.size() < best.size()
+                   || (turned.size() == best.size()
+                       && std::lexicographical_compare(turned.begin(), turned.end(), best.begin(), best.end(),
+                                                       cellLess))) {
+                    best = turned;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * stepGeneration()
+ * Runs a GCA through one generation's update cycle.
+ * @param gol: The GCA, between generations.
+ */
+static void stepGeneration(GeneralizedCellularAutomaton &gol) {
+    int target = gol.generation + 1;
+    while(gol.generation < target || gol.cycleStage != 0) {
+        gol.update();
+    }
+}
+
+/**
+ * SoupCensus.censusRule()
+ * Takes the census of one rule: runs its soups on the workers, merges their
+ * tallies, and writes the report.
+ * @param ruleFile: Path of the rule's file.
+ * @param ruleIndex: Position of the rule in ruleFiles, for progress output.
+ */
+void SoupCensus::censusRule(const std::string &ruleFile, size_t ruleIndex) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+
+    Tally tally;
+    std::string ruleString;
+    try {
+        const Rule rule = parseRuleFromJson(ruleFile);
+        ruleString = GeneralizedCellularAutomaton::formatRule(rule.table);
+
+        int numWorkers = options.numWorkers;
+        if(numWorkers <= 0) {
+            numWorkers = std::max(1, (int)std::thread::hardware_concurrency());
+        }
+        numWorkers = (int)std::min((long long)numWorkers, std::max(numSoups, 1LL));
+
+        nextSoup = 0;
+        std::vector<std::thread> workers;
+        for(int i = 0; i < numWorkers; ++i) {
+            workers.emplace_back(&SoupCensus::work, this, std::cref(rule), std::ref(tally));
+        }
+        for(auto &worker : workers) {
+            worker.join();
+        }
+
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+        std::string saveFile = (fs::path(outDir) / fs::path(ruleFile).filename()).replace_extension(".census.json")
+                .string();
+        writeReport(ruleString, tally, seconds, saveFile);
+
+        const CensusObject *mostCommon = nullptr;
+        for(auto &entry : tally.objects) {
+            const CensusObject &object = entry.second;
+            if(mostCommon == nullptr || object.count > mostCommon->count
+               || (object.count == mostCommon->count && object.code < mostCommon->code)) {
+                mostCommon = &object;
+            }
+        }
+        printf("[%zu/%zu] %s: %lli soups in %.1f s (%.1f soups/s), %lli objects of %zu kinds%s%s\n",
+               ruleIndex + 1, ruleFiles.size(), ruleFile.c_str(), numSoups, seconds, numSoups / seconds,
+               tally.numObjects, tally.objects.size(), mostCommon ? ", most common " : "",
+               mostCommon ? mostCommon->code.c_str() : "");
+
+    } catch(const std::exception &e) {
+        printf("%s: %s\n", ruleFile.c_str(), e.what());
+        ++numFailed;
+    }
+}
+
+/**
+ * SoupCensus.classify()
+ * Finds what a component is, by running it on its own until it returns to
+ * itself (up to translation), and makes its census entry.
+ * @param scratch: Automaton with the rule set, to run the component on.
+ * @param cells: The component's Cubes, moved to start at the origin, and
+ *               sorted.
+ * @param maxPeriod: Longest period looked for.
+ * @param cache: Classifications so far, by component. Updated.
+ */
+const SoupCensus::Classification &SoupCensus::classify(GeneralizedCellularAutomaton &scratch,
+                                                       const std::vector<glm::ivec4> &cells,
+                                                       int maxPeriod,
+                                                       classificationCache_t &cache) {
+    std::string cellsKey = cellText(cells);
+    auto cached = cache.find(cellsKey);
+    if(cached != cache.end()) {
+        return cached->second;
+    }
+    if(cache.size() >= maxCachedClassifications) {
+        cache.clear();
+    }
+    Classification &result = cache[cellsKey];
+
+    scratch.reset();
+    for(auto &cell : cells) {
+        scratch.add(cell.x, cell.y, cell.z);
+        scratch.setCube(scratch.activeCubes[glm::ivec3(cell)], cell.w);
+    }
+    scratch.recomputeStateCounts();
+
+    // Objects that die or keep growing on their own aren't objects.
+    const size_t maxCubes = 4 * cells.size() + 64;
+    std::vector<std::vector<glm::ivec4>> phases = {cells};
+    int period = 0;
+    glm::ivec3 displacement(0, 0, 0);
+    for(int g = 1; g <= maxPeriod; ++g) {
+        stepGeneration(scratch);
+        std::vector<glm::ivec4> phase = nonDeadCells(scratch);
+        if(phase.empty() || phase.size() > maxCubes) {
+            break;
+        }
+        glm::ivec3 lo = normalize(phase);
+        if(phase == cells) {
+            period = g;
+            displacement = lo;
+            break;
+        }
+        phases.push_back(std::move(phase));
+    }
+    if(period == 0) {
+        return result;
+    }
+
+    CensusObject &object = result.object;
+    object.period = period;
+    object.cells = canonicalForm(phases);
+    int offsets[3] = {std::abs(displacement.x), std::abs(displacement.y), std::abs(displacement.z)};
+    std::sort(offsets, offsets + 3);
+    object.displacement = glm::ivec3(offsets[0], offsets[1], offsets[2]);
+
+    std::string prefix;
+    if(object.displacement != glm::ivec3(0, 0, 0)) {
+        object.kind = "spaceship";
+        prefix = "xq" + std::to_string(period);
+    } else if(period > 1) {
+        object.kind = "oscillator";
+        prefix = "xp" + std::to_string(period);
+    } else {
+        object.kind = "still life";
+        prefix = "xs" + std::to_string(object.cells.size());
+    }
+    result.key = cellText(object.cells);
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016" PRIx64, stringHash(result.key));
+    object.code = prefix + "_" + hash;
+    result.settled = true;
+    return result;
+}
+
+/**
+ * SoupCensus.run()
+ * Takes the census of every rule, one after another, each with its soups
+ * spread over the workers.
+ */
+void SoupCensus::run() {
+    if(outDir.empty()) {
+        throw std::runtime_error("No output directory for the census");
+    }
+    fs::create_directories(outDir);
+    if(options.seed < 0) {
+        options.seed = std::chrono::system_clock::now().time_since_epoch().count() & 0xFFFFFFFF;
+    }
+    options.detectPopulationPeriod = true;
+
+    for(size_t i = 0; i < ruleFiles.size(); ++i) {
+        censusRule(ruleFiles[i], i);
+    }
+}
+
+/**
+ * SoupCensus.work()
+ * Worker thread body. Takes soups of a rule off the list until there are
+ * none left, running each until it settles and tallying its components, then
+ * merges its tally into the rule's.
+ * @param rule: The rule.
+ * @param result: The rule's tally. Updated.
+ */
+void SoupCensus::work(const Rule &rule, Tally &result) {
+    GeneralizedCellularAutomaton gol;
+    gol.init(glm::vec3(0, 0, 0), 0.5, options.initNumCubes);
+    GeneralizedCellularAutomaton scratch;
+    scratch.init(glm::vec3(0, 0, 0), 0.5, scratchNumCubes);
+    scratch.publishSnapshots = false;
+    scratch.setRule(rule.table, rule.liveStates);
+    scratch.active = true;
+    scratch.state = ObjectState::run;
+
+    const int maxPeriod = options.periodDetector.maxPeriod;
+    BatchOptions soupOptions = options;
+    RunStats stats;
+    Tally tally;
+    classificationCache_t cache;
+    std::unordered_set<glm::ivec3, KeyFuncs, KeyFuncs> seen;
+    std::unordered_set<std::string> inSoup;
+    std::vector<glm::ivec3> frontier;
+    std::vector<glm::ivec4> cells;
+
+    long long i;
+    while((i = nextSoup.fetch_add(1)) < numSoups) {
+        soupOptions.seed = options.seed + i;
+        try {
+            BatchRunner::runRule(gol, rule, stats, soupOptions);
+        } catch(const std::exception &) {
+            ++tally.endStatuses["error"];
+            continue;
+        }
+        ++tally.endStatuses[stats.endStatus];
+        if(settledStatuses.count(stats.endStatus) == 0) {
+            continue;
+        }
+
+        // Split the non-dead Cubes into components of Cubes within two cells
+        // of each other along every axis, as apgsearch does: Cubes that far
+        // apart share neighbors, so they can still interact, and an object
+        // made of such pieces would fall apart if they were run on their own.
+        seen.clear();
+        inSoup.clear();
+        for(auto &drawCube : gol.drawCubes) {
+            if(!seen.insert(drawCube.first).second) {
+                continue;
+            }
+            cells.clear();
+            frontier.assign(1, drawCube.first);
+            while(!frontier.empty()) {
+                glm::ivec3 position = frontier.back();
+                frontier.pop_back();
+                cells.emplace_back(position, gol.drawCubes.at(position)->state);
+                for(int dx = -2; dx <= 2; ++dx) {
+                    for(int dy = -2; dy <= 2; ++dy) {
+                        for(int dz = -2; dz <= 2; ++dz) {
+                            glm::ivec3 neighbor = position + glm::ivec3(dx, dy, dz);
+                            if(gol.drawCubes.count(neighbor) != 0 && seen.insert(neighbor).second) {
+                                frontier.push_back(neighbor);
+                            }
+                        }
+                    }
+                }
+            }
+
+            normalize(cells);
+            const Classification &classification = classify(scratch, cells, maxPeriod, cache);
+            if(!classification.settled) {
+                ++tally.numUnsettled;
+                continue;
+            }
+            ++tally.numObjects;
+            auto entry = tally.objects.try_emplace(classification.key, classification.object).first;
+            CensusObject &object = entry->second;
+            ++object.count;
+            if(inSoup.insert(classification.key).second) {
+                ++object.numSoups;
+                if(object.firstSeed < 0 || soupOptions.seed < object.firstSeed) {
+                    object.firstSeed = soupOptions.seed;
+                }
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(tallyMutex);
+    for(auto &entry : tally.objects) {
+        auto merged = result.objects.try_emplace(entry.first, entry.second);
+        if(merged.second) {
+            continue;
+        }
+        CensusObject &object = merged.first->second;
+        object.count += entry.second.count;
+        object.numSoups += entry.second.numSoups;
+        object.firstSeed = std::min(object.firstSeed, entry.second.firstSeed);
+    }
+    for(auto &status : tally.endStatuses) {
+        result.endStatuses[status.first] += status.second;
+    }
+    result.numObjects += tally.numObjects;
+    result.numUnsettled += tally.numUnsettled;
+}
+
+/**
+ * SoupCensus.writeReport()
+ * Writes a rule's census report: the soups' end statuses, and every object
+ * found, most common first.
+ * @param ruleString: String representation of the rule.
+ * @param tally: The rule's tally.
+ * @param seconds: Wall-clock time the census took.
+ * @param saveFile: Path of the file to write.
+ */
+void SoupCensus::writeReport(const std::string &ruleString, const Tally &tally, double seconds,
+                             const std::string &saveFile) const {
+    std::vector<const CensusObject *> objects;
+    for(auto &entry : tally.objects) {
+        objects.push_back(&entry.second);
+    }
+    std::sort(objects.begin(), objects.end(), [](const CensusObject *a, const CensusObject *b) {
+        if(a->count != b->count) {
+            return a->count > b->count;
+        }
+        return a->code < b->code;
+    });
+
+    json report;
+    report["rule_string"] = ruleString;
+    report["seed"] = options.seed;
+    report["num_soups"] = numSoups;
+    report["hwidth"] = options.hwidth;
+    report["seconds"] = seconds;
+    report["end_statuses"] = tally.endStatuses;
+    report["num_objects"] = tally.numObjects;
+    report["num_unsettled_objects"] = tally.numUnsettled;
+
+    json objectList = json::array();
+    for(const CensusObject *object : objects) {
+        json cells = json::array();
+        for(auto &cell : object->cells) {
+            cells.push_back({cell.x, cell.y, cell.z, cell.w});
+        }
+        objectList.push_back({
+            {"code", object->code},
+            {"kind", object->kind},
+            {"period", object->period},
+            {"displacement", {object->displacement.x, object->displacement.y, object->displacement.z}},
+            {"num_cubes", object->cells.size()},
+            {"count", object->count},
+            {"num_soups", object->numSoups},
+            {"first_seed", object->firstSeed},
+            {"cells", cells}
+        });
+    }
+    report["objects"] = objectList;
+
+    std::ofstream outFile(saveFile);
+    if(!outFile.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + saveFile);
+    }
+    outFile << report.dump(2);
+}
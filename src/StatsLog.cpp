@@ -0,0 +1,277 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "StatsLog.h"
+
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include "RunStats.h"
+
+namespace fs = std::filesystem;
+
+static const char magic[8] = {'G', 'O', 'L', '3', 'D', 'L', 'O', 'G'};
+
+// Byte offsets of the header fields. See StatsLog.h.
+static const long offsetVersion = 8;
+static const long offsetHeaderSize = 12;
+static const long offsetNumStates = 16;
+static const long offsetRowSize = 20;
+static const long offsetSeed = 24;
+static const long offsetMaxSteps = 32;
+static const long offsetLogEveryT = 36;
+static const long offsetLiveStates = 40;
+static const long offsetPeriod = 44;
+static const long offsetPeriodOnset = 48;
+static const long offsetFlags = 52;
+static const long offsetEndStatus = 56;
+static const long offsetRuleStringLength = 80;
+static const long offsetRuleString = 84;
+
+/**
+ * put()
+ * Copies a value into a byte buffer.
+ * @param buffer: The buffer.
+ * @param offset: Where in the buffer to put it.
+ * @param value: The value.
+ */
+template<typename T>
+static void put(std::vector<char> &buffer, long offset, T value) {
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+/**
+ * get()
+ * Reads a value out of a byte buffer.
+ * @param buffer: The buffer.
+ * @param offset: Where in the buffer to read it from.
+ */
+template<typename T>
+static T get(const std::vector<char> &buffer, long offset) {
+    T value;
+    std::memcpy(&value, buffer.data() + offset, sizeof(T));
+    return value;
+}
+
+StatsLog::~StatsLog() {
+    if(file != nullptr) {
+        fclose(file);
+    }
+}
+
+/**
+ * StatsLog.append()
+ * Appends one row.
+ * @param timeStep: Time step being recorded.
+ * @param numActiveCubes: Total number of active Cubes.
+ * @param stateCounts: Number of active Cubes in each state. Must have one
+ *                     entry per state.
+ */
+void StatsLog::append(int timeStep, int numActiveCubes, const std::vector<int> &stateCounts) {
+    auto row = (int32_t)timeStep;
+    fwrite(&row, sizeof(int32_t), 1, file);
+    row = (int32_t)numActiveCubes;
+    fwrite(&row, sizeof(int32_t), 1, file);
+    static_assert(sizeof(int) == sizeof(int32_t), "state counts are written as int32");
+    fwrite(stateCounts.data(), sizeof(int32_t), stateCounts.size(), file);
+}
+
+/**
+ * StatsLog.close()
+ * Fills in how the run ended, and closes the file.
+ * @param stats: The finished run's statistics.
+ */
+void StatsLog::close(const RunStats &stats) {
+    if(file == nullptr) {
+        return;
+    }
+
+    std::vector<char> fields(offsetRuleStringLength - offsetPeriod, 0);
+    put<int32_t>(fields, offsetPeriod - offsetPeriod, stats.period);
+    put<int32_t>(fields, offsetPeriodOnset - offsetPeriod, stats.periodOnset);
+    uint32_t flags = flagClosed | (stats.periodExact ? flagPeriodExact : 0);
+    put<uint32_t>(fields, offsetFlags - offsetPeriod, flags);
+    std::strncpy(fields.data() + (offsetEndStatus - offsetPeriod), stats.endStatus.c_str(), endStatusSize - 1);
+
+    fseek(file, offsetPeriod, SEEK_SET);
+    fwrite(fields.data(), 1, fields.size(), file);
+    fclose(file);
+    file = nullptr;
+}
+
+/**
+ * StatsLog.flush()
+ * Makes sure every row appended so far is in the file.
+ */
+void StatsLog::flush() {
+    if(file != nullptr) {
+        fflush(file);
+    }
+}
+
+/**
+ * StatsLog.isOpen()
+ * Checks whether a log is being written.
+ */
+bool StatsLog::isOpen() const {
+    return file != nullptr;
+}
+
+/**
+ * StatsLog.open()
+ * Creates a log file (and its directory, if needed) and writes its header.
+ * @param path: Path of the file to write.
+ * @param ruleString: String representation of the rule being run.
+ * @param liveStates: The rule's live states.
+ * @param numStates: The rule's number of states.
+ * @param seed: Seed of the run's initial conditions.
+ * @param maxSteps: Time step at which the run ends regardless.
+ * @param logEveryT: Time steps between rows.
+ */
+void StatsLog::open(const std::string &path,
+                    const std::string &ruleString,
+                    const std::set<int> &liveStates,
+                    int numStates,
+                    long long seed,
+                    int maxSteps,
+                    int logEveryT) {
+    if(file != nullptr) {
+        fclose(file);
+    }
+
+    fs::path filePath(path);
+    if(filePath.has_parent_path()) {
+        fs::create_directories(filePath.parent_path());
+    }
+    file = fopen(path.c_str(), "wb");
+    if(file == nullptr) {
+        throw std::runtime_error("Failed to open file for writing: " + path);
+    }
+
+    uint32_t liveStatesMask = 0;
+    for(int s : liveStates) {
+        if(s >= 0 && s < 32) {
+            liveStatesMask |= 1u << s;
+        }
+    }
+
+    // Pad the header so rows start 8-byte aligned.
+    auto headerSize = (uint32_t)((offsetRuleString + ruleString.size() + 7) / 8 * 8);
+    std::vector<char> header(headerSize, 0);
+    std::memcpy(header.data(), magic, sizeof(magic));
+    put<uint32_t>(header, offsetVersion, version);
+    put<uint32_t>(header, offsetHeaderSize, headerSize);
+    put<uint32_t>(header, offsetNumStates, (uint32_t)numStates);
+    put<uint32_t>(header, offsetRowSize, (uint32_t)(sizeof(int32_t) * (2 + numStates)));
+    put<int64_t>(header, offsetSeed, seed);
+    put<int32_t>(header, offsetMaxSteps, maxSteps);
+    put<int32_t>(header, offsetLogEveryT, logEveryT);
+    put<uint32_t>(header, offsetLiveStates, liveStatesMask);
+    put<int32_t>(header, offsetPeriodOnset, -1);
+    std::strncpy(header.data() + offsetEndStatus, "running", endStatusSize - 1);
+    put<uint32_t>(header, offsetRuleStringLength, (uint32_t)ruleString.size());
+    std::memcpy(header.data() + offsetRuleString, ruleString.data(), ruleString.size());
+
+    fwrite(header.data(), 1, header.size(), file);
+    fflush(file);
+}
+
+/**
+ * StatsLog.resume()
+ * Reopens an existing log file to carry on appending to it, dropping any rows
+ * past the first numRows, e.g. those written after a run's last checkpoint.
+ * @param path: Path of the file.
+ * @param numRows: Number of rows to keep.
+ */
+void StatsLog::resume(const std::string &path, size_t numRows) {
+    if(file != nullptr) {
+        fclose(file);
+        file = nullptr;
+    }
+
+    FILE *in = fopen(path.c_str(), "rb");
+    if(in == nullptr) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    std::vector<char> header(offsetRuleString);
+    bool valid = fread(header.data(), 1, header.size(), in) == header.size()
+            && std::memcmp(header.data(), magic, sizeof(magic)) == 0;
+    fclose(in);
+    if(!valid) {
+        throw std::runtime_error("Not a stats log: " + path);
+    }
+
+    auto size = get<uint32_t>(header, offsetHeaderSize) + numRows * get<uint32_t>(header, offsetRowSize);
+    if(size > fs::file_size(path)) {
+        throw std::runtime_error("Truncated stats log: " + path);
+    }
+    fs::resize_file(path, size);
+
+    file = fopen(path.c_str(), "r+b");
+    if(file == nullptr) {
+        throw std::runtime_error("Failed to open file for writing: " + path);
+    }
+    fseek(file, 0, SEEK_END);
+}
+
+/**
+ * StatsLog.read()
+ * Loads a log file back into a RunStats, e.g. to save it as JSON.
+ * @param path: Path of the file to read.
+ * @param stats: Receives the statistics.
+ * @param ruleString: Receives the rule string.
+ * @param liveStates: Receives the live states.
+ */
+void StatsLog::read(const std::string &path,
+                    RunStats &stats,
+                    std::string &ruleString,
+                    std::set<int> &liveStates) {
+    FILE *in = fopen(path.c_str(), "rb");
+    if(in == nullptr) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+
+    std::vector<char> header(offsetRuleString);
+    if(fread(header.data(), 1, header.size(), in) != header.size()
+            || std::memcmp(header.data(), magic, sizeof(magic)) != 0) {
+        fclose(in);
+        throw std::runtime_error("Not a stats log: " + path);
+    }
+    auto headerSize = get<uint32_t>(header, offsetHeaderSize);
+    auto numStates = (int)get<uint32_t>(header, offsetNumStates);
+
+    ruleString.assign(get<uint32_t>(header, offsetRuleStringLength), '\0');
+    if(fread(ruleString.data(), 1, ruleString.size(), in) != ruleString.size()) {
+        fclose(in);
+        throw std::runtime_error("Truncated stats log: " + path);
+    }
+
+    liveStates.clear();
+    auto liveStatesMask = get<uint32_t>(header, offsetLiveStates);
+    for(int s = 0; s < 32; ++s) {
+        if(liveStatesMask & (1u << s)) {
+            liveStates.insert(s);
+        }
+    }
+
+    stats.clear();
+    stats.maxTimeSteps = get<int32_t>(header, offsetMaxSteps);
+    stats.logEveryT = get<int32_t>(header, offsetLogEveryT);
+    stats.period = get<int32_t>(header, offsetPeriod);
+    stats.periodOnset = get<int32_t>(header, offsetPeriodOnset);
+    stats.periodExact = (get<uint32_t>(header, offsetFlags) & flagPeriodExact) != 0;
+    char endStatus[endStatusSize + 1] = {};
+    std::memcpy(endStatus, header.data() + offsetEndStatus, endStatusSize);
+    stats.endStatus = endStatus;
+
+    // A run that crashed leaves a partial last row, which is dropped.
+    fseek(in, headerSize, SEEK_SET);
+    std::vector<int32_t> row(2 + numStates);
+    while(fread(row.data(), sizeof(int32_t), row.size(), in) == row.size()) {
+        stats.timeStepLog.push_back(row[0]);
+        stats.activeCubeLog.push_back(row[1]);
+        stats.cubeStateLog.emplace_back(row.begin() + 2, row.end());
+    }
+    fclose(in);
+}
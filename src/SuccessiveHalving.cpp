@@ -0,0 +1,219 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "SuccessiveHalving.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+namespace fs = std::filesystem;
+
+/**
+ * SuccessiveHalving.work()
+ * Worker thread body for one round: runs rules from the round's list until
+ * none are left, scoring each on its run so far, and saving the results of
+ * the runs that finish.
+ * @param round: The round.
+ * @param untilTimeStep: Time step the round's runs stop at.
+ */
+void SuccessiveHalving::work(int round, int untilTimeStep) {
+    GeneralizedCellularAutomaton gol;
+    gol.init(glm::vec3(0, 0, 0), 0.5, options.initNumCubes);
+    RunStats stats;
+
+    size_t i;
+    while((i = nextRunning.fetch_add(1)) < running.size()) {
+        Candidate &candidate = candidates[running[i]];
+        int prevTimeStep = candidate.timeStep;
+        try {
+            if(round == 0) {
+                candidate.rule = parseRuleFromJson(candidate.ruleFile);
+            }
+            candidate.finished = BatchRunner::runRuleSlice(gol, candidate.rule, stats, options, untilTimeStep,
+                                                           candidate.checkpoint, candidate.elapsed);
+            candidate.ruleString = gol.ruleString;
+            candidate.round = round;
+            candidate.timeStep = stats.timeStepLog.empty() ? 0 : stats.timeStepLog.back();
+
+            RuleScore score;
+            if(candidate.finished) {
+                score = options.valueFunction.evaluate(stats);
+                fs::path savePath = fs::path(outDir) / fs::path(candidate.ruleFile).filename();
+                if(options.scoreOnly) {
+                    BatchRunner::saveScore(gol.ruleString, stats, score, savePath.string());
+                } else {
+                    stats.save(gol.ruleString, gol.liveStates, savePath.string());
+                }
+            } else {
+                score = options.valueFunction.evaluate(
+                        stats.activeCubeLog, candidate.timeStep, stats.maxTimeSteps, "continue");
+            }
+            candidate.endStatus = stats.endStatus;
+            candidate.value = score.value;
+            candidate.scored = score.hasLosses;
+
+        } catch(const std::exception &e) {
+            candidate.failed = true;
+            candidate.checkpoint.clear();
+            ++numFailed;
+            std::lock_guard<std::mutex> lock(printMutex);
+            printf("%s: %s\n", candidate.ruleFile.c_str(), e.what());
+            continue;
+        }
+        numTimeSteps += candidate.timeStep - prevTimeStep;
+
+        std::lock_guard<std::mutex> lock(printMutex);
+        printf("[round %i, %zu/%zu] %s: %s at time step %i, value %g\n", round, i + 1, running.size(),
+               candidate.ruleFile.c_str(), candidate.endStatus.c_str(), candidate.timeStep, candidate.value);
+    }
+}
+
+/**
+ * SuccessiveHalving.writeRanking()
+ * Writes ranking.json, listing the rules from best to worst: those that got
+ * through more rounds first, and within a round, by value.
+ */
+void SuccessiveHalving::writeRanking() const {
+    std::vector<size_t> order;
+    for(size_t i = 0; i < candidates.size(); ++i) {
+        if(!candidates[i].failed) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        const Candidate &ca = candidates[a];
+        const Candidate &cb = candidates[b];
+        if(ca.round != cb.round) {
+            return ca.round > cb.round;
+        }
+        if(ca.scored != cb.scored) {
+            return ca.scored;
+        }
+        if(ca.value != cb.value) {
+            return ca.value > cb.value;
+        }
+        return a < b;
+    });
+
+    json ranking = json::array();
+    for(size_t rank = 0; rank < order.size(); ++rank) {
+        const Candidate &candidate = candidates[order[rank]];
+        json entry = {
+            {"rank", rank},
+            {"file", candidate.ruleFile},
+            {"rule_string", candidate.ruleString},
+            {"round", candidate.round},
+            {"time_step", candidate.timeStep},
+            {"end_status", candidate.finished ? candidate.endStatus : "eliminated"},
+            {"value", nullptr}
+        };
+        if(candidate.scored) {
+            entry["value"] = candidate.value;
+        }
+        ranking.push_back(entry);
+    }
+
+    std::ofstream file((fs::path(outDir) / "ranking.json").string());
+    if(!file) {
+        throw std::runtime_error("Could not write ranking to " + outDir);
+    }
+    file << ranking.dump(2);
+}
+
+/**
+ * SuccessiveHalving.run()
+ * Runs the search. Each round runs the rules still in the running, spread
+ * over the workers, to the round's horizon. Runs that finish (by ending, or
+ * hitting a limit) are final; of the rest, the best 1/eta by value so far go
+ * on to the next round, whose horizon is eta times longer. The last round's
+ * horizon is the full run length, RunStats.maxTimeSteps.
+ */
+void SuccessiveHalving::run() {
+    if(eta < 2) {
+        throw std::runtime_error("Successive halving needs eta >= 2");
+    }
+    if(outDir.empty()) {
+        throw std::runtime_error("No output directory for successive halving");
+    }
+    fs::create_directories(outDir);
+
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+
+    candidates.assign(ruleFiles.size(), Candidate());
+    running.clear();
+    for(size_t i = 0; i < ruleFiles.size(); ++i) {
+        candidates[i].ruleFile = ruleFiles[i];
+        running.push_back(i);
+    }
+
+    int numWorkers = options.numWorkers;
+    if(numWorkers <= 0) {
+        numWorkers = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    const int maxTimeSteps = RunStats().maxTimeSteps;
+
+    long long horizon = std::max(firstHorizon, 1);
+    for(int round = 0; !running.empty(); ++round) {
+        bool lastRound = horizon >= maxTimeSteps;
+        int untilTimeStep = lastRound ? std::numeric_limits<int>::max() : (int)horizon;
+
+        nextRunning = 0;
+        std::vector<std::thread> workers;
+        int roundWorkers = (int)std::min((size_t)numWorkers, running.size());
+        for(int i = 0; i < roundWorkers; ++i) {
+            workers.emplace_back(&SuccessiveHalving::work, this, round, untilTimeStep);
+        }
+        for(auto &worker : workers) {
+            worker.join();
+        }
+
+        // Rank the runs still going by value so far; runs too short to score
+        // go last.
+        std::vector<size_t> going;
+        for(size_t i : running) {
+            if(!candidates[i].finished && !candidates[i].failed) {
+                going.push_back(i);
+            }
+        }
+        std::sort(going.begin(), going.end(), [this](size_t a, size_t b) {
+            const Candidate &ca = candidates[a];
+            const Candidate &cb = candidates[b];
+            if(ca.scored != cb.scored) {
+                return ca.scored;
+            }
+            if(ca.value != cb.value) {
+                return ca.value > cb.value;
+            }
+            return a < b;
+        });
+
+        size_t numFinished = running.size() - going.size();
+        size_t numKept = (going.size() + eta - 1) / eta;
+        for(size_t k = numKept; k < going.size(); ++k) {
+            std::vector<char>().swap(candidates[going[k]].checkpoint);
+        }
+        going.resize(numKept);
+
+        printf("Round %i: ran %zu rules to time step %lli, %zu finished, %zu kept\n",
+               round, running.size(), lastRound ? (long long)maxTimeSteps : horizon,
+               numFinished, numKept);
+        running = std::move(going);
+        horizon *= eta;
+    }
+
+    writeRanking();
+
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+    printf("Simulated %lli time steps (full runs would take up to %lli) in %.1f s\n",
+           numTimeSteps.load(), (long long)maxTimeSteps * (long long)ruleFiles.size(), seconds);
+}
@@ -66,30 +66,36 @@ void User::computeRegionBounds() {
  */
 void User::copy() {
     if(state == selection) {
-        // Clear the clipBoard.
-        clipBoard.clear();
-
         // The current Object.
         Object *obj = (*activeObj);
 
         // Sets x0, x1, y0, y1, z0, z1.
         computeRegionBounds();
-
-        // Check each Cube in the currentRegion, indexed by their centers.
-        glm::ivec3 center;
-        for (int x = x0; x <= x1; ++x) {
-            center.x = x;
-            for (int y = y0; y <= y1; ++y) {
-                center.y = y;
-                for (int z = z0; z <= z1; ++z) {
-                    center.z = z;
-                    // Save any non-dead Cubes, in region-relative coordinates.
-                    if (obj->findIn(obj->drawCubes, center)) {
-                        clipBoard.insert({center - currentRegion[0], obj->activeCubes[center]->state});
+        glm::ivec3 lower(x0, y0, z0);
+        glm::ivec3 upper(x1, y1, z1);
+        glm::ivec3 corner = currentRegion[0];
+
+        // The Object owns its Cubes, so read them from a posted command.
+        obj->post([this, obj, lower, upper, corner] {
+            // Clear the clipBoard.
+            clipBoard.clear();
+
+            // Check each Cube in the region, indexed by their centers.
+            glm::ivec3 center;
+            for (int x = lower.x; x <= upper.x; ++x) {
+                center.x = x;
+                for (int y = lower.y; y <= upper.y; ++y) {
+                    center.y = y;
+                    for (int z = lower.z; z <= upper.z; ++z) {
+                        center.z = z;
+                        // Save any non-dead Cubes, in region-relative coordinates.
+                        if (obj->findIn(obj->drawCubes, center)) {
+                            clipBoard.insert({center - corner, obj->activeCubes[center]->state});
+                        }
                     }
                 }
             }
-        }
+        });
     }
 }
 
@@ -113,21 +119,62 @@ void User::deleteRegion() {
 
         // Get the bounds of the current region.
         computeRegionBounds();
+        glm::ivec3 lower(x0, y0, z0);
+        glm::ivec3 upper(x1, y1, z1);
 
         // Iterate through the region. Remove any non-dead Cubes.
-        glm::ivec3 center;
-        for (int x = x0; x <= x1; ++x) {
-            center.x = x;
-            for (int y = y0; y <= y1; ++y) {
-                center.y = y;
-                for (int z = z0; z <= z1; ++z) {
-                    center.z = z;
-                    if (obj->findIn(obj->drawCubes, center)) {
-                        obj->setCube(obj->activeCubes[center], 0);
+        obj->post([obj, lower, upper] {
+            glm::ivec3 center;
+            for (int x = lower.x; x <= upper.x; ++x) {
+                center.x = x;
+                for (int y = lower.y; y <= upper.y; ++y) {
+                    center.y = y;
+                    for (int z = lower.z; z <= upper.z; ++z) {
+                        center.z = z;
+                        if (obj->findIn(obj->drawCubes, center)) {
+                            obj->setCube(obj->activeCubes[center], 0);
+                        }
                     }
                 }
             }
+        });
+    }
+}
+
+/**
+ * User.beginDraw()
+ * Decides what kind of Cube to draw, based on the state of the Cube under the
+ * cursor when drawing starts. Runs as a command posted to the Object.
+ * @param obj: The Object being drawn in.
+ * @param key: Logical coordinates of the draw cursor.
+ */
+void User::beginDraw(GeneralizedCellularAutomaton *obj, glm::ivec3 key) {
+    if(obj->findIn(obj->activeCubes, key)) {
+        // The Cube under the cursor is already in activeCubes.
+        Cube *c = obj->activeCubes[key];
+
+        if(c->state == 1) {
+            // Cube *c is live.
+            if (obj->numStates == 2) {
+                // Game of Life mode, next state is dead.
+                drawDead = true;
+            } else {
+                // Brian's brain mode, next state is dying.
+                drawDying = true;
+            }
+
+        } else if(c->state == 2) {
+            // Cube *c is dying, next state is dead.
+            drawDead = true;
+
+        } else {
+            // Cube *c is dead, next state is dying.
+            drawLive = true;
         }
+    } else {
+        // The Cube under the cursor is not already in activeCubes. So it's
+        // dead, so draw live Cubes.
+        drawLive = true;
     }
 }
 
@@ -189,6 +236,67 @@ void User::draw() {
     }
 }
 
+/**
+ * User.drawAt()
+ * Draws a Cube at the cursor, as decided by beginDraw(). Runs as a command
+ * posted to the Object.
+ * @param obj: The Object being drawn in.
+ * @param key: Logical coordinates of the draw cursor.
+ */
+void User::drawAt(GeneralizedCellularAutomaton *obj, glm::ivec3 key) {
+    // Indicates whether the Cube at the cursor location is in activeCubes
+    bool inMap = obj->findIn(obj->activeCubes, key);
+
+    // Draw live Cubes at the cursor.
+    if(drawLive) {
+        if(inMap) {
+            // Access the Cube.
+            Cube *c = obj->activeCubes[key];
+
+            if(c->state != 1) {
+                // Only do something if the Cube is not live.
+                obj->setCube(c, 1);
+            }
+        } else {
+            // No Cube in the activeCubes at the cursor. Create it, then set its
+            // state.
+            obj->add(key.x, key.y, key.z);
+            obj->setCube(obj->activeCubes[key], 1);
+        }
+
+    // Draw dying Cubes at the Cursor.
+    } else if(drawDying) {
+        if(inMap) {
+            // Access the Cube.
+            Cube *c = obj->activeCubes[key];
+
+            if(c->state != 2) {
+                // Only do something if the Cube is not dying.
+                obj->setCube(c, 2);
+            }
+        } else {
+            // No Cube in activeCubes at the cursor. Create it, then set its state.
+            obj->add(key.x, key.y, key.z);
+            obj->setCube(obj->activeCubes[key], 2);
+        }
+    }
+
+    // Draw dead Cubes at the cursor.
+    if(drawDead) {
+        if(inMap) {
+            // Access the Cube.
+            Cube *c = obj->activeCubes[key];
+
+            if(c->state != 0) {
+                // Only do something if the Cube isn't dead
+                obj->setCube(c, 0);
+            }
+        }
+        // No need to add a new Cube if the Cube under the cursor isn't
+        // in activeCubes, since it'd just be dead.
+    }
+}
+
 /**
  * User.handleInput()
  * Handles user input.
@@ -265,7 +373,8 @@ void User::handleInput() {
 
     // Enter or exit edit mode.
     if(io.toggled(GLFW_KEY_F)) {
-        (*activeObj)->state = stop;
+        Object *obj = (*activeObj);
+        obj->post([obj] { obj->state = stop; });
         if(state == move) {
             state = edit;
         } else {
@@ -329,9 +438,11 @@ void User::handleInput() {
     }
     // Stop drawing.
     if(io.released(GLFW_KEY_SPACE)) {
-        drawLive = false;
-        drawDead = false;
-        drawDying = false;
+        (*activeObj)->post([this] {
+            drawLive = false;
+            drawDead = false;
+            drawDying = false;
+        });
     }
 
     // Create a Cube cube.
@@ -446,8 +557,13 @@ void User::makeCubes() {
     // Only do it in edit mode.
     if(state == edit) {
         auto obj = dynamic_cast<GeneralizedCellularAutomaton*>(*activeObj);
+        int hwidth = cubeHwidth;
+        std::vector<float> probs = *cubeCubeProbs;
+        glm::ivec3 center = drawCursor;
 //        obj->cubeCube(cubeHwidth, {0.05f, 0, 0.05f, 0}, drawCursor);
-        obj->cubeCube(cubeHwidth, *cubeCubeProbs, drawCursor);
+        obj->post([obj, hwidth, probs, center] {
+            obj->cubeCube(hwidth, probs, center);
+        });
     }
 }
 
@@ -457,16 +573,18 @@ void User::makeCubes() {
  * drawCursor.
  */
 void User::paste() {
-    if(!clipBoard.empty()) {
-        auto obj = dynamic_cast<GeneralizedCellularAutomaton*>(*activeObj);
+    auto obj = dynamic_cast<GeneralizedCellularAutomaton*>(*activeObj);
+    glm::ivec3 cursor = drawCursor;
 
+    // The clipBoard is filled by posted commands, so read it from one too.
+    obj->post([this, obj, cursor] {
         for(auto & it : clipBoard) {
-            glm::ivec3 center = drawCursor + it.first;
+            glm::ivec3 center = cursor + it.first;
             int cubeState = it.second;
             obj->add(center.x, center.y, center.z);
             obj->setCube(obj->activeCubes[center], cubeState);
         }
-    }
+    });
 }
 
 /**
@@ -533,89 +651,16 @@ void User::updateEdit() {
     // activeCubes index of the cursor location.
     auto key = glm::ivec3(drawCursor.x, drawCursor.y, drawCursor.z);
 
-    // Indicates whether the Cube at the cursor location is in activeCubes
-    bool inMap = obj->findIn(obj->activeCubes, key);
-
+    // The Object owns its Cubes, so drawing is done by posted commands.
     // Initialize drawing.
     if(drawStart) {
         drawStart = false;
-
-        if(inMap) {
-            // The Cube under the cursor is already in activeCubes.
-            Cube *c = obj->activeCubes[key];
-
-            if(c->state == 1) {
-                // Cube *c is live.
-                if (obj->numStates == 2) {
-                    // Game of Life mode, next state is dead.
-                    drawDead = true;
-                } else {
-                    // Brian's brain mode, next state is dying.
-                    drawDying = true;
-                }
-
-            } else if(c->state == 2) {
-                // Cube *c is dying, next state is dead.
-                drawDead = true;
-
-            } else {
-                // Cube *c is dead, next state is dying.
-                drawLive = true;
-            }
-        } else {
-            // The Cube under the cursor is not already in activeCubes. So it's
-            // dead, so draw live Cubes.
-            drawLive = true;
-        }
-    }
-
-    // Draw live Cubes at the cursor.
-    if(drawLive) {
-        if(inMap) {
-            // Access the Cube.
-            Cube *c = obj->activeCubes[key];
-
-            if(c->state != 1) {
-                // Only do something if the Cube is not live.
-                obj->setCube(c, 1);
-            }
-        } else {
-            // No Cube in the activeCubes at the cursor. Create it, then set its
-            // state.
-            obj->add(drawCursor.x, drawCursor.y, drawCursor.z);
-            obj->setCube(obj->activeCubes[key], 1);
-        }
-
-    // Draw dying Cubes at the Cursor.
-    } else if(drawDying) {
-        if(inMap) {
-            // Access the Cube.
-            Cube *c = obj->activeCubes[key];
-
-            if(c->state != 2) {
-                // Only do something if the Cube is not dying.
-                obj->setCube(c, 2);
-            }
-        } else {
-            // No Cube in activeCubes at the cursor. Create it, then set its state.
-            obj->add(drawCursor.x, drawCursor.y, drawCursor.z);
-            obj->setCube(obj->activeCubes[key], 2);
-        }
+        obj->post([this, obj, key] { beginDraw(obj, key); });
     }
 
-    // Draw dead Cubes at the cursor.
-    if(drawDead) {
-        if(inMap) {
-            // Access the Cube.
-            Cube *c = obj->activeCubes[key];
-
-            if(c->state != 0) {
-                // Only do something if the Cube isn't dead
-                obj->setCube(c, 0);
-            }
-        }
-        // No need to add a new Cube if the Cube under the cursor isn't
-        // in activeCubes, since it'd just be dead.
+    // Keep drawing while Space is held.
+    if(io.pressed(GLFW_KEY_SPACE)) {
+        obj->post([this, obj, key] { drawAt(obj, key); });
     }
 }
 
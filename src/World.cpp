@@ -5,12 +5,14 @@
 
 #include <SOIL/SOIL.h>
 
+#include "Checkpoint.h"
 #include "global.h"
 #include "opengl-debug.h"
 
 World::World() :
         io(IO::getInstance()),
-        cam(Camera::getInstance()) {}
+        cam(Camera::getInstance()),
+        activeObject(nullptr) {}
 
 World::~World() {
     glDisableVertexAttribArray(2);
@@ -54,30 +56,35 @@ void World::draw(float t) {
     scales.clear();
     types.clear();
 
-    // Iterate through the Objects in objects.
+    // Iterate through the Objects in objects, drawing each from its latest
+    // published snapshot.
     for(auto &obj : objects) {
-        for(auto it = obj->drawCubes.begin(); it != obj->drawCubes.end(); ++it) {
-            Cube *c = it->second;
-            auto translation = obj->origin + glm::vec3(c->center) * obj->scale2;
+        const RenderSnapshot &snapshot = obj->latestSnapshot();
+        for(auto &c : snapshot.cubes) {
+            // Skip slots freed since the snapshot's Cubes were last rebuilt.
+            if(c.state == 0) {
+                continue;
+            }
+            auto translation = obj->origin + glm::vec3(c.center) * obj->scale2;
             glm::vec3 vecToCamera = translation - cam.position;
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "IncompatibleTypes"
             float d2ToCamera = glm::dot(vecToCamera, vecToCamera);
 #pragma clang diagnostic pop
 
-            // Draw *c if it's close enough to the Camera.
+            // Draw c if it's close enough to the Camera.
             if(d2ToCamera < camDist2) {
                 translations.push_back(translation);
                 scales.push_back(obj->scale);
                 // Different texture for dying Cubes.
-                if(c->state == 2) {
+                if(c.state == 2) {
                     types.push_back(state2Tex);
-                } else if (c->state == 3) {
+                } else if (c.state == 3) {
                     types.push_back(state3Tex);
-                } else if (c->state == 4) {
+                } else if (c.state == 4) {
                     types.push_back(state4Tex);
                 } else {
-                    types.push_back(c->texBase);
+                    types.push_back(c.texBase);
                 }
 
                 drawCount++;
@@ -142,6 +149,54 @@ void World::handleInput() {
     if(io.toggled(GLFW_KEY_N)) {
         varyColor = 1.f - varyColor;
     }
+
+    // Active Object state changes use keys 1, 3, 4, E, R, O. The Objects post
+    // them, to be applied by whichever thread is running the update cycle.
+    if(activeObject != nullptr) {
+        if(io.toggled(GLFW_KEY_1)) {
+            activeObject->setRunState(stop);
+
+        } else if(io.toggled(GLFW_KEY_3)) {
+            activeObject->setRunState(run);
+
+        } else if(io.toggled(GLFW_KEY_E)) {
+            // Step forward one step, if stopped.
+            activeObject->setRunState(step);
+
+        } else if(io.toggled(GLFW_KEY_R)) {
+            // Reset.
+            Object *obj = activeObject;
+            obj->post([obj] { obj->reset(); });
+
+        } else if(io.toggled(GLFW_KEY_4)) {
+            // Fast-forward, or cancel the fast-forward in progress.
+            if(activeObject->fastForwardLeft.load() > 0) {
+                activeObject->cancelFastForward();
+            } else {
+                activeObject->fastForward(activeObject->fastForwardGenerations);
+            }
+        }
+
+        // Save a Checkpoint of the active GCA with O, or load one with Shift+O.
+        auto gca = dynamic_cast<GeneralizedCellularAutomaton*>(activeObject);
+        if(gca != nullptr && io.toggled(GLFW_KEY_O)) {
+            bool load = io.pressed(GLFW_KEY_LEFT_SHIFT);
+            std::string path = checkpointFile;
+            gca->post([gca, path, load] {
+                try {
+                    if(load) {
+                        Checkpoint::load(*gca, path);
+                        printf("Loaded checkpoint %s (generation %i).\n", path.c_str(), gca->generation);
+                    } else {
+                        Checkpoint::save(*gca, path);
+                        printf("Saved checkpoint %s (generation %i).\n", path.c_str(), gca->generation);
+                    }
+                } catch(const std::exception &e) {
+                    printf("Checkpoint %s: %s\n", path.c_str(), e.what());
+                }
+            });
+        }
+    }
 }
 
 /**
@@ -236,12 +291,17 @@ void World::initGL() {
 
 /**
  * World.update()
- * Updates all the Objects in the World.
+ * Handles input and, unless a Simulation thread is running, updates all the
+ * Objects in the World.
  */
 void World::update() {
+    // Input becomes posted commands, so this is safe while threaded.
     handleInput();
 
-    for(auto &obj : objects) {
-        obj->update();
+    // Otherwise the Simulation thread runs the update cycle.
+    if(!threaded) {
+        for(auto &obj : objects) {
+            obj->update();
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,374 @@
+//
+// Created by matt on 10/18/26.
+//
+#include "gol3d.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "BrickWorld.h"
+#include "GeneralizedCellularAutomaton.h"
+#include "Rule.h"
+
+struct gol3d_automaton {
+    GeneralizedCellularAutomaton gol;
+    bool hasRule = false;
+};
+
+struct gol3d_world {
+    BrickWorld world;
+};
+
+// The calling thread's last error.
+static thread_local std::string lastError;
+
+/**
+ * guard()
+ * Runs an API call's body, turning exceptions into a -1 return and the
+ * thread's last error, so none cross the C boundary.
+ * @param gol: The automaton (or world) the call is on, checked for null.
+ * @param body: The call's body, returning the call's result.
+ * @param name: What gol is, for the error if it's null.
+ */
+template<typename Automaton, typename Body>
+static auto guard(Automaton *gol, Body body, const char *name = "automaton") -> decltype(body()) {
+    try {
+        if(!gol) {
+            throw std::invalid_argument(std::string("Null ") + name);
+        }
+        return body();
+    } catch(const std::exception &e) {
+        lastError = e.what();
+    } catch(...) {
+        lastError = "Unknown error";
+    }
+    return -1;
+}
+
+/**
+ * setRule()
+ * Gives an automaton a rule, clearing it.
+ * @param automaton: The automaton.
+ * @param rule: The rule.
+ */
+static void setRule(gol3d_automaton *automaton, const Rule &rule) {
+    int numStates = (int)rule.table.size();
+    if(numStates < 2) {
+        throw std::invalid_argument("A rule needs at least 2 states");
+    }
+    for(auto &row : rule.table) {
+        if((int)row.size() != numStates) {
+            throw std::invalid_argument("The rule table isn't square");
+        }
+        GeneralizedCellularAutomaton::parseRuleRow(row);
+    }
+    for(int state : rule.liveStates) {
+        if(state < 0 || state >= numStates) {
+            throw std::invalid_argument("Live state " + std::to_string(state) + " out of range");
+        }
+    }
+
+    GeneralizedCellularAutomaton &gol = automaton->gol;
+    gol.reset();
+    gol.setRule(rule.table, rule.liveStates);
+    automaton->hasRule = true;
+}
+
+/**
+ * requireRule()
+ * Throws unless an automaton has a rule.
+ * @param automaton: The automaton.
+ */
+static void requireRule(const gol3d_automaton *automaton) {
+    if(!automaton->hasRule) {
+        throw std::logic_error("The automaton has no rule");
+    }
+}
+
+int gol3d_api_version(void) {
+    return GOL3D_API_VERSION;
+}
+
+const char *gol3d_last_error(void) {
+    return lastError.c_str();
+}
+
+gol3d_automaton *gol3d_create(int initNumCubes) {
+    try {
+        auto *automaton = new gol3d_automaton();
+        GeneralizedCellularAutomaton &gol = automaton->gol;
+        gol.init(glm::vec3(0, 0, 0), 0.5, initNumCubes > 0 ? initNumCubes : 100000);
+        // Nothing draws, so skip building render snapshots.
+        gol.publishSnapshots = false;
+        return automaton;
+    } catch(const std::exception &e) {
+        lastError = e.what();
+        return nullptr;
+    }
+}
+
+void gol3d_destroy(gol3d_automaton *gol) {
+    delete gol;
+}
+
+int gol3d_set_rule_json(gol3d_automaton *gol, const char *json) {
+    return guard(gol, [&]() {
+        setRule(gol, parseRuleFromJsonText(json ? json : ""));
+        return 0;
+    });
+}
+
+int gol3d_set_rule_file(gol3d_automaton *gol, const char *path) {
+    return guard(gol, [&]() {
+        setRule(gol, parseRuleFromJson(path ? path : ""));
+        return 0;
+    });
+}
+
+int gol3d_set_rule_table(gol3d_automaton *gol, int numStates, const int *table,
+                         const int *liveStates, int numLiveStates) {
+    return guard(gol, [&]() {
+        if(numStates < 2 || !table || numLiveStates < 0 || (numLiveStates > 0 && !liveStates)) {
+            throw std::invalid_argument("Invalid rule table");
+        }
+        Rule rule;
+        for(int s = 0; s < numStates; ++s) {
+            std::vector<int> row(table + s * 27, table + (s + 1) * 27);
+            for(int next : row) {
+                if(next < 0 || next >= numStates) {
+                    throw std::invalid_argument("Next state " + std::to_string(next) + " out of range");
+                }
+            }
+            rule.table.push_back(formatRuleRow(row, numStates));
+        }
+        rule.liveStates.insert(liveStates, liveStates + numLiveStates);
+        setRule(gol, rule);
+        return 0;
+    });
+}
+
+int gol3d_seed_soup(gol3d_automaton *gol, int hwidth, const float *probs, int numProbs, long long seed) {
+    return guard(gol, [&]() {
+        requireRule(gol);
+        if(hwidth < 0 || numProbs < 1 || numProbs >= gol->gol.numStates || !probs) {
+            throw std::invalid_argument("Invalid soup");
+        }
+        gol->gol.reset();
+        gol->gol.cubeCube(hwidth, std::vector<float>(probs, probs + numProbs), glm::ivec3(0, 0, 0), seed);
+        return 0;
+    });
+}
+
+int gol3d_set_cells(gol3d_automaton *gol, const int *xyz, const int *states, long long numCells) {
+    return guard(gol, [&]() {
+        requireRule(gol);
+        if(numCells < 0 || (numCells > 0 && (!xyz || !states))) {
+            throw std::invalid_argument("Invalid cells");
+        }
+        GeneralizedCellularAutomaton &g = gol->gol;
+        for(long long i = 0; i < numCells; ++i) {
+            if(states[i] < 0 || states[i] >= g.numStates) {
+                throw std::invalid_argument("State " + std::to_string(states[i]) + " out of range");
+            }
+        }
+        for(long long i = 0; i < numCells; ++i) {
+            glm::ivec3 position(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]);
+            auto cube = g.activeCubes.find(position);
+            if(cube == g.activeCubes.end()) {
+                if(states[i] == 0) {
+                    continue;
+                }
+                g.add(position.x, position.y, position.z);
+                cube = g.activeCubes.find(position);
+            }
+            g.setCube(cube->second, states[i]);
+        }
+        g.recomputeStateCounts();
+        return 0;
+    });
+}
+
+int gol3d_step(gol3d_automaton *gol, int numGenerations) {
+    return guard(gol, [&]() {
+        requireRule(gol);
+        GeneralizedCellularAutomaton &g = gol->gol;
+        g.active = true;
+        g.state = ObjectState::run;
+        int target = g.generation + std::max(numGenerations, 0);
+        while(g.generation < target || g.cycleStage != 0) {
+            g.update();
+        }
+        g.state = ObjectState::stop;
+        return 0;
+    });
+}
+
+int gol3d_generation(const gol3d_automaton *gol) {
+    return guard(gol, [&]() {
+        return gol->gol.generation;
+    });
+}
+
+int gol3d_num_states(const gol3d_automaton *gol) {
+    return guard(gol, [&]() {
+        requireRule(gol);
+        return gol->gol.numStates;
+    });
+}
+
+uint64_t gol3d_config_hash(const gol3d_automaton *gol) {
+    return gol ? gol->gol.configHash : 0;
+}
+
+int gol3d_state_counts(const gol3d_automaton *gol, int *counts, int capacity) {
+    return guard(gol, [&]() {
+        requireRule(gol);
+        const std::vector<int> &stateCounts = gol->gol.stateCounts;
+        if(counts) {
+            std::copy_n(stateCounts.begin(), std::min(capacity, (int)stateCounts.size()), counts);
+        }
+        return (int)stateCounts.size();
+    });
+}
+
+long long gol3d_cells(const gol3d_automaton *gol, int *xyz, int *states, long long capacity) {
+    return guard(gol, [&]() {
+        long long numCells = 0;
+        for(auto &entry : gol->gol.activeCubes) {
+            const Cube *c = entry.second;
+            if(c->state == 0) {
+                continue;
+            }
+            if(numCells < capacity) {
+                if(xyz) {
+                    xyz[3 * numCells] = c->center.x;
+                    xyz[3 * numCells + 1] = c->center.y;
+                    xyz[3 * numCells + 2] = c->center.z;
+                }
+                if(states) {
+                    states[numCells] = c->state;
+                }
+            }
+            ++numCells;
+        }
+        return numCells;
+    });
+}
+
+long long gol3d_bounds(const gol3d_automaton *gol, int *lo, int *hi) {
+    return guard(gol, [&]() {
+        glm::ivec3 boxLo, boxHi;
+        if(gol->gol.bounds(boxLo, boxHi)) {
+            for(int i = 0; i < 3; ++i) {
+                if(lo) {
+                    lo[i] = boxLo[i];
+                }
+                if(hi) {
+                    hi[i] = boxHi[i];
+                }
+            }
+        }
+        return (long long)gol->gol.drawCubes.size();
+    });
+}
+
+int gol3d_rasterize(const gol3d_automaton *gol, const int *lo, const int *size, uint8_t *out, int numThreads) {
+    return guard(gol, [&]() {
+        if(!lo || !size || size[0] < 0 || size[1] < 0 || size[2] < 0 ||
+           (!out && (long long)size[0] * size[1] * size[2] > 0)) {
+            throw std::invalid_argument("Invalid box");
+        }
+        gol->gol.rasterize(glm::ivec3(lo[0], lo[1], lo[2]), glm::ivec3(size[0], size[1], size[2]), out,
+                           numThreads);
+        return 0;
+    });
+}
+
+int gol3d_rule_string(const gol3d_automaton *gol, char *buffer, int capacity) {
+    return guard(gol, [&]() {
+        const std::string &ruleString = gol->gol.ruleString;
+        if(buffer && capacity > 0) {
+            snprintf(buffer, (size_t)capacity, "%s", ruleString.c_str());
+        }
+        return (int)ruleString.size();
+    });
+}
+
+gol3d_world *gol3d_capture(gol3d_automaton *gol) {
+    try {
+        if(!gol) {
+            throw std::invalid_argument("Null automaton");
+        }
+        requireRule(gol);
+        return new gol3d_world{BrickWorld::capture(gol->gol)};
+    } catch(const std::exception &e) {
+        lastError = e.what();
+        return nullptr;
+    }
+}
+
+gol3d_world *gol3d_world_fork(const gol3d_world *world) {
+    try {
+        if(!world) {
+            throw std::invalid_argument("Null world");
+        }
+        return new gol3d_world{world->world.fork()};
+    } catch(const std::exception &e) {
+        lastError = e.what();
+        return nullptr;
+    }
+}
+
+void gol3d_world_destroy(gol3d_world *world) {
+    delete world;
+}
+
+int gol3d_world_set_cells(gol3d_world *world, const int *xyz, const int *states, long long numCells) {
+    return guard(world, [&]() {
+        if(numCells < 0 || (numCells > 0 && (!xyz || !states))) {
+            throw std::invalid_argument("Invalid cells");
+        }
+        int numStates = (int)world->world.stateCounts.size();
+        for(long long i = 0; i < numCells; ++i) {
+            if(states[i] < 0 || states[i] >= numStates) {
+                throw std::invalid_argument("State " + std::to_string(states[i]) + " out of range");
+            }
+        }
+        for(long long i = 0; i < numCells; ++i) {
+            world->world.set(glm::ivec3(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]), states[i]);
+        }
+        return 0;
+    }, "world");
+}
+
+int gol3d_restore(gol3d_automaton *gol, const gol3d_world *world) {
+    return guard(gol, [&]() {
+        if(!world) {
+            throw std::invalid_argument("Null world");
+        }
+        world->world.restore(gol->gol);
+        gol->hasRule = true;
+        return 0;
+    });
+}
+
+long long gol3d_world_memory_usage(const gol3d_world *world) {
+    return guard(world, [&]() {
+        return (long long)world->world.memoryUsage();
+    }, "world");
+}
+
+long long gol3d_world_num_bricks(const gol3d_world *world) {
+    return guard(world, [&]() {
+        return (long long)world->world.getBricks().size();
+    }, "world");
+}
+
+long long gol3d_world_num_shared_bricks(const gol3d_world *world) {
+    return guard(world, [&]() {
+        return (long long)world->world.numSharedBricks();
+    }, "world");
+}
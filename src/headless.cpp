@@ -0,0 +1,364 @@
+//
+// Created by matt on 10/18/26.
+//
+// Headless rule runner. Runs rules and saves their population statistics,
+// without creating a window or touching OpenGL.
+//
+// One rule:
+//     gol3d_headless [options] <rule.json> <save.json>
+//
+// A batch of rules, each a rule file or a directory of them, run concurrently.
+// Results go to <out-dir>, named after their rule files:
+//     gol3d_headless --batch --out <out-dir> [options] <rules>...
+//
+// Search N random rules with S states in one pipeline (generate, prefilter,
+// simulate, rank), writing a summary line per rule and the best rules to
+// <out-dir>:
+//     gol3d_headless --search N --out <out-dir> [--states S] [options]
+//
+// Evolve rules for G generations from random rules with S states (and any
+// given rules), writing their lineage and the best rules to <out-dir>:
+//     gol3d_headless --evolve G --out <out-dir> [--states S] [options] [<rules>...]
+//
+// Take a census of the objects each rule leaves behind in N random soups,
+// writing a report per rule to <out-dir>:
+//     gol3d_headless --census N --out <out-dir> [options] <rules>...
+//
+// Convert a binary stats log to the JSON results format:
+//     gol3d_headless --convert <stats.gstats> <save.json>
+//
+// Options:
+//     --workers N           Worker threads (default: one per hardware thread).
+//     --time-limit S        Per-rule wall-clock limit, in seconds.
+//     --memory-limit MB     Per-rule memory limit, in megabytes.
+//     --seed S              Seed for the initial cube of Cubes.
+//     --score-only          Save just each rule's score breakdown.
+//     --binary              Save statistics as binary logs (.gstats) as runs go.
+//     --checkpoint-every N  Save a checkpoint every N generations.
+//     --resume              Resume runs from their checkpoints, and skip rules
+//                           that already have results.
+//     --cache DIR           Reuse results of equivalent rules cached in DIR,
+//                           and cache new ones there (needs --seed).
+//     --ensemble K          Run each rule with K seeds, and save a summary
+//                           (batch mode).
+//     --unanimous N         Stop an ensemble once N runs agree on how they end.
+//     --torus N             Run rules many at a time on an N^3 torus (batch mode).
+//     --model FILE          Value model (from learn_rule_value.py) to prefilter
+//                           rules with, in batch mode. Only rules predicted at
+//                           least --min-predicted V, and among the --top-k K
+//                           best, are run.
+//     --generate N          Also generate N random rules with --states S states
+//                           (default 5), keeping the ones the prefilter passes
+//                           in <out-dir>/rules (batch mode).
+//     --halving ETA         Rank the batch by successive halving instead of
+//                           running every rule in full: each round keeps the
+//                           best 1/ETA of the runs still going and runs them
+//                           ETA times longer, from where they stopped.
+//     --first-horizon T     Time step the first halving round runs to
+//                           (default 250).
+//     --population N        Rules run per generation of an evolution
+//                           (default 32).
+//     --parents M           Best rules kept as parents each generation
+//                           (default 8).
+//     --keep-top K          Number of best rules a search keeps (default 100).
+//     --stop-below V        Stop runs early once their value so far is below V.
+//     --damage              Also run a copy of each run with the Cube at the
+//                           origin flipped, and measure how the difference
+//                           spreads (single rules and plain batches).
+//     --detect-period       End runs once their population is periodic.
+//     --period-window N     Generations the period detector looks back over.
+//     --max-period N        Longest population period looked for, and in a
+//                           census, longest object period.
+//
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "BatchRunner.h"
+#include "RuleEvolution.h"
+#include "RuleSearch.h"
+#include "SoupCensus.h"
+#include "SuccessiveHalving.h"
+#include "StatsLog.h"
+
+void printUsage(const char *name) {
+    printf("Usage: %s [options] <rule.json> <save.json>\n", name);
+    printf("       %s --batch --out <out-dir> [options] <rule.json|rule-dir>...\n", name);
+    printf("       %s --search N --out <out-dir> [--states S] [options]\n", name);
+    printf("       %s --evolve G --out <out-dir> [--states S] [options] [<rule.json|rule-dir>...]\n", name);
+    printf("       %s --census N --out <out-dir> [options] <rule.json|rule-dir>...\n", name);
+    printf("       %s --convert <stats.gstats> <save.json>\n", name);
+    printf("Options: --workers N, --time-limit S, --memory-limit MB, --seed S, --score-only, --binary, --stop-below V,\n");
+    printf("         --checkpoint-every N, --resume, --cache DIR, --ensemble K, --unanimous N, --torus N,\n");
+    printf("         --model FILE, --min-predicted V, --top-k K, --generate N, --states S, --keep-top K,\n");
+    printf("         --halving ETA, --first-horizon T, --population N, --parents M,\n");
+    printf("         --damage, --detect-period, --period-window N, --max-period N\n");
+}
+
+int main(int argc, char **argv) {
+    BatchRunner batch;
+    bool batchMode = false;
+    bool convertMode = false;
+    size_t numGenerated = 0;
+    int generatedStates = 5;
+    size_t numSearched = 0;
+    int keepTop = 100;
+    int halvingEta = 0;
+    int firstHorizon = 250;
+    int numEvolved = -1;
+    int populationSize = 32;
+    int numParents = 8;
+    long long numCensusSoups = 0;
+    std::vector<std::string> positional;
+
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if(arg == "--batch") {
+            batchMode = true;
+        } else if(arg == "--convert") {
+            convertMode = true;
+        } else if(arg == "--binary") {
+            batch.options.binaryStats = true;
+        } else if(arg == "--out" && hasValue) {
+            batch.outDir = argv[++i];
+        } else if(arg == "--workers" && hasValue) {
+            batch.options.numWorkers = atoi(argv[++i]);
+        } else if(arg == "--time-limit" && hasValue) {
+            batch.options.timeLimit = atof(argv[++i]);
+        } else if(arg == "--memory-limit" && hasValue) {
+            batch.options.memoryLimit = (size_t)(atof(argv[++i]) * 1024 * 1024);
+        } else if(arg == "--seed" && hasValue) {
+            batch.options.seed = atoll(argv[++i]);
+        } else if(arg == "--checkpoint-every" && hasValue) {
+            batch.options.checkpointEvery = std::stoi(argv[++i]);
+        } else if(arg == "--cache" && hasValue) {
+            batch.options.cache.dir = argv[++i];
+        } else if(arg == "--ensemble" && hasValue) {
+            batch.options.ensembleSize = std::stoi(argv[++i]);
+        } else if(arg == "--unanimous" && hasValue) {
+            batch.options.unanimousAfter = std::stoi(argv[++i]);
+        } else if(arg == "--torus" && hasValue) {
+            batch.options.torusSize = std::stoi(argv[++i]);
+        } else if(arg == "--model" && hasValue) {
+            batch.options.valueModel.load(argv[++i]);
+        } else if(arg == "--min-predicted" && hasValue) {
+            batch.options.minPredictedValue = atof(argv[++i]);
+        } else if(arg == "--top-k" && hasValue) {
+            batch.options.topK = std::stoi(argv[++i]);
+        } else if(arg == "--generate" && hasValue) {
+            numGenerated = std::stoull(argv[++i]);
+        } else if(arg == "--search" && hasValue) {
+            numSearched = std::stoull(argv[++i]);
+        } else if(arg == "--keep-top" && hasValue) {
+            keepTop = std::stoi(argv[++i]);
+        } else if(arg == "--halving" && hasValue) {
+            halvingEta = std::stoi(argv[++i]);
+        } else if(arg == "--first-horizon" && hasValue) {
+            firstHorizon = std::stoi(argv[++i]);
+        } else if(arg == "--evolve" && hasValue) {
+            numEvolved = std::stoi(argv[++i]);
+        } else if(arg == "--population" && hasValue) {
+            populationSize = std::stoi(argv[++i]);
+        } else if(arg == "--parents" && hasValue) {
+            numParents = std::stoi(argv[++i]);
+        } else if(arg == "--census" && hasValue) {
+            numCensusSoups = std::stoll(argv[++i]);
+        } else if(arg == "--states" && hasValue) {
+            generatedStates = std::stoi(argv[++i]);
+        } else if(arg == "--resume") {
+            batch.options.resume = true;
+        } else if(arg == "--score-only") {
+            batch.options.scoreOnly = true;
+        } else if(arg == "--stop-below" && hasValue) {
+            batch.options.stopHopeless = true;
+            batch.options.hopelessValue = atof(argv[++i]);
+        } else if(arg == "--damage") {
+            batch.options.measureDamage = true;
+        } else if(arg == "--detect-period") {
+            batch.options.detectPopulationPeriod = true;
+        } else if(arg == "--period-window" && hasValue) {
+            batch.options.periodDetector.window = atoi(argv[++i]);
+        } else if(arg == "--max-period" && hasValue) {
+            batch.options.periodDetector.maxPeriod = atoi(argv[++i]);
+        } else if(arg.rfind("--", 0) == 0) {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if(convertMode) {
+        if(positional.size() != 2) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        RunStats stats;
+        std::string ruleString;
+        std::set<int> liveStates;
+        StatsLog::read(positional[0], stats, ruleString, liveStates);
+        stats.save(ruleString, liveStates, positional[1]);
+        return 0;
+    }
+
+    if(batch.options.measureDamage
+       && (numSearched > 0 || numEvolved >= 0 || halvingEta > 0 || batch.options.torusSize > 0
+           || numCensusSoups > 0 || batch.options.ensembleSize > 1 || batch.options.binaryStats
+           || batch.options.checkpointEvery > 0)) {
+        printf("--damage can't be used with --search, --evolve, --halving, --census, --torus, --ensemble, --binary or "
+               "--checkpoint-every.\n");
+        return 1;
+    }
+
+    if(numSearched > 0) {
+        if(batch.outDir.empty() || batchMode || !positional.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if(batch.options.torusSize > 0 || batch.options.ensembleSize > 1 || batch.options.topK > 0) {
+            printf("--torus, --ensemble and --top-k can't be used with --search.\n");
+            return 1;
+        }
+        RuleSearch search;
+        search.options = batch.options;
+        search.numRules = numSearched;
+        search.numStates = generatedStates;
+        search.keepTop = keepTop;
+        search.outDir = batch.outDir;
+        search.run();
+        return search.numFailed.load() > 0 ? 1 : 0;
+    }
+
+    if(numEvolved >= 0) {
+        if(batch.outDir.empty() || batchMode) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if(batch.options.torusSize > 0 || batch.options.ensembleSize > 1 || batch.options.binaryStats
+           || batch.options.checkpointEvery > 0) {
+            printf("--torus, --ensemble, --binary and --checkpoint-every can't be used with --evolve.\n");
+            return 1;
+        }
+        RuleEvolution evolution;
+        evolution.options = batch.options;
+        for(auto &path : positional) {
+            batch.addRules(path);
+        }
+        for(auto &ruleFile : batch.ruleFiles) {
+            evolution.initialRules.push_back(parseRuleFromJson(ruleFile));
+        }
+        evolution.numStates = generatedStates;
+        evolution.populationSize = populationSize;
+        evolution.numParents = numParents;
+        evolution.numGenerations = numEvolved;
+        evolution.outDir = batch.outDir;
+        evolution.run();
+        return evolution.numFailed.load() > 0 ? 1 : 0;
+    }
+
+    if(numCensusSoups > 0) {
+        if(batch.outDir.empty() || batchMode || positional.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if(batch.options.torusSize > 0 || batch.options.ensembleSize > 1 || batch.options.binaryStats
+           || batch.options.checkpointEvery > 0 || halvingEta > 0) {
+            printf("--torus, --ensemble, --binary, --checkpoint-every and --halving can't be used with --census.\n");
+            return 1;
+        }
+        SoupCensus census;
+        census.options = batch.options;
+        for(auto &path : positional) {
+            batch.addRules(path);
+        }
+        census.ruleFiles = batch.ruleFiles;
+        census.numSoups = numCensusSoups;
+        census.outDir = batch.outDir;
+        census.run();
+        return census.numFailed.load() > 0 ? 1 : 0;
+    }
+
+    if(batchMode) {
+        if(batch.outDir.empty() || (positional.empty() && numGenerated == 0)) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if(batch.options.torusSize > 0 && batch.options.ensembleSize > 1) {
+            printf("--torus and --ensemble can't be used together.\n");
+            return 1;
+        }
+        for(auto &path : positional) {
+            batch.addRules(path);
+        }
+        batch.prefilter();
+        if(numGenerated > 0) {
+            batch.addGeneratedRules(numGenerated, generatedStates,
+                                    (std::filesystem::path(batch.outDir) / "rules").string());
+        }
+        if(halvingEta > 0) {
+            if(batch.options.torusSize > 0 || batch.options.ensembleSize > 1 || batch.options.binaryStats
+               || batch.options.checkpointEvery > 0) {
+                printf("--torus, --ensemble, --binary and --checkpoint-every can't be used with --halving.\n");
+                return 1;
+            }
+            SuccessiveHalving halving;
+            halving.options = batch.options;
+            halving.ruleFiles = batch.ruleFiles;
+            halving.eta = halvingEta;
+            halving.firstHorizon = firstHorizon;
+            halving.outDir = batch.outDir;
+            halving.run();
+            return halving.numFailed.load() > 0 ? 1 : 0;
+        }
+        batch.run();
+        printf("%i rules run, %i failed.\n", batch.numDone.load(), batch.numFailed.load());
+        return batch.numFailed.load() > 0 ? 1 : 0;
+    }
+
+    if(positional.size() != 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if(batch.options.ensembleSize > 1) {
+        printf("--ensemble needs --batch.\n");
+        return 1;
+    }
+    if(batch.options.torusSize > 0) {
+        printf("--torus needs --batch.\n");
+        return 1;
+    }
+
+    const Rule rule = parseRuleFromJson(positional[0]);
+
+    // GOL3D setup.
+    auto gol = GeneralizedCellularAutomaton();
+    gol.init(glm::vec3(0, 0, 0), 0.5, 1000000);
+
+    // Checkpoints, if enabled, go next to the results.
+    std::string checkpointFile = std::filesystem::path(positional[1]).replace_extension(".gckpt").string();
+
+    RunStats stats;
+    BatchRunner::runRuleCached(gol, rule, stats, batch.options, "", checkpointFile);
+    std::cout << gol.ruleString << "\n";
+
+    RuleScore score = batch.options.valueFunction.evaluate(stats);
+    std::cout << "\n" << stats.endStatus << ", value " << score.value << "\n";
+    if(!stats.damage.empty()) {
+        std::cout << "Damage: " << stats.damage.hammingLog.back() << " Cubes differ, max radius "
+                  << stats.damage.maxRadius() << ", spread rate " << stats.damage.spreadRate()
+                  << ", Lyapunov exponent " << stats.damage.lyapunovExponent() << "\n";
+    }
+    if(batch.options.scoreOnly) {
+        BatchRunner::saveScore(gol.ruleString, stats, score, positional[1]);
+    } else {
+        stats.save(gol.ruleString, gol.liveStates, positional[1]);
+    }
+
+    return 0;
+}
@@ -24,6 +24,7 @@
 
 #include "Application.h"
 #include "Rule.h"
+#include "RunStats.h"
 #include "nlohmann/json.hpp"
 
 #define USEGENERALIZED
@@ -34,21 +35,11 @@ namespace fs = std::filesystem;
 const bool headlessMode = true;
 const bool computeStats = false || headlessMode;
 const bool readInput = true;
-std::vector<std::vector<int>> cubeStateLog;
-std::vector<int> activeCubeLog;
-std::vector<int> timeStepLog;
-int activeCubesInit = 0;
-int activeCubesNow = 0;
-int prevActiveCubes = -1;
-int prevPrevActiveCubes = -1;
-int prevPrevPrevActiveCubes;
-float activeCubesNowSmooth = 0;
-const float smoothingFactor = 0.5;
-const float populationGrowthThreshold = 35;
-const float populationDecayThreshold = 0.005;
-const int maxTimeSteps = 3000;
-const int logEveryT = 5;
 const std::string filePrefix = "output/2025-04-12/";
+// Per-update time budget for interactive runs, in ms. Large worlds spread
+// each generation over several updates instead of stalling. Headless runs
+// keep the one-stage-per-update cycle their statistics are sampled against.
+const double updateBudget = 8.;
 
 // Default GOL rules.
 int bornArr[] = {4, 10};
@@ -83,123 +74,6 @@ std::vector<float> defaultCubeCubeProbs = {0.15f};
 // Half-width of one side of the initial cube of Cubes.
 int hwidth = 10;
 
-void saveStateData(const std::string& ruleString,
-                   const std::string& saveFile,
-                   const std::string& endStatus) {
-
-    // Create the JSON object
-    json outputJson;
-
-    // Add ruleString
-    outputJson["ruleString"] = ruleString;
-
-    // Add endStatus
-    outputJson["endStatus"] = endStatus;
-
-    outputJson["maxSteps"] = 3000;
-
-    // Add liveStates (convert set to array)
-    outputJson["liveStates"] = json::array();
-    for (const auto& state : defaultLiveStates) {
-        outputJson["liveStates"].push_back(state);
-    }
-
-    // Create populationRecord
-    outputJson["populationRecord"] = json::object();
-
-    // Process each time step
-    for (size_t i = 0; i < cubeStateLog.size(); ++i) {
-        const auto& stateVector = cubeStateLog[i];
-        const int timeStep = timeStepLog[i];
-
-        // Calculate metrics
-        int numActiveCubes = std::accumulate(stateVector.begin(), stateVector.end(), 0);
-
-        int numLiveCubes = 0;
-        for (const int& liveState : defaultLiveStates) {
-            if (liveState < stateVector.size()) {
-                numLiveCubes += stateVector[liveState];
-            }
-        }
-
-        int numDyingCubes = 0;
-        for (size_t j = 1; j < stateVector.size(); ++j) {
-            if (defaultLiveStates.find((int)j) == defaultLiveStates.end()) {
-                numDyingCubes += stateVector[j];
-            }
-        }
-
-        int numNonDeadCubes = numLiveCubes + numDyingCubes;
-
-        // Create the entry for this time step
-        json timeStepEntry;
-        timeStepEntry["stateCounts"] = stateVector;
-        timeStepEntry["numActiveCubes"] = numActiveCubes;
-        timeStepEntry["numLiveCubes"] = numLiveCubes;
-        timeStepEntry["numDyingCubes"] = numDyingCubes;
-        timeStepEntry["numNonDeadCubes"] = numNonDeadCubes;
-
-        // Add to populationRecord using timeStep as key
-        outputJson["populationRecord"][std::to_string(timeStep)] = timeStepEntry;
-    }
-
-    // Create directories if needed
-    fs::path filePath(saveFile);
-    if (filePath.has_parent_path()) {
-        fs::create_directories(filePath.parent_path());
-    }
-
-    // Save to file
-    std::ofstream outFile(saveFile);
-    if (!outFile.is_open()) {
-        throw std::runtime_error("Failed to open file for writing: " + saveFile);
-    }
-
-    outFile << outputJson.dump(2); // Pretty print with 2-space indentation
-    outFile.close();
-}
-
-bool updateCubeStats(Application &app, const std::string &saveFile) {
-    cubeStateLog.push_back(app.getCubeStateCounts());
-    int numActiveCubes = app.getActiveCubes();
-    activeCubeLog.push_back(numActiveCubes);
-    timeStepLog.push_back(app.numSteps);
-
-    prevPrevPrevActiveCubes = prevPrevActiveCubes;
-    prevPrevActiveCubes = prevActiveCubes;
-    prevActiveCubes = numActiveCubes;
-
-    if (activeCubesInit == 0) {
-        activeCubesInit = numActiveCubes;
-        activeCubesNow = numActiveCubes;
-    } else {
-        activeCubesNow = numActiveCubes;
-    }
-
-    float populationRatio = (float)activeCubesNow / (float)activeCubesInit;
-    std::string endStatus;
-    bool explosion = populationRatio > populationGrowthThreshold;
-    bool extinction = populationRatio < populationDecayThreshold;
-    bool flatline = (prevPrevPrevActiveCubes == prevPrevActiveCubes) && (prevPrevActiveCubes == prevActiveCubes) && (prevActiveCubes == numActiveCubes);
-    bool reachedEnd = app.numSteps >= maxTimeSteps;
-    if (explosion) {
-        endStatus = "explosion";
-    } else if (extinction) {
-        endStatus = "extinction";
-    } else if (flatline) {
-        endStatus = "flatline";
-    } else {
-        endStatus = "continue";
-    }
-    bool shouldStop = explosion || extinction || flatline || reachedEnd;
-    if (shouldStop) {
-        std::cout << "\n" << endStatus << "\n";
-        std::string ruleString = app.getRuleString();
-        saveStateData(ruleString, saveFile, endStatus);
-    }
-    return shouldStop;
-}
-
 /*
  * Convert a (typically rule-)string to a filename.
  */
@@ -287,11 +161,26 @@ int main(int argc, char **argv) {
     gol.cubeCube(hwidth, 0.1, origin);
 #endif
 
+    // Headless runs never draw, so skip building render snapshots.
+    gol.publishSnapshots = !headlessMode;
+    if (!headlessMode) {
+        gol.updateBudget = updateBudget;
+    }
+
     app.world.objects.push_back(&gol);
     app.world.activate(app.world.objects[0]);
 
+    // Interactively, run the simulation on its own thread so it isn't capped
+    // by the display's frame rate. Headless runs keep the frame-locked cycle
+    // their statistics are sampled against.
+    if (!headlessMode && !valgrindTest) {
+        app.startSimulation();
+    }
+
 #ifdef USEGENERALIZED
-    activeCubesInit = app.getActiveCubes();
+    // Population statistics, for headless runs.
+    RunStats stats;
+    stats.begin(app.getActiveCubes());
 #endif
 
     if (headlessMode) {
@@ -319,8 +208,12 @@ int main(int argc, char **argv) {
 
 #ifdef USEGENERALIZED
 
-            if (computeStats && (app.numSteps % logEveryT == 1)) {
-                closeDueToStats = updateCubeStats(app, saveFile);
+            if (computeStats && stats.shouldRecord(app.numSteps)) {
+                closeDueToStats = stats.record(app.numSteps, app.getCubeStateCounts(), app.getActiveCubes(), gol.configHash);
+                if (closeDueToStats) {
+                    std::cout << "\n" << stats.endStatus << "\n";
+                    stats.save(app.getRuleString(), defaultLiveStates, saveFile);
+                }
             }
             close_condition = close_condition || closeDueToStats;
 
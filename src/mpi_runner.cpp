@@ -0,0 +1,135 @@
+//
+// Created by matt on 10/18/26.
+//
+// Runs one rule split across the ranks of an MPI job, for patterns too big
+// for one machine's memory, and saves its population statistics in the same
+// format (and, at the default --max-steps, with the same values) as
+// gol3d_headless:
+//     mpirun -np N gol3d_mpi [options] <rule.json> <save.json>
+//
+// Options:
+//     --seed S              Seed for the initial cube of Cubes.
+//     --max-steps T         Time step the run ends at regardless (default
+//                           3000, as in gol3d_headless).
+//     --rebalance-every G   Rebalance the slabs every G generations (default
+//                           10, 0 for never).
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "BatchRunner.h"
+#include "BrickWorld.h"
+#include "GeneralizedCellularAutomaton.h"
+#include "Rule.h"
+#include "RunStats.h"
+#include "SlabAutomaton.h"
+
+void printUsage(const char *name) {
+    printf("Usage: mpirun -np N %s [options] <rule.json> <save.json>\n", name);
+    printf("Options: --seed S, --max-steps T, --rebalance-every G\n");
+}
+
+/**
+ * runSlabs()
+ * Runs the rule on every rank, as gol3d_headless would run it serially.
+ * @return the process' exit code.
+ */
+static int runSlabs(int argc, char **argv, int rank) {
+    BatchOptions options;
+    long long &seed = options.seed;
+    int maxTimeSteps = -1;
+    int rebalanceEvery = 10;
+    std::vector<std::string> positional;
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if(arg == "--seed" && hasValue) {
+            seed = atoll(argv[++i]);
+        } else if(arg == "--max-steps" && hasValue) {
+            maxTimeSteps = atoi(argv[++i]);
+        } else if(arg == "--rebalance-every" && hasValue) {
+            rebalanceEvery = atoi(argv[++i]);
+        } else if(arg.rfind("--", 0) == 0) {
+            positional.clear();
+            break;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if(positional.size() != 2) {
+        if(rank == 0) {
+            printUsage(argv[0]);
+        }
+        return 1;
+    }
+
+    // Every rank makes gol3d_headless' initial cube of Cubes, from rank 0's
+    // seed, and keeps its own slab of it.
+    if(seed < 0 && rank == 0) {
+        seed = std::chrono::system_clock::now().time_since_epoch().count() & 0xFFFFFFFF;
+    }
+    MPI_Bcast(&seed, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+
+    const Rule rule = parseRuleFromJson(positional[0]);
+    GeneralizedCellularAutomaton gol;
+    gol.init(glm::vec3(0, 0, 0), 0.5, 0);
+    gol.publishSnapshots = false;
+    gol.setRule(rule.table, rule.liveStates);
+    gol.cubeCube(options.hwidth, options.cubeCubeProbs, glm::ivec3(0, 0, 0), seed);
+
+    RunStats stats;
+    if(maxTimeSteps > 0) {
+        stats.maxTimeSteps = maxTimeSteps;
+    }
+    stats.begin((int)gol.activeCubes.size());
+
+    SlabAutomaton slabs;
+    slabs.init(rule);
+    slabs.rebalanceEvery = rebalanceEvery;
+    slabs.load(BrickWorld::capture(gol));
+    gol.reset();
+
+    // Records fall at the same time steps as in the serial engine: one per
+    // generation, after its first stage.
+    auto start = std::chrono::steady_clock::now();
+    int timeStep = 1;
+    while(!stats.record(timeStep, slabs.stateCounts, (int)slabs.numActiveCubes, slabs.configHash)) {
+        slabs.step();
+        timeStep += GeneralizedCellularAutomaton::stagesPerGeneration;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long numLocal = (long long)slabs.numLocalCubes();
+    long long maxLocal = 0;
+    MPI_Reduce(&numLocal, &maxLocal, 1, MPI_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+    if(rank == 0) {
+        stats.save(gol.ruleString, gol.liveStates, positional[1]);
+        printf("%s\n\n%s after %i generations (seed %lli), %lli active Cubes, at most %lli on one rank, "
+               "in %.1f s\n", gol.ruleString.c_str(), stats.endStatus.c_str(), slabs.generation, seed,
+               slabs.numActiveCubes, maxLocal, seconds);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    MPI_Init(&argc, &argv);
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    int result;
+    try {
+        result = runSlabs(argc, argv, rank);
+    } catch(const std::exception &e) {
+        fprintf(stderr, "Rank %i: %s\n", rank, e.what());
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize();
+    return result;
+}
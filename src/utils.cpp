@@ -1,3 +1,4 @@
+#include <cstdint>
 #include <set>
 #include <string>
 #include <vector>
@@ -19,4 +20,13 @@ std::vector<std::string> split(const std::string &str, const std::string &delim)
         prev = pos + delim.length();
     } while (pos < str.length() && prev < str.length());
     return tokens;
-}
\ No newline at end of file
+}
+
+// 64-bit FNV-1a hash, stable across runs and platforms.
+uint64_t stringHash(const std::string &str) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : str) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}